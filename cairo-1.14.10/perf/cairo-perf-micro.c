@@ -569,6 +569,7 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(zrusin), 415, 415},
     { FUNC(world_map), 800, 800},
     { FUNC(box_outline), 100, 100},
+    { FUNC(box_batch), 512, 512},
     { FUNC(mosaic), 800, 800 },
     { FUNC(long_lines), 100, 100},
     { FUNC(unaligned_clip), 100, 100},
@@ -589,6 +590,7 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(spiral), 512, 512 },
     { FUNC(wave), 500, 500 },
     { FUNC(fill_clip), 16, 512 },
+    { FUNC(fill_antialias), 64, 512 },
     { FUNC(tiger), 16, 1024 },
     { NULL }
 };
@@ -219,6 +219,7 @@ CAIRO_PERF_DECL (pattern_create_radial);
 CAIRO_PERF_DECL (zrusin);
 CAIRO_PERF_DECL (world_map);
 CAIRO_PERF_DECL (box_outline);
+CAIRO_PERF_DECL (box_batch);
 CAIRO_PERF_DECL (mosaic);
 CAIRO_PERF_DECL (long_lines);
 CAIRO_PERF_DECL (unaligned_clip);
@@ -245,6 +246,7 @@ CAIRO_PERF_DECL (pixel);
 CAIRO_PERF_DECL (a1_pixel);
 CAIRO_PERF_DECL (sierpinski);
 CAIRO_PERF_DECL (fill_clip);
+CAIRO_PERF_DECL (fill_antialias);
 CAIRO_PERF_DECL (tiger);
 
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-perf.h"
+
+/* Submits many pixel-aligned boxes at once. Both workloads reduce to a
+ * list of boxes in the compositor: a paint through a clip made of many
+ * rectangles, and a single fill of many rectangles. On AmigaOS, run with
+ * CAIRO_AMIGAOS_BATCH_BOXES=0 to compare against one box at a time.
+ */
+
+#define BOX_COUNT (500)
+
+static struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} boxes[BOX_COUNT];
+
+static void
+add_boxes (cairo_t *cr)
+{
+    int i;
+
+    for (i = 0; i < BOX_COUNT; i++) {
+	cairo_rectangle (cr, boxes[i].x, boxes[i].y,
+			 boxes[i].width, boxes[i].height);
+    }
+}
+
+static cairo_time_t
+do_clipped_paint (cairo_t *cr, int width, int height, int loops)
+{
+    add_boxes (cr);
+    cairo_clip (cr);
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_paint (cr);
+
+    cairo_perf_timer_stop ();
+
+    cairo_reset_clip (cr);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_fill_boxes (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	add_boxes (cr);
+	cairo_fill (cr);
+    }
+
+    cairo_perf_timer_stop ();
+
+    return cairo_perf_timer_elapsed ();
+}
+
+cairo_bool_t
+box_batch_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "box-batch", NULL);
+}
+
+void
+box_batch (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    int i;
+
+    srand (8478232);
+    for (i = 0; i < BOX_COUNT; i++) {
+	boxes[i].x = rand () % width;
+	boxes[i].y = rand () % height;
+	boxes[i].width  = (rand () % (width / 10)) + 1;
+	boxes[i].height = (rand () % (height / 10)) + 1;
+    }
+
+    cairo_set_source_rgb (cr, 0.2, 0.4, 0.8);
+
+    cairo_perf_run (perf, "box-batch-clipped-paint", do_clipped_paint, NULL);
+    cairo_perf_run (perf, "box-batch-fill", do_fill_boxes, NULL);
+}
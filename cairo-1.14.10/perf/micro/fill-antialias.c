@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-perf.h"
+
+/* Compares the scan converters behind the antialias modes: the 4x4
+ * sampled converter for FAST, the 256x15 sampled converter for
+ * DEFAULT and the analytic converter for BEST.  Besides the timings,
+ * the coverage each produces is compared against a 16x16 supersampled
+ * rendering and the error reported as a comment line.
+ */
+
+#define QUALITY_SIZE 128
+#define QUALITY_SCALE 16
+
+typedef void (*shape_func_t) (cairo_t *cr, int width, int height);
+
+static void
+shape_circle (cairo_t *cr, int width, int height)
+{
+    cairo_arc (cr,
+	       width/2.0, height/2.0,
+	       width/3.0,
+	       0, 2 * M_PI);
+}
+
+/* Long, nearly horizontal slivers less than a pixel high. */
+static void
+shape_slivers (cairo_t *cr, int width, int height)
+{
+    int i;
+
+    for (i = 0; i < 32; i++) {
+	double y = (i + .25) * height / 32.;
+
+	cairo_move_to (cr, 0, y);
+	cairo_line_to (cr, width, y + height / 16.);
+	cairo_line_to (cr, width, y + height / 16. + .6);
+	cairo_line_to (cr, 0, y + .6);
+	cairo_close_path (cr);
+    }
+}
+
+/* A self-intersecting star, with edges crossing inside pixels. */
+static void
+shape_star (cairo_t *cr, int width, int height)
+{
+    int i;
+
+    for (i = 0; i < 23; i++) {
+	double a = i * 10 * M_PI / 23;
+
+	cairo_line_to (cr,
+		       width/2. + width/2.2 * sin (a),
+		       height/2. - height/2.2 * cos (a));
+    }
+    cairo_close_path (cr);
+}
+
+static const struct {
+    const char *name;
+    shape_func_t func;
+} shapes[] = {
+    { "circle", shape_circle },
+    { "slivers", shape_slivers },
+    { "star", shape_star },
+};
+
+static const struct {
+    const char *name;
+    cairo_antialias_t antialias;
+} modes[] = {
+    { "fast", CAIRO_ANTIALIAS_FAST },
+    { "default", CAIRO_ANTIALIAS_DEFAULT },
+    { "best", CAIRO_ANTIALIAS_BEST },
+};
+
+static shape_func_t current_shape;
+static cairo_antialias_t current_antialias;
+
+static cairo_time_t
+do_fill_antialias (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_set_antialias (cr, current_antialias);
+    current_shape (cr, width, height);
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_fill_preserve (cr);
+
+    cairo_perf_timer_stop ();
+
+    cairo_new_path (cr);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_surface_t *
+render_shape (shape_func_t shape, cairo_antialias_t antialias, int scale)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+					  QUALITY_SIZE * scale,
+					  QUALITY_SIZE * scale);
+    cr = cairo_create (surface);
+    cairo_scale (cr, scale, scale);
+    cairo_set_antialias (cr, antialias);
+    shape (cr, QUALITY_SIZE, QUALITY_SIZE);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    cairo_surface_flush (surface);
+    return surface;
+}
+
+static void
+report_quality (const char *name, shape_func_t shape)
+{
+    cairo_surface_t *reference;
+    const unsigned char *ref;
+    int ref_stride;
+    unsigned int i;
+
+    reference = render_shape (shape, CAIRO_ANTIALIAS_NONE, QUALITY_SCALE);
+    ref = cairo_image_surface_get_data (reference);
+    ref_stride = cairo_image_surface_get_stride (reference);
+
+    for (i = 0; i < ARRAY_LENGTH (modes); i++) {
+	cairo_surface_t *image;
+	const unsigned char *data;
+	int stride, x, y, max_error = 0;
+	double total_error = 0;
+
+	image = render_shape (shape, modes[i].antialias, 1);
+	data = cairo_image_surface_get_data (image);
+	stride = cairo_image_surface_get_stride (image);
+
+	for (y = 0; y < QUALITY_SIZE; y++) {
+	    for (x = 0; x < QUALITY_SIZE; x++) {
+		int sx, sy, sum = 0, expected, error;
+
+		for (sy = 0; sy < QUALITY_SCALE; sy++) {
+		    const unsigned char *row;
+
+		    row = ref + (y * QUALITY_SCALE + sy) * ref_stride;
+		    for (sx = 0; sx < QUALITY_SCALE; sx++)
+			sum += row[x * QUALITY_SCALE + sx] != 0;
+		}
+		expected = (sum * 255 + QUALITY_SCALE * QUALITY_SCALE / 2) /
+			   (QUALITY_SCALE * QUALITY_SCALE);
+
+		error = abs (data[y * stride + x] - expected);
+		if (error > max_error)
+		    max_error = error;
+		total_error += error;
+	    }
+	}
+
+	printf ("[ # ] fill-antialias-%s-%s: max error %d, mean error %.3f\n",
+		name, modes[i].name, max_error,
+		total_error / (QUALITY_SIZE * QUALITY_SIZE));
+
+	cairo_surface_destroy (image);
+    }
+
+    cairo_surface_destroy (reference);
+}
+
+cairo_bool_t
+fill_antialias_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "fill-antialias", NULL);
+}
+
+void
+fill_antialias (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < ARRAY_LENGTH (shapes); i++) {
+	if (! perf->list_only)
+	    report_quality (shapes[i].name, shapes[i].func);
+
+	current_shape = shapes[i].func;
+	for (j = 0; j < ARRAY_LENGTH (modes); j++) {
+	    char *name;
+
+	    xasprintf (&name, "fill-antialias-%s-%s",
+		       shapes[i].name, modes[j].name);
+	    current_antialias = modes[j].antialias;
+	    cairo_perf_run (perf, name, do_fill_antialias, NULL);
+	    free (name);
+	}
+    }
+}
@@ -27,6 +27,10 @@
 
 #include "cairo-perf.h"
 
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 static cairo_time_t
 do_glyphs (double font_size,
 	   cairo_antialias_t antialias,
@@ -170,6 +174,179 @@ DECL(48ca, 48, CAIRO_ANTIALIAS_SUBPIXEL)
 DECL(8mono, 8, CAIRO_ANTIALIAS_NONE)
 DECL(48mono, 48, CAIRO_ANTIALIAS_NONE)
 
+#if CAIRO_HAS_REAL_PTHREAD
+/* Tile renderers draw the same text into separate surfaces from several
+ * threads at once; every thread fills its own width x height tile. With
+ * shared_font unset each thread uses its own size, and so its own scaled
+ * font, which leaves only the global glyph caches to contend on. */
+#define MAX_THREADS 8
+
+typedef struct {
+    cairo_surface_t *tile;
+    cairo_scaled_font_t *scaled_font;
+    cairo_glyph_t *glyphs;
+    int num_glyphs;
+    double advance, line_height;
+    int width, height, loops;
+} glyphs_thread_t;
+
+static void *
+draw_glyphs_thread (void *closure)
+{
+    glyphs_thread_t *thread = closure;
+    cairo_glyph_t *glyphs_copy;
+    cairo_t *cr;
+    double x, y;
+    int loops, n;
+
+    glyphs_copy = cairo_glyph_allocate (thread->num_glyphs);
+    if (glyphs_copy == NULL)
+	return NULL;
+
+    cr = cairo_create (thread->tile);
+    cairo_set_scaled_font (cr, thread->scaled_font);
+
+    for (loops = thread->loops; loops--; ) {
+	y = 0;
+	do {
+	    x = 0;
+	    do {
+		for (n = 0; n < thread->num_glyphs; n++) {
+		    glyphs_copy[n] = thread->glyphs[n];
+		    glyphs_copy[n].x += x;
+		    glyphs_copy[n].y += y;
+		}
+		cairo_show_glyphs (cr, glyphs_copy, thread->num_glyphs);
+
+		x += thread->advance;
+	    } while (x < thread->width);
+	    y += thread->line_height;
+	} while (y < thread->height);
+    }
+
+    cairo_destroy (cr);
+    cairo_glyph_free (glyphs_copy);
+
+    return NULL;
+}
+
+static cairo_time_t
+do_glyphs_threaded (int num_threads, cairo_bool_t shared_font,
+		    cairo_t *cr, int width, int height, int loops)
+{
+    const char text[] = "the jay, pig, fox, zebra and my wolves quack";
+    glyphs_thread_t threads[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    cairo_text_extents_t extents;
+    cairo_font_options_t *options;
+    cairo_status_t status;
+    cairo_time_t elapsed = 0;
+    int n, started;
+
+    memset (threads, 0, sizeof (threads));
+
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    cairo_set_font_options (cr, options);
+    cairo_font_options_destroy (options);
+
+    cairo_select_font_face (cr,
+			    "@cairo:",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+
+    for (n = 0; n < num_threads; n++) {
+	glyphs_thread_t *thread = &threads[n];
+
+	cairo_set_font_size (cr, shared_font ? 12 : 12 + n);
+	thread->scaled_font = cairo_scaled_font_reference (cairo_get_scaled_font (cr));
+	status = cairo_scaled_font_text_to_glyphs (thread->scaled_font, 0., 0.,
+						   text, -1,
+						   &thread->glyphs,
+						   &thread->num_glyphs,
+						   NULL, NULL,
+						   NULL);
+	if (status)
+	    goto out;
+
+	cairo_scaled_font_glyph_extents (thread->scaled_font,
+					 thread->glyphs, thread->num_glyphs,
+					 &extents);
+	thread->advance = extents.width;
+	thread->line_height = extents.height;
+
+	thread->tile = cairo_surface_create_similar_image (cairo_get_target (cr),
+							   CAIRO_FORMAT_ARGB32,
+							   width, height);
+	thread->width = width;
+	thread->height = height;
+	thread->loops = loops;
+    }
+
+    cairo_perf_timer_start ();
+
+    for (started = 0; started < num_threads; started++) {
+	if (pthread_create (&tids[started], NULL,
+			    draw_glyphs_thread, &threads[started]) != 0)
+	    break;
+    }
+    for (n = 0; n < started; n++)
+	pthread_join (tids[n], NULL);
+
+    cairo_perf_timer_stop ();
+
+    if (started == num_threads)
+	elapsed = cairo_perf_timer_elapsed ();
+
+out:
+    for (n = 0; n < num_threads; n++) {
+	cairo_surface_destroy (threads[n].tile);
+	cairo_glyph_free (threads[n].glyphs);
+	cairo_scaled_font_destroy (threads[n].scaled_font);
+    }
+
+    return elapsed;
+}
+
+static double
+count_glyphs_threaded (int num_threads, cairo_bool_t shared_font,
+		       cairo_t *cr, int width, int height)
+{
+    double count = 0;
+    int n;
+
+    for (n = 0; n < num_threads; n++) {
+	count += count_glyphs (shared_font ? 12 : 12 + n,
+			       CAIRO_ANTIALIAS_GRAY,
+			       cr, width, height);
+    }
+
+    return count;
+}
+
+#define DECL_THREADS(name, num_threads, shared_font) \
+static cairo_time_t \
+do_glyphs_threads##name (cairo_t *cr, int width, int height, int loops) \
+{ \
+    return do_glyphs_threaded (num_threads, shared_font, cr, width, height, loops); \
+} \
+\
+static double \
+count_glyphs_threads##name (cairo_t *cr, int width, int height) \
+{ \
+    return count_glyphs_threaded (num_threads, shared_font, cr, width, height); \
+}
+
+DECL_THREADS(1, 1, TRUE)
+DECL_THREADS(2, 2, TRUE)
+DECL_THREADS(4, 4, TRUE)
+DECL_THREADS(8, 8, TRUE)
+
+DECL_THREADS(2fonts, 2, FALSE)
+DECL_THREADS(4fonts, 4, FALSE)
+DECL_THREADS(8fonts, 8, FALSE)
+#endif
+
 cairo_bool_t
 glyphs_enabled (cairo_perf_t *perf)
 {
@@ -199,4 +376,17 @@ glyphs (cairo_perf_t *perf, cairo_t *cr, int width, int height)
     cairo_perf_cover_sources_and_operators (perf, "glyphs48mono", do_glyphs48mono, count_glyphs48mono);
     cairo_perf_cover_sources_and_operators (perf, "glyphs48", do_glyphs48, count_glyphs48);
     cairo_perf_cover_sources_and_operators (perf, "glyphs48ca", do_glyphs48ca, count_glyphs48ca);
+
+#if CAIRO_HAS_REAL_PTHREAD
+    cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+
+    cairo_perf_run (perf, "glyphs-threads1", do_glyphs_threads1, count_glyphs_threads1);
+    cairo_perf_run (perf, "glyphs-threads2", do_glyphs_threads2, count_glyphs_threads2);
+    cairo_perf_run (perf, "glyphs-threads4", do_glyphs_threads4, count_glyphs_threads4);
+    cairo_perf_run (perf, "glyphs-threads8", do_glyphs_threads8, count_glyphs_threads8);
+    cairo_perf_run (perf, "glyphs-threads2fonts", do_glyphs_threads2fonts, count_glyphs_threads2fonts);
+    cairo_perf_run (perf, "glyphs-threads4fonts", do_glyphs_threads4fonts, count_glyphs_threads4fonts);
+    cairo_perf_run (perf, "glyphs-threads8fonts", do_glyphs_threads8fonts, count_glyphs_threads8fonts);
+#endif
 }
@@ -25,6 +25,7 @@
  */
 
 #include "cairo-perf.h"
+#include "test-tor-scan-converter.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -134,6 +135,18 @@ do_world_map_both (cairo_t *cr, int width, int height, int loops)
     return do_world_map (cr, width, height, loops, FILL | STROKE);
 }
 
+/* Compare the scan converter's coverage accumulation strategies, see
+ * CAIRO_TOR_COVERAGE in cairo-tor-scan-converter.c. */
+static void
+world_map_fill_coverage (cairo_perf_t *perf, const char *name, const char *coverage)
+{
+    if (! _cairo_test_tor_scan_converter_set_coverage (coverage))
+	return;
+
+    cairo_perf_run (perf, name, do_world_map_fill, NULL);
+    _cairo_test_tor_scan_converter_set_coverage (NULL);
+}
+
 cairo_bool_t
 world_map_enabled (cairo_perf_t *perf)
 {
@@ -146,4 +159,7 @@ world_map (cairo_perf_t *perf, cairo_t *cr, int width, int height)
     cairo_perf_run (perf, "world-map-stroke", do_world_map_stroke, NULL);
     cairo_perf_run (perf, "world-map-fill", do_world_map_fill, NULL);
     cairo_perf_run (perf, "world-map", do_world_map_both, NULL);
+    world_map_fill_coverage (perf, "world-map-fill-sparse", "sparse");
+    world_map_fill_coverage (perf, "world-map-fill-scalar", "scalar");
+    world_map_fill_coverage (perf, "world-map-fill-simd", "simd");
 }
@@ -25,6 +25,7 @@
  */
 
 #include "cairo-perf.h"
+#include "test-tor-scan-converter.h"
 
 typedef struct {
     double x;
@@ -82,6 +83,18 @@ zrusin_another_fill (cairo_t *cr, int width, int height, int loops)
     return cairo_perf_timer_elapsed ();
 }
 
+/* Compare the scan converter's coverage accumulation strategies, see
+ * CAIRO_TOR_COVERAGE in cairo-tor-scan-converter.c. */
+static void
+zrusin_another_fill_coverage (cairo_perf_t *perf, const char *name, const char *coverage)
+{
+    if (! _cairo_test_tor_scan_converter_set_coverage (coverage))
+	return;
+
+    cairo_perf_run (perf, name, zrusin_another_fill, NULL);
+    _cairo_test_tor_scan_converter_set_coverage (NULL);
+}
+
 cairo_bool_t
 zrusin_enabled (cairo_perf_t *perf)
 {
@@ -94,4 +107,7 @@ zrusin (cairo_perf_t *perf, cairo_t *cr, int width, int height)
 
     cairo_perf_run (perf, "zrusin-another-tessellate", zrusin_another_tessellate, NULL);
     cairo_perf_run (perf, "zrusin-another-fill", zrusin_another_fill, NULL);
+    zrusin_another_fill_coverage (perf, "zrusin-another-fill-sparse", "sparse");
+    zrusin_another_fill_coverage (perf, "zrusin-another-fill-scalar", "scalar");
+    zrusin_another_fill_coverage (perf, "zrusin-another-fill-simd", "simd");
 }
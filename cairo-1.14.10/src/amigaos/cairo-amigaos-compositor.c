@@ -30,6 +30,11 @@
 #include "cairo-amigaos-private.h"
 #include "cairo-clip-inline.h"
 #include "cairo-compositor-private.h"
+#include "cairo-damage-private.h"
+#include "cairo-image-surface-inline.h"
+#include "cairo-rtree-private.h"
+#include "cairo-scaled-font-private.h"
+#include "cairo-surface-offset-private.h"
 #include "cairo-tristrip-private.h"
 #include "cairo-traps-private.h"
 
@@ -56,6 +61,34 @@ typedef struct {
 		vertex; \
 	})
 
+typedef struct {
+	float x, y, s, t, w, s1, t1, w1;
+} my_mask_vertex_t;
+
+#define MASK_VERTEX(_x, _y, _s, _t, _w, _s1, _t1, _w1) \
+	({ \
+		my_mask_vertex_t vertex; \
+		vertex.x  = (_x); \
+		vertex.y  = (_y); \
+		vertex.s  = (_s); \
+		vertex.t  = (_t); \
+		vertex.w  = (_w); \
+		vertex.s1 = (_s1); \
+		vertex.t1 = (_t1); \
+		vertex.w1 = (_w1); \
+		vertex; \
+	})
+
+/* Maps a coverage value in the range 0..1 to the centre of the matching
+ * texel in the device coverage ramp.
+ */
+#define COVERAGE_TO_S(c) (0.5f + (c) * (COVERAGE_RAMP_SIZE - 1))
+
+/* Indices are 16-bit so a single submission can address at most this many
+ * vertices.
+ */
+#define MAX_BATCH_VERTICES 65536
+
 struct clipped_composite_data {
 	uint32                op;
 	struct BitMap        *src;
@@ -112,24 +145,6 @@ CompositeRastPortTagList (uint32                  op,
 	return error;
 }
 
-static VARARGS68K uint32
-CompositeRastPortTags (uint32                  op,
-                       struct BitMap          *src_bm,
-                       struct RastPort        *dst_rp,
-                       const struct Rectangle *bounds,
-                       ...)
-{
-	uint32  error;
-	va_list tags;
-
-	va_startlinear(tags, bounds);
-	error = CompositeRastPortTagList(op, src_bm, dst_rp, bounds,
-	                                 va_getlinearva(tags, const struct TagItem *));
-	va_end(tags);
-
-	return error;
-}
-
 static void
 clip_and_init_bounds (const cairo_amigaos_surface_t *surface,
                       struct Rectangle              *bounds,
@@ -166,6 +181,10 @@ convert_operator_to_amigaos (cairo_operator_t op)
 	uint32 amigaos_op;
 
 	switch (op) {
+		case CAIRO_OPERATOR_CLEAR:
+			amigaos_op = COMPOSITE_Clear;
+			break;
+
 		case CAIRO_OPERATOR_SOURCE:
 			amigaos_op = COMPOSITE_Src;
 			break;
@@ -174,17 +193,46 @@ convert_operator_to_amigaos (cairo_operator_t op)
 			amigaos_op = COMPOSITE_Src_Over_Dest;
 			break;
 
-		case CAIRO_OPERATOR_CLEAR:
 		case CAIRO_OPERATOR_IN:
+			amigaos_op = COMPOSITE_Src_In_Dest;
+			break;
+
 		case CAIRO_OPERATOR_OUT:
+			amigaos_op = COMPOSITE_Src_Out_Dest;
+			break;
+
 		case CAIRO_OPERATOR_ATOP:
+			amigaos_op = COMPOSITE_Src_Atop_Dest;
+			break;
+
 		case CAIRO_OPERATOR_DEST:
+			amigaos_op = COMPOSITE_Dest;
+			break;
+
 		case CAIRO_OPERATOR_DEST_OVER:
+			amigaos_op = COMPOSITE_Dest_Over_Src;
+			break;
+
 		case CAIRO_OPERATOR_DEST_IN:
+			amigaos_op = COMPOSITE_Dest_In_Src;
+			break;
+
 		case CAIRO_OPERATOR_DEST_OUT:
+			amigaos_op = COMPOSITE_Dest_Out_Src;
+			break;
+
 		case CAIRO_OPERATOR_DEST_ATOP:
+			amigaos_op = COMPOSITE_Dest_Atop_Src;
+			break;
+
 		case CAIRO_OPERATOR_XOR:
+			amigaos_op = COMPOSITE_Src_Xor_Dest;
+			break;
+
 		case CAIRO_OPERATOR_ADD:
+			amigaos_op = COMPOSITE_Plus;
+			break;
+
 		case CAIRO_OPERATOR_SATURATE:
 		case CAIRO_OPERATOR_MULTIPLY:
 		case CAIRO_OPERATOR_SCREEN:
@@ -209,307 +257,2326 @@ convert_operator_to_amigaos (cairo_operator_t op)
 	return amigaos_op;
 }
 
-static cairo_surface_t *
-pattern_to_amigaos_surface (const cairo_pattern_t *pattern)
+/* Allocates a surface owning a fresh ARGB bitmap, used for sources that
+ * are generated by the compositor itself.
+ */
+static cairo_amigaos_surface_t *
+source_surface_create (int width, int height)
 {
 	struct BitMap           *bitmap;
 	cairo_amigaos_surface_t *surface;
 
-	switch (pattern->type) {
-		case CAIRO_PATTERN_TYPE_SOLID:
-		{
-			cairo_color_t *color = &((cairo_solid_pattern_t *)pattern)->color;
-			uint32         argb;
-
-			bitmap = IGraphics->AllocBitMapTags(1, 1, 24,
-				BMATags_PixelFormat, PIXF_A8R8G8B8,
-				TAG_END);
-			if (bitmap == NULL)
-				return _cairo_surface_create_in_error(_cairo_error(CAIRO_STATUS_NO_MEMORY));
-
-			surface = (cairo_amigaos_surface_t *)cairo_amigaos_surface_create(bitmap);
-			if (unlikely (surface->base.backend == NULL)) {
-				IGraphics->FreeBitMap(bitmap);
-				return &surface->base;
-			}
+	bitmap = IGraphics->AllocBitMapTags(width, height, 24,
+		BMATags_PixelFormat, PIXF_A8R8G8B8,
+		TAG_END);
+	if (bitmap == NULL)
+		return (cairo_amigaos_surface_t *)_cairo_surface_create_in_error(_cairo_error(CAIRO_STATUS_NO_MEMORY));
 
-			surface->free_bitmap = TRUE;
+	surface = (cairo_amigaos_surface_t *)cairo_amigaos_surface_create(bitmap);
+	if (unlikely (surface->base.backend == NULL)) {
+		IGraphics->FreeBitMap(bitmap);
+		return surface;
+	}
 
-			argb = ARGB(color->alpha_short >> 8, color->red * 255, color->green * 255, color->blue * 255);
+	surface->free_bitmap = TRUE;
 
-			IGraphics->WritePixelColor(surface->rastport, 0, 0, argb);
+	return surface;
+}
 
-			return &surface->base;
-		}
+static cairo_amigaos_surface_t *
+solid_surface_create (uint32 argb)
+{
+	cairo_amigaos_surface_t *surface;
 
-		case CAIRO_PATTERN_TYPE_SURFACE:
-		{
-			cairo_surface_t *surface = ((cairo_surface_pattern_t *)pattern)->surface;
+	surface = source_surface_create(1, 1);
+	if (unlikely (surface->base.backend == NULL))
+		return surface;
+
+	IGraphics->WritePixelColor(surface->rastport, 0, 0, argb);
+
+	return surface;
+}
+
+/* Solid sources are never written to after creation, so a cached one can
+ * be handed out to several users at once. Evicting an entry only drops
+ * the cache's reference. Cached sources give up their device reference,
+ * which would otherwise keep the device that owns the cache alive; they
+ * are only used while drawing to a surface of the same device.
+ */
+static cairo_surface_t *
+solid_surface_lookup (cairo_amigaos_device_t *device,
+                      uint32                  argb)
+{
+	cairo_amigaos_surface_t *surface;
+	int                      i;
 
-			if (surface->type != CAIRO_SURFACE_TYPE_AMIGAOS)
-				return _cairo_int_surface_create_in_error(CAIRO_INT_STATUS_UNSUPPORTED);
+	if (unlikely (cairo_device_acquire(&device->base) != CAIRO_STATUS_SUCCESS))
+		return &solid_surface_create(argb)->base;
 
-			cairo_surface_reference(surface);
+	for (i = 0; i < device->num_solids; i++) {
+		if (device->solid_cache[i].argb == argb)
+			break;
+	}
 
-			return surface;
+	if (i < device->num_solids) {
+		surface = device->solid_cache[i].surface;
+	} else {
+		surface = solid_surface_create(argb);
+		if (unlikely (surface->base.backend == NULL)) {
+			cairo_device_release(&device->base);
+			return &surface->base;
 		}
 
-		case CAIRO_PATTERN_TYPE_LINEAR:
-		case CAIRO_PATTERN_TYPE_RADIAL:
-		case CAIRO_PATTERN_TYPE_MESH:
-		case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
-		default:
-			return _cairo_int_surface_create_in_error(CAIRO_INT_STATUS_UNSUPPORTED);
+		_cairo_surface_release_device_reference(&surface->base);
+
+		if (device->num_solids < SOLID_CACHE_SIZE)
+			i = device->num_solids++;
+		else
+			cairo_surface_destroy(&device->solid_cache[--i].surface->base);
 	}
+
+	/* Move to front */
+	memmove(&device->solid_cache[1], &device->solid_cache[0],
+	        i * sizeof(device->solid_cache[0]));
+	device->solid_cache[0].argb    = argb;
+	device->solid_cache[0].surface = surface;
+
+	cairo_surface_reference(&surface->base);
+
+	cairo_device_release(&device->base);
+
+	return &surface->base;
 }
 
-struct composite_data {
-	uint32                   op;
-	cairo_amigaos_surface_t *src;
-	cairo_amigaos_surface_t *dst;
-	uint32                   alpha;
-};
+/* Gradients are rasterised once into a texture in a normalised space, so
+ * every gradient with the same stops, extend mode and (for radial ones)
+ * circle proportions shares it regardless of position and scale. Linear
+ * gradients use a 1 pixel high ramp along the gradient vector and radial
+ * gradients a square covering the outer circle.
+ */
+#define GRADIENT_RAMP_WIDTH  512
+#define GRADIENT_RADIAL_SIZE 256
 
-static cairo_bool_t
-composite_box (cairo_box_t *box, void *user_data)
-{
-	struct composite_data *cd = user_data;
-	float                  x1, y1, x2, y2;
-	struct Rectangle       bounds;
-	my_vertex_t            vertices[4];
-	uint16                 indices[6];
-	uint32                 error;
+typedef struct _cairo_amigaos_gradient {
+	cairo_cache_entry_t          base;
 
-	x1 = _cairo_fixed_to_double(box->p1.x);
-	y1 = _cairo_fixed_to_double(box->p1.y);
-	x2 = _cairo_fixed_to_double(box->p2.x);
-	y2 = _cairo_fixed_to_double(box->p2.y);
+	cairo_pattern_type_t         type;
+	cairo_extend_t               extend;
+	double                       circles[6];
 
-	clip_and_init_bounds(cd->dst, &bounds, x1, y1, x2, y2);
+	unsigned int                 n_stops;
+	const cairo_gradient_stop_t *stops;
 
-	vertices[0] = VERTEX(x1, y1, 0, 0, 1);
-	vertices[1] = VERTEX(x2, y1, 0, 0, 1);
-	vertices[2] = VERTEX(x1, y2, 0, 0, 1);
-	vertices[3] = VERTEX(x2, y2, 0, 0, 1);
+	cairo_amigaos_surface_t     *surface;
 
-	indices[0] = 0;
-	indices[1] = 1;
-	indices[2] = 2;
-	indices[3] = 2;
-	indices[4] = 1;
-	indices[5] = 3;
+	cairo_gradient_stop_t        stops_embedded[1];
+} cairo_amigaos_gradient_t;
 
-	error = CompositeRastPortTags(cd->op, cd->src->bitmap, cd->dst->rastport, &bounds,
-		COMPTAG_Flags,        COMPFLAG_HardwareOnly,
-		COMPTAG_IndexArray,   indices,
-		COMPTAG_VertexArray,  vertices,
-		COMPTAG_VertexFormat, COMPVF_STW0_Present,
-		COMPTAG_NumTriangles, 2,
-		COMPTAG_SrcAlpha,     cd->alpha,
-		TAG_END);
+static cairo_bool_t
+_cairo_amigaos_gradient_equal (const void *key_a, const void *key_b)
+{
+	const cairo_amigaos_gradient_t *a = key_a;
+	const cairo_amigaos_gradient_t *b = key_b;
 
-	if (unlikely (error != COMPERR_Success))
+	if (a->type != b->type || a->extend != b->extend || a->n_stops != b->n_stops)
 		return FALSE;
 
-	return TRUE;
+	if (memcmp(a->circles, b->circles, sizeof(a->circles)) != 0)
+		return FALSE;
+
+	return memcmp(a->stops, b->stops, a->n_stops * sizeof(cairo_gradient_stop_t)) == 0;
 }
 
-static cairo_int_status_t
-composite_boxes (cairo_composite_rectangles_t *extents,
-                 cairo_boxes_t                *boxes)
+static void
+_cairo_amigaos_gradient_destroy (void *entry)
 {
-	cairo_int_status_t       status = CAIRO_INT_STATUS_UNSUPPORTED;
-	uint32                   op;
-	cairo_amigaos_surface_t *dst;
-	const cairo_pattern_t   *src_pattern;
-	cairo_amigaos_surface_t *src;
-	struct composite_data    cd;
+	cairo_amigaos_gradient_t *gradient = entry;
 
-	op = convert_operator_to_amigaos(extents->op);
-	if (op == COMPOSITE_Invalid)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	cairo_surface_destroy(&gradient->surface->base);
+	free(gradient);
+}
 
-	dst = (cairo_amigaos_surface_t *)extents->surface;
+cairo_status_t
+_cairo_amigaos_gradient_cache_init (cairo_cache_t *cache)
+{
+	return _cairo_cache_init(cache,
+	                         _cairo_amigaos_gradient_equal,
+	                         NULL,
+	                         _cairo_amigaos_gradient_destroy,
+	                         GRADIENT_CACHE_SIZE);
+}
 
-	src_pattern = &extents->source_pattern.base;
-	if (src_pattern->type != CAIRO_PATTERN_TYPE_SOLID)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+/* Renders the gradient into a new texture, texture_to_pattern mapping
+ * texel coordinates into the pattern space of the gradient.
+ */
+static cairo_amigaos_surface_t *
+gradient_surface_create (const cairo_gradient_pattern_t *gradient,
+                         const cairo_matrix_t           *texture_to_pattern,
+                         int                             width,
+                         int                             height)
+{
+	cairo_amigaos_surface_t *surface;
+	cairo_image_surface_t   *image;
+	cairo_pattern_union_t    pattern;
+	cairo_status_t           status;
 
-	src = (cairo_amigaos_surface_t *)pattern_to_amigaos_surface(src_pattern);
-	if (src->base.backend == NULL)
-		return src->base.status;
+	image = (cairo_image_surface_t *)cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+	if (unlikely (image->base.status))
+		return (cairo_amigaos_surface_t *)_cairo_surface_create_in_error(image->base.status);
 
-	cd.op    = op;
-	cd.src   = src;
-	cd.dst   = dst;
-	cd.alpha = COMP_FIX_ONE;
+	_cairo_pattern_init_static_copy(&pattern.base, &gradient->base);
+	pattern.base.matrix = *texture_to_pattern;
+
+	status = _cairo_surface_paint(&image->base, CAIRO_OPERATOR_SOURCE, &pattern.base, NULL);
+	if (unlikely (status)) {
+		cairo_surface_destroy(&image->base);
+		return (cairo_amigaos_surface_t *)_cairo_surface_create_in_error(status);
+	}
 
-	if (likely (_cairo_boxes_for_each_box(boxes, composite_box, &cd)))
-		status = CAIRO_STATUS_SUCCESS;
+	surface = source_surface_create(width, height);
+	if (likely (surface->base.backend != NULL)) {
+		IGraphics->WritePixelArray(image->data, 0, 0, image->stride, PIXF_A8R8G8B8,
+		                           surface->rastport, 0, 0, width, height);
+	}
 
-	cairo_surface_destroy(&src->base);
+	cairo_surface_destroy(&image->base);
 
-	return status;
+	return surface;
 }
 
-static cairo_int_status_t
-composite_boxes_with_mask (cairo_composite_rectangles_t *extents,
-                           cairo_boxes_t                *boxes)
+static cairo_surface_t *
+gradient_surface_lookup (cairo_amigaos_device_t         *device,
+                         const cairo_gradient_pattern_t *pattern,
+                         const double                   *circles,
+                         const cairo_matrix_t           *texture_to_pattern,
+                         int                             width,
+                         int                             height)
 {
-	cairo_int_status_t       status = CAIRO_INT_STATUS_UNSUPPORTED;
-	uint32                   op;
-	cairo_amigaos_surface_t *dst;
-	const cairo_pattern_t   *src_pattern;
-	const cairo_pattern_t   *mask_pattern;
-	cairo_amigaos_surface_t *src;
-	struct composite_data    cd;
+	cairo_amigaos_gradient_t  lookup, *gradient;
+	cairo_amigaos_surface_t  *surface;
+	unsigned long             hash;
+
+	lookup.type    = pattern->base.type;
+	lookup.extend  = pattern->base.extend;
+	lookup.n_stops = pattern->n_stops;
+	lookup.stops   = pattern->stops;
+	memcpy(lookup.circles, circles, sizeof(lookup.circles));
+
+	hash = _cairo_hash_bytes(_CAIRO_HASH_INIT_VALUE, pattern->stops,
+	                         pattern->n_stops * sizeof(cairo_gradient_stop_t));
+	hash = _cairo_hash_bytes(hash, &lookup.type, sizeof(lookup.type));
+	hash = _cairo_hash_bytes(hash, &lookup.extend, sizeof(lookup.extend));
+	hash = _cairo_hash_bytes(hash, lookup.circles, sizeof(lookup.circles));
+	lookup.base.hash = hash;
+
+	if (unlikely (cairo_device_acquire(&device->base) != CAIRO_STATUS_SUCCESS))
+		return &gradient_surface_create(pattern, texture_to_pattern, width, height)->base;
+
+	if (unlikely (! device->has_gradient_cache)) {
+		cairo_device_release(&device->base);
+		return &gradient_surface_create(pattern, texture_to_pattern, width, height)->base;
+	}
 
-	op = convert_operator_to_amigaos(extents->op);
-	if (op == COMPOSITE_Invalid)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	gradient = _cairo_cache_lookup(&device->gradients, &lookup.base);
+	if (gradient != NULL) {
+		surface = gradient->surface;
+		cairo_surface_reference(&surface->base);
+		cairo_device_release(&device->base);
+		return &surface->base;
+	}
 
-	dst = (cairo_amigaos_surface_t *)extents->surface;
+	surface = gradient_surface_create(pattern, texture_to_pattern, width, height);
+	if (unlikely (surface->base.backend == NULL)) {
+		cairo_device_release(&device->base);
+		return &surface->base;
+	}
 
-	src_pattern = &extents->source_pattern.base;
-	if (src_pattern->type != CAIRO_PATTERN_TYPE_SOLID)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	gradient = malloc(sizeof(cairo_amigaos_gradient_t) +
+	                  sizeof(cairo_gradient_stop_t) * (pattern->n_stops - 1));
+	if (likely (gradient != NULL)) {
+		gradient->base.hash = hash;
+		gradient->base.size = width * height;
+		gradient->type      = lookup.type;
+		gradient->extend    = lookup.extend;
+		gradient->n_stops   = lookup.n_stops;
+		gradient->stops     = gradient->stops_embedded;
+		gradient->surface   = surface;
+		memcpy(gradient->circles, lookup.circles, sizeof(gradient->circles));
+		memcpy(gradient->stops_embedded, pattern->stops,
+		       pattern->n_stops * sizeof(cairo_gradient_stop_t));
+
+		cairo_surface_reference(&surface->base);
+
+		/* An uncached gradient is still good for this operation */
+		if (unlikely (_cairo_cache_insert(&device->gradients, &gradient->base))) {
+			cairo_surface_destroy(&surface->base);
+			free(gradient);
+		} else {
+			/* As for solids, see solid_surface_lookup() */
+			_cairo_surface_release_device_reference(&surface->base);
+		}
+	}
 
-	mask_pattern = &extents->mask_pattern.base;
-	if (mask_pattern->type != CAIRO_PATTERN_TYPE_SOLID)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	cairo_device_release(&device->base);
 
-	src = (cairo_amigaos_surface_t *)pattern_to_amigaos_surface(src_pattern);
-	if (src->base.backend == NULL)
-		return src->base.status;
+	return &surface->base;
+}
 
-	cd.op    = op;
-	cd.src   = src;
-	cd.dst   = dst;
-	cd.alpha = COMP_FLOAT_TO_FIX(((cairo_solid_pattern_t *)mask_pattern)->color.alpha);
+/* A source ready for compositing: the bitmap to sample and the affine
+ * transformation from destination pixels to its texel coordinates.
+ */
+struct composite_source {
+	cairo_amigaos_surface_t *surface;
+	cairo_matrix_t           matrix;
+	uint32                   flags;
+};
+
+/* Cheap check for whether acquire_source() may succeed, so callers can
+ * avoid tessellating geometry for a source they can not use.
+ */
+static cairo_bool_t
+source_is_supported (const cairo_pattern_t *pattern)
+{
+	switch (pattern->type) {
+		case CAIRO_PATTERN_TYPE_SOLID:
+			return TRUE;
+
+		case CAIRO_PATTERN_TYPE_LINEAR:
+		case CAIRO_PATTERN_TYPE_RADIAL:
+			/* Texture lookups clamp to the edge, which only matches PAD and,
+			 * given a transparent border, NONE.
+			 */
+			return pattern->extend == CAIRO_EXTEND_PAD || pattern->extend == CAIRO_EXTEND_NONE;
 
-	if (likely (_cairo_boxes_for_each_box(boxes, composite_box, &cd)))
-		status = CAIRO_STATUS_SUCCESS;
+		case CAIRO_PATTERN_TYPE_SURFACE:
+		{
+			const cairo_surface_t *surface = ((const cairo_surface_pattern_t *)pattern)->surface;
 
-	cairo_surface_destroy(&src->base);
+			return _cairo_surface_is_amigaos(surface) || _cairo_surface_is_image(surface);
+		}
 
-	return status;
+		case CAIRO_PATTERN_TYPE_MESH:
+		case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
+		default:
+			return FALSE;
+	}
 }
 
 static cairo_int_status_t
-composite_tristrip (cairo_composite_rectangles_t *extents,
-                    cairo_tristrip_t             *strip)
+acquire_linear_source (cairo_amigaos_device_t       *device,
+                       const cairo_linear_pattern_t *linear,
+                       struct composite_source      *src)
 {
-	cairo_int_status_t       status = CAIRO_INT_STATUS_UNSUPPORTED;
-	uint32                   op;
-	cairo_amigaos_surface_t *dst;
-	const cairo_pattern_t   *src_pattern;
-	cairo_amigaos_surface_t *src;
-	float                    x1, y1, x2, y2;
-	float                    x, y;
-	my_vertex_t             *vertices;
-	uint16                  *indices;
-	int                      num_vertices, num_triangles;
-	int                      i, j;
-	struct Rectangle         bounds;
-	uint32                   error;
-
-	op = convert_operator_to_amigaos(extents->op);
-	if (op == COMPOSITE_Invalid)
+	cairo_matrix_t   texture_to_pattern, pattern_to_texture;
+	cairo_surface_t *surface;
+	double           dx, dy, span;
+	double           circles[6] = { 0 };
+	int              border;
+
+	dx = linear->pd2.x - linear->pd1.x;
+	dy = linear->pd2.y - linear->pd1.y;
+	if (dx == 0 && dy == 0)
 		return CAIRO_INT_STATUS_UNSUPPORTED;
 
-	dst = (cairo_amigaos_surface_t *)extents->surface;
+	/* With EXTEND_NONE the outermost texels stay transparent */
+	border = linear->base.base.extend == CAIRO_EXTEND_NONE ? 1 : 0;
+	span   = GRADIENT_RAMP_WIDTH - 2 * border;
 
-	src_pattern = &extents->source_pattern.base;
-	if (src_pattern->type != CAIRO_PATTERN_TYPE_SOLID)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	/* s runs along the gradient vector, t along its normal */
+	cairo_matrix_init(&texture_to_pattern,
+	                  dx / span, dy / span,
+	                  -dy, dx,
+	                  linear->pd1.x - border * dx / span,
+	                  linear->pd1.y - border * dy / span);
 
-	num_vertices = strip->num_points;
-	if (num_vertices < 3)
+	pattern_to_texture = texture_to_pattern;
+	if (unlikely (cairo_matrix_invert(&pattern_to_texture) != CAIRO_STATUS_SUCCESS))
 		return CAIRO_INT_STATUS_UNSUPPORTED;
 
-	src = (cairo_amigaos_surface_t *)pattern_to_amigaos_surface(src_pattern);
-	if (src->base.backend == NULL)
-		return src->base.status;
+	surface = gradient_surface_lookup(device, &linear->base, circles, &texture_to_pattern,
+	                                  GRADIENT_RAMP_WIDTH, 1);
+	if (unlikely (surface->status))
+		return surface->status;
+
+	src->surface = (cairo_amigaos_surface_t *)surface;
+	src->flags   = COMPFLAG_SrcFilter;
+	cairo_matrix_multiply(&src->matrix, &linear->base.base.matrix, &pattern_to_texture);
+
+	return CAIRO_INT_STATUS_SUCCESS;
+}
 
-	num_triangles = num_vertices - 2;
+static cairo_int_status_t
+acquire_radial_source (cairo_amigaos_device_t       *device,
+                       const cairo_radial_pattern_t *radial,
+                       struct composite_source      *src)
+{
+	const cairo_circle_double_t *inner, *outer;
+	cairo_matrix_t               texture_to_pattern, pattern_to_texture;
+	cairo_surface_t             *surface;
+	double                       r, scale;
+	double                       circles[6];
+
+	if (radial->cd2.radius >= radial->cd1.radius) {
+		inner = &radial->cd1;
+		outer = &radial->cd2;
+	} else {
+		inner = &radial->cd2;
+		outer = &radial->cd1;
+	}
 
-	vertices = malloc(sizeof(my_vertex_t) * num_vertices);
-	indices  = malloc(sizeof(uint16) * 3 * num_triangles);
+	/* Only nested circles have t > 1 everywhere outside the outer circle,
+	 * which is what lets a clamped texture of finite size stand in for
+	 * the whole plane.
+	 */
+	if (outer->radius <= 0 ||
+	    hypot(inner->center.x - outer->center.x, inner->center.y - outer->center.y) + inner->radius > outer->radius)
+		return CAIRO_INT_STATUS_UNSUPPORTED;
 
+	circles[0] = (radial->cd1.center.x - outer->center.x) / outer->radius;
+	circles[1] = (radial->cd1.center.y - outer->center.y) / outer->radius;
+	circles[2] = radial->cd1.radius / outer->radius;
+	circles[3] = (radial->cd2.center.x - outer->center.x) / outer->radius;
+	circles[4] = (radial->cd2.center.y - outer->center.y) / outer->radius;
+	circles[5] = radial->cd2.radius / outer->radius;
+
+	/* Leave one texel outside the outer circle on every side */
+	r     = outer->radius * GRADIENT_RADIAL_SIZE / (GRADIENT_RADIAL_SIZE - 2);
+	scale = 2 * r / GRADIENT_RADIAL_SIZE;
+
+	cairo_matrix_init(&texture_to_pattern,
+	                  scale, 0,
+	                  0, scale,
+	                  outer->center.x - r,
+	                  outer->center.y - r);
+
+	pattern_to_texture = texture_to_pattern;
+	if (unlikely (cairo_matrix_invert(&pattern_to_texture) != CAIRO_STATUS_SUCCESS))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
 
-	x = _cairo_fixed_to_double(strip->points[0].x);
-	y = _cairo_fixed_to_double(strip->points[0].y);
+	surface = gradient_surface_lookup(device, &radial->base, circles, &texture_to_pattern,
+	                                  GRADIENT_RADIAL_SIZE, GRADIENT_RADIAL_SIZE);
+	if (unlikely (surface->status))
+		return surface->status;
 
-	x1 = x2 = x;
-	y1 = y2 = y;
+	src->surface = (cairo_amigaos_surface_t *)surface;
+	src->flags   = COMPFLAG_SrcFilter;
+	cairo_matrix_multiply(&src->matrix, &radial->base.base.matrix, &pattern_to_texture);
 
-	vertices[0] = VERTEX(x, y, 0, 0, 1);
+	return CAIRO_INT_STATUS_SUCCESS;
+}
 
-	for (i = 1; i < num_vertices; i++) {
-		x = _cairo_fixed_to_double(strip->points[i].x);
-		y = _cairo_fixed_to_double(strip->points[i].y);
+/* Image sources are uploaded into a bitmap with a one texel transparent
+ * border, so that clamped lookups just outside the image behave like
+ * EXTEND_NONE. The upload is attached to the image as a snapshot, which
+ * cairo detaches again when the image is flushed before being modified or
+ * marked dirty, so unchanged images are uploaded only once.
+ */
+static cairo_amigaos_surface_t *
+image_upload (const cairo_amigaos_surface_t *dst,
+              cairo_image_surface_t         *image)
+{
+	cairo_amigaos_surface_t *clone;
+	cairo_image_surface_t   *argb;
+	struct BitMap           *bitmap;
 
-		if (x < x1)
-			x1 = x;
-		else if (x > x2)
-			x2 = x;
-		if (y < y1)
-			y1 = y;
-		else if (y > y2)
-			y2 = y;
+	clone = (cairo_amigaos_surface_t *)_cairo_surface_has_snapshot(&image->base, dst->base.backend);
+	if (clone != NULL)
+		return (cairo_amigaos_surface_t *)cairo_surface_reference(&clone->base);
 
-		vertices[i] = VERTEX(x, y, 0, 0, 1);
-	}
+	argb = _cairo_image_surface_coerce_to_format(image, CAIRO_FORMAT_ARGB32);
+	if (unlikely (argb->base.status))
+		return (cairo_amigaos_surface_t *)argb;
 
-	clip_and_init_bounds(dst, &bounds, x1, y1, x2, y2);
+	bitmap = IGraphics->AllocBitMapTags(image->width + 2, image->height + 2, 32,
+		BMATags_Friend,      dst->bitmap,
+		BMATags_PixelFormat, PIXF_A8R8G8B8,
+		BMATags_Clear,       TRUE,
+		TAG_END);
+	if (bitmap == NULL) {
+		cairo_surface_destroy(&argb->base);
+		return (cairo_amigaos_surface_t *)_cairo_surface_create_in_error(_cairo_error(CAIRO_STATUS_NO_MEMORY));
+	}
 
-	for (i = 0; i < num_triangles; i++) {
-		j = i * 3;
-		if ((i & 1) == 0) {
-			indices[j + 0] = i + 0;
-			indices[j + 1] = i + 1;
-			indices[j + 2] = i + 2;
-		} else {
-			indices[j + 0] = i + 1;
-			indices[j + 1] = i + 0;
-			indices[j + 2] = i + 2;
-		}
+	clone = (cairo_amigaos_surface_t *)cairo_amigaos_surface_create(bitmap);
+	if (unlikely (clone->base.backend == NULL)) {
+		IGraphics->FreeBitMap(bitmap);
+		cairo_surface_destroy(&argb->base);
+		return clone;
 	}
 
-	error = CompositeRastPortTags(op, src->bitmap, dst->rastport, &bounds,
-		COMPTAG_Flags,        COMPFLAG_HardwareOnly,
-		COMPTAG_IndexArray,   indices,
-		COMPTAG_VertexArray,  vertices,
-		COMPTAG_VertexFormat, COMPVF_STW0_Present,
-		COMPTAG_NumTriangles, num_triangles,
-		TAG_END);
+	clone->free_bitmap = TRUE;
 
-	if (likely (error == COMPERR_Success))
-		status = CAIRO_STATUS_SUCCESS;
+	IGraphics->WritePixelArray(argb->data, 0, 0, argb->stride, PIXF_A8R8G8B8,
+	                           clone->rastport, 1, 1, image->width, image->height);
 
-	free(vertices);
-	free(indices);
+	cairo_surface_destroy(&argb->base);
 
-	cairo_surface_destroy(&src->base);
+	_cairo_surface_attach_snapshot(&image->base, &clone->base, NULL);
 
-	return status;
+	return clone;
 }
 
 static cairo_int_status_t
-composite_traps (cairo_composite_rectangles_t *extents,
-                 cairo_traps_t                *traps)
+acquire_surface_source (const cairo_composite_rectangles_t *extents,
+                        const cairo_surface_pattern_t      *pattern,
+                        struct composite_source            *src)
 {
-	return CAIRO_INT_STATUS_UNSUPPORTED;
+	const cairo_amigaos_surface_t *dst = (const cairo_amigaos_surface_t *)extents->surface;
+	const cairo_rectangle_int_t   *sample = &extents->source_sample_area;
+	cairo_amigaos_surface_t       *surface;
+	int                            xoff, yoff, width, height;
+	cairo_bool_t                   has_border;
+
+	if (_cairo_surface_is_amigaos(pattern->surface)) {
+		surface = (cairo_amigaos_surface_t *)pattern->surface;
+
+		/* Reading and writing the same bitmap in one pass is undefined */
+		if (surface->bitmap == dst->bitmap)
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+
+		cairo_surface_reference(&surface->base);
+
+		xoff       = surface->xoff;
+		yoff       = surface->yoff;
+		width      = surface->width;
+		height     = surface->height;
+		has_border = FALSE;
+	} else if (_cairo_surface_is_image(pattern->surface)) {
+		cairo_image_surface_t *image = (cairo_image_surface_t *)pattern->surface;
+
+		if (image->width == 0 || image->height == 0)
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+
+		surface = image_upload(dst, image);
+		if (unlikely (surface->base.status))
+			return surface->base.status;
+
+		xoff       = 1;
+		yoff       = 1;
+		width      = image->width;
+		height     = image->height;
+		has_border = TRUE;
+	} else {
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+
+	/* Lookups are clamped to the edge of the bitmap, so the extend mode
+	 * only matters if the operation samples outside the surface.
+	 */
+	if (sample->x < 0 || sample->y < 0 ||
+	    sample->x + sample->width > width || sample->y + sample->height > height)
+	{
+		if (pattern->base.extend != CAIRO_EXTEND_NONE || ! has_border) {
+			cairo_surface_destroy(&surface->base);
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+		}
+	}
+
+	src->surface = surface;
+	src->matrix  = pattern->base.matrix;
+	src->matrix.x0 += xoff;
+	src->matrix.y0 += yoff;
+
+	switch (pattern->base.filter) {
+		case CAIRO_FILTER_FAST:
+		case CAIRO_FILTER_NEAREST:
+			src->flags = 0;
+			break;
+
+		case CAIRO_FILTER_GOOD:
+		case CAIRO_FILTER_BEST:
+		case CAIRO_FILTER_BILINEAR:
+		case CAIRO_FILTER_GAUSSIAN:
+		default:
+			/* Whole pixel offsets hit texel centres exactly */
+			if (_cairo_matrix_is_integer_translation(&pattern->base.matrix, NULL, NULL))
+				src->flags = 0;
+			else
+				src->flags = COMPFLAG_SrcFilter;
+			break;
+	}
+
+	return CAIRO_INT_STATUS_SUCCESS;
 }
 
 static cairo_int_status_t
-_cairo_amigaos_compositor_paint (const cairo_compositor_t     *_compositor,
-                                 cairo_composite_rectangles_t *extents)
+acquire_source (const cairo_composite_rectangles_t *extents,
+                struct composite_source            *src)
 {
-	cairo_int_status_t status;
-	cairo_boxes_t      boxes;
+	const cairo_pattern_t  *pattern = &extents->source_pattern.base;
+	cairo_amigaos_device_t *device = (cairo_amigaos_device_t *)extents->surface->device;
 
-	_cairo_clip_steal_boxes(extents->clip, &boxes);
+	if (! source_is_supported(pattern))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	switch (pattern->type) {
+		case CAIRO_PATTERN_TYPE_SOLID:
+		{
+			const cairo_color_t *color = &((cairo_solid_pattern_t *)pattern)->color;
+			cairo_surface_t     *surface;
+			uint32               argb;
+
+			/* Bitmaps hold premultiplied ARGB, as the gradient and
+			 * image uploads do */
+			argb = ARGB(color->alpha_short >> 8,
+			            color->red_short >> 8,
+			            color->green_short >> 8,
+			            color->blue_short >> 8);
+
+			surface = solid_surface_lookup(device, argb);
+			if (unlikely (surface->status))
+				return surface->status;
+
+			/* Every vertex samples the single texel */
+			src->surface = (cairo_amigaos_surface_t *)surface;
+			src->flags   = 0;
+			cairo_matrix_init(&src->matrix, 0, 0, 0, 0, 0, 0);
+
+			return CAIRO_INT_STATUS_SUCCESS;
+		}
+
+		case CAIRO_PATTERN_TYPE_LINEAR:
+			if (((cairo_gradient_pattern_t *)pattern)->n_stops == 0)
+				return CAIRO_INT_STATUS_UNSUPPORTED;
+
+			return acquire_linear_source(device, (const cairo_linear_pattern_t *)pattern, src);
+
+		case CAIRO_PATTERN_TYPE_RADIAL:
+			if (((cairo_gradient_pattern_t *)pattern)->n_stops == 0)
+				return CAIRO_INT_STATUS_UNSUPPORTED;
+
+			return acquire_radial_source(device, (const cairo_radial_pattern_t *)pattern, src);
+
+		case CAIRO_PATTERN_TYPE_SURFACE:
+			return acquire_surface_source(extents, (const cairo_surface_pattern_t *)pattern, src);
+
+		case CAIRO_PATTERN_TYPE_MESH:
+		case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
+		default:
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+}
+
+static void
+release_source (struct composite_source *src)
+{
+	cairo_surface_destroy(&src->surface->base);
+}
+
+static inline my_vertex_t
+source_vertex (const struct composite_source *src,
+               float                          x,
+               float                          y)
+{
+	return VERTEX(x, y,
+	              src->matrix.xx * x + src->matrix.xy * y + src->matrix.x0,
+	              src->matrix.yx * x + src->matrix.yy * y + src->matrix.y0,
+	              1);
+}
+
+static inline my_mask_vertex_t
+source_mask_vertex (const struct composite_source *src,
+                    float                          x,
+                    float                          y,
+                    float                          coverage)
+{
+	return MASK_VERTEX(x, y,
+	                   src->matrix.xx * x + src->matrix.xy * y + src->matrix.x0,
+	                   src->matrix.yx * x + src->matrix.yy * y + src->matrix.y0,
+	                   1,
+	                   COVERAGE_TO_S(coverage), 0, 1);
+}
+
+static inline my_mask_vertex_t
+source_glyph_vertex (const struct composite_source *src,
+                     float                          x,
+                     float                          y,
+                     float                          s1,
+                     float                          t1)
+{
+	return MASK_VERTEX(x, y,
+	                   src->matrix.xx * x + src->matrix.xy * y + src->matrix.x0,
+	                   src->matrix.yx * x + src->matrix.yy * y + src->matrix.y0,
+	                   1,
+	                   s1, t1, 1);
+}
+
+/* graphics.library folds the source alpha, COMPTAG_SrcAlpha and the
+ * SrcAlphaMask into the Porter-Duff equation, which is cairo's rule of
+ * applying the operator to the source IN the coverage for every operator
+ * but CLEAR and SOURCE. For those two cairo interpolates between the
+ * destination and the result by the coverage instead, which is emulated
+ * by first cutting the coverage out of the destination and then, for
+ * SOURCE, adding the source on top.
+ *
+ * SATURATE is drawn as DEST_OVER where the two agree, see
+ * composite_operator(). It and the blend modes need the destination
+ * colour in the equation, so they cannot be expressed otherwise.
+ */
+struct composite_pass {
+	uint32       op;
+	cairo_bool_t coverage_only;
+};
+
+struct composite_op {
+	struct composite_pass    passes[2];
+	int                      num_passes;
+	cairo_amigaos_surface_t *white;
+};
+
+static cairo_bool_t
+operator_is_linear_in_coverage (cairo_operator_t op)
+{
+	switch (op) {
+		case CAIRO_OPERATOR_OVER:
+		case CAIRO_OPERATOR_IN:
+		case CAIRO_OPERATOR_OUT:
+		case CAIRO_OPERATOR_ATOP:
+		case CAIRO_OPERATOR_DEST:
+		case CAIRO_OPERATOR_DEST_OVER:
+		case CAIRO_OPERATOR_DEST_IN:
+		case CAIRO_OPERATOR_DEST_OUT:
+		case CAIRO_OPERATOR_DEST_ATOP:
+		case CAIRO_OPERATOR_XOR:
+		case CAIRO_OPERATOR_ADD:
+			return TRUE;
+
+		default:
+			return FALSE;
+	}
+}
+
+/* SATURATE adds as much of the source as still fits under the
+ * destination alpha: nothing on a destination without alpha, and exactly
+ * DEST_OVER where the source is opaque and the coverage all or nothing.
+ */
+static cairo_operator_t
+composite_operator (const cairo_composite_rectangles_t *extents,
+                    cairo_bool_t                        has_coverage)
+{
+	const cairo_amigaos_surface_t *dst = (const cairo_amigaos_surface_t *)extents->surface;
+
+	if (extents->op != CAIRO_OPERATOR_SATURATE)
+		return extents->op;
+
+	if (dst->content == CAIRO_CONTENT_COLOR)
+		return CAIRO_OPERATOR_DEST;
+
+	if (! has_coverage &&
+	    _cairo_pattern_is_opaque(&extents->source_pattern.base, &extents->source_sample_area))
+		return CAIRO_OPERATOR_DEST_OVER;
+
+	return extents->op;
+}
+
+/* Cheap check for whether init_composite_op() may succeed */
+static cairo_bool_t
+operator_is_supported (cairo_operator_t op,
+                       cairo_bool_t     has_coverage)
+{
+	if (convert_operator_to_amigaos(op) == COMPOSITE_Invalid)
+		return FALSE;
+
+	if (! has_coverage)
+		return TRUE;
+
+	return op == CAIRO_OPERATOR_CLEAR || op == CAIRO_OPERATOR_SOURCE ||
+	       operator_is_linear_in_coverage(op);
+}
+
+static cairo_int_status_t
+init_composite_op (struct composite_op           *cop,
+                   const cairo_amigaos_surface_t *dst,
+                   cairo_operator_t               op,
+                   cairo_bool_t                   has_coverage)
+{
+	cairo_surface_t *white;
+
+	cop->white = NULL;
+
+	if (! operator_is_supported(op, has_coverage))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	if (! has_coverage || operator_is_linear_in_coverage(op)) {
+		cop->passes[0].op            = convert_operator_to_amigaos(op);
+		cop->passes[0].coverage_only = FALSE;
+		cop->num_passes              = 1;
+		return CAIRO_INT_STATUS_SUCCESS;
+	}
+
+	/* The coverage passes sample an opaque texel wherever the vertices
+	 * point, so the source's texture coordinates can be reused.
+	 */
+	white = solid_surface_lookup((cairo_amigaos_device_t *)dst->base.device, 0xffffffff);
+	if (unlikely (white->status))
+		return white->status;
+
+	cop->white = (cairo_amigaos_surface_t *)white;
+
+	cop->passes[0].op            = COMPOSITE_Dest_Out_Src;
+	cop->passes[0].coverage_only = TRUE;
+	cop->num_passes              = 1;
+
+	if (op == CAIRO_OPERATOR_SOURCE) {
+		cop->passes[1].op            = COMPOSITE_Plus;
+		cop->passes[1].coverage_only = FALSE;
+		cop->num_passes              = 2;
+	}
+
+	return CAIRO_INT_STATUS_SUCCESS;
+}
+
+static void
+fini_composite_op (struct composite_op *cop)
+{
+	if (cop->white != NULL)
+		cairo_surface_destroy(&cop->white->base);
+}
+
+static uint32
+CompositeOpTagList (const struct composite_op     *cop,
+                    const struct composite_source *src,
+                    cairo_amigaos_surface_t       *dst,
+                    const struct Rectangle        *bounds,
+                    const struct TagItem          *tags)
+{
+	struct BitMap *bitmap;
+	uint32         error = COMPERR_Success;
+	int            i;
+
+	for (i = 0; i < cop->num_passes && error == COMPERR_Success; i++) {
+		bitmap = cop->passes[i].coverage_only ? cop->white->bitmap : src->surface->bitmap;
+
+		error = CompositeRastPortTagList(cop->passes[i].op, bitmap, dst->rastport, bounds, tags);
+	}
+
+	return error;
+}
+
+static VARARGS68K uint32
+CompositeOpTags (const struct composite_op     *cop,
+                 const struct composite_source *src,
+                 cairo_amigaos_surface_t       *dst,
+                 const struct Rectangle        *bounds,
+                 ...)
+{
+	uint32  error;
+	va_list tags;
+
+	va_startlinear(tags, bounds);
+	error = CompositeOpTagList(cop, src, dst, bounds,
+	                           va_getlinearva(tags, const struct TagItem *));
+	va_end(tags);
+
+	return error;
+}
+
+struct composite_data {
+	const struct composite_op     *op;
+	const struct composite_source *src;
+	cairo_amigaos_surface_t       *dst;
+	uint32                         alpha;
+};
+
+static cairo_bool_t
+composite_box (cairo_box_t *box, void *user_data)
+{
+	struct composite_data *cd = user_data;
+	float                  x1, y1, x2, y2;
+	struct Rectangle       bounds;
+	my_vertex_t            vertices[4];
+	uint16                 indices[6];
+	uint32                 error;
+
+	x1 = _cairo_fixed_to_double(box->p1.x);
+	y1 = _cairo_fixed_to_double(box->p1.y);
+	x2 = _cairo_fixed_to_double(box->p2.x);
+	y2 = _cairo_fixed_to_double(box->p2.y);
+
+	clip_and_init_bounds(cd->dst, &bounds, x1, y1, x2, y2);
+
+	vertices[0] = source_vertex(cd->src, x1, y1);
+	vertices[1] = source_vertex(cd->src, x2, y1);
+	vertices[2] = source_vertex(cd->src, x1, y2);
+	vertices[3] = source_vertex(cd->src, x2, y2);
+
+	indices[0] = 0;
+	indices[1] = 1;
+	indices[2] = 2;
+	indices[3] = 2;
+	indices[4] = 1;
+	indices[5] = 3;
+
+	error = CompositeOpTags(cd->op, cd->src, cd->dst, &bounds,
+		COMPTAG_Flags,        COMPFLAG_HardwareOnly | cd->src->flags,
+		COMPTAG_IndexArray,   indices,
+		COMPTAG_VertexArray,  vertices,
+		COMPTAG_VertexFormat, COMPVF_STW0_Present,
+		COMPTAG_NumTriangles, 2,
+		COMPTAG_SrcAlpha,     cd->alpha,
+		TAG_END);
+
+	if (unlikely (error != COMPERR_Success))
+		return FALSE;
+
+	return TRUE;
+}
+
+/* All boxes of a batch share one vertex and index array, so they are
+ * submitted with a single CompositeTags call and a single walk of the
+ * layer cliprects.
+ */
+#define BOX_VERTICES        4
+#define BOX_INDICES         6
+#define MAX_BATCH_BOXES     (MAX_BATCH_VERTICES / BOX_VERTICES)
+#define BOXES_EMBEDDED      16
+
+static cairo_bool_t
+composite_box_batch (struct composite_data *cd,
+                     const my_vertex_t     *vertices,
+                     const uint16          *indices,
+                     int                    num_boxes,
+                     float                  x1,
+                     float                  y1,
+                     float                  x2,
+                     float                  y2)
+{
+	struct Rectangle bounds;
+	uint32           error;
+
+	clip_and_init_bounds(cd->dst, &bounds, x1, y1, x2, y2);
+
+	error = CompositeOpTags(cd->op, cd->src, cd->dst, &bounds,
+		COMPTAG_Flags,        COMPFLAG_HardwareOnly | cd->src->flags,
+		COMPTAG_IndexArray,   indices,
+		COMPTAG_VertexArray,  vertices,
+		COMPTAG_VertexFormat, COMPVF_STW0_Present,
+		COMPTAG_NumTriangles, 2 * num_boxes,
+		COMPTAG_SrcAlpha,     cd->alpha,
+		TAG_END);
+
+	return error == COMPERR_Success;
+}
+
+static cairo_int_status_t
+composite_boxes_batched (struct composite_data *cd,
+                         const cairo_boxes_t   *boxes)
+{
+	const struct _cairo_boxes_chunk *chunk;
+	my_vertex_t                      vertices_embedded[BOXES_EMBEDDED * BOX_VERTICES];
+	uint16                           indices_embedded[BOXES_EMBEDDED * BOX_INDICES];
+	my_vertex_t                     *vertices, *v;
+	uint16                          *indices;
+	int                              batch_size, n, i;
+	float                            x1, y1, x2, y2;
+	cairo_bool_t                     committed = FALSE;
+	cairo_int_status_t               status = CAIRO_INT_STATUS_SUCCESS;
+
+	batch_size = MIN(boxes->num_boxes, MAX_BATCH_BOXES);
+
+	if (batch_size <= BOXES_EMBEDDED) {
+		vertices = vertices_embedded;
+		indices  = indices_embedded;
+	} else {
+		vertices = _cairo_malloc_ab(batch_size, BOX_VERTICES * sizeof(my_vertex_t));
+		indices  = _cairo_malloc_ab(batch_size, BOX_INDICES * sizeof(uint16));
+		if (unlikely (vertices == NULL || indices == NULL)) {
+			free(vertices);
+			free(indices);
+			return CAIRO_INT_STATUS_NO_MEMORY;
+		}
+	}
+
+	/* The index pattern is the same for every batch */
+	for (i = 0; i < batch_size; i++) {
+		uint16 *idx  = &indices[i * BOX_INDICES];
+		uint16  base = i * BOX_VERTICES;
+
+		idx[0] = base + 0;
+		idx[1] = base + 1;
+		idx[2] = base + 2;
+		idx[3] = base + 2;
+		idx[4] = base + 1;
+		idx[5] = base + 3;
+	}
+
+	v = vertices;
+	n = 0;
+	x1 = y1 = HUGE_VALF;
+	x2 = y2 = -HUGE_VALF;
+
+	for (chunk = &boxes->chunks; chunk != NULL; chunk = chunk->next) {
+		for (i = 0; i < chunk->count; i++) {
+			const cairo_box_t *box = &chunk->base[i];
+			float              bx1, by1, bx2, by2;
+
+			bx1 = _cairo_fixed_to_double(box->p1.x);
+			by1 = _cairo_fixed_to_double(box->p1.y);
+			bx2 = _cairo_fixed_to_double(box->p2.x);
+			by2 = _cairo_fixed_to_double(box->p2.y);
+
+			v[0] = source_vertex(cd->src, bx1, by1);
+			v[1] = source_vertex(cd->src, bx2, by1);
+			v[2] = source_vertex(cd->src, bx1, by2);
+			v[3] = source_vertex(cd->src, bx2, by2);
+			v += BOX_VERTICES;
+
+			x1 = MIN(x1, bx1);
+			y1 = MIN(y1, by1);
+			x2 = MAX(x2, bx2);
+			y2 = MAX(y2, by2);
+
+			if (++n == batch_size) {
+				if (unlikely (! composite_box_batch(cd, vertices, indices, n, x1, y1, x2, y2))) {
+					status = CAIRO_INT_STATUS_UNSUPPORTED;
+					goto CLEANUP;
+				}
+
+				committed = TRUE;
+
+				v = vertices;
+				n = 0;
+				x1 = y1 = HUGE_VALF;
+				x2 = y2 = -HUGE_VALF;
+			}
+		}
+	}
+
+	if (n > 0 && unlikely (! composite_box_batch(cd, vertices, indices, n, x1, y1, x2, y2)))
+		status = CAIRO_INT_STATUS_UNSUPPORTED;
+
+CLEANUP:
+	/* Earlier batches are already drawn, falling back would draw them again */
+	if (status == CAIRO_INT_STATUS_UNSUPPORTED && committed)
+		status = _cairo_error(CAIRO_STATUS_DEVICE_ERROR);
+
+	if (vertices != vertices_embedded) {
+		free(vertices);
+		free(indices);
+	}
+
+	return status;
+}
+
+static cairo_int_status_t
+composite_box_list (struct composite_data *cd,
+                    cairo_boxes_t         *boxes)
+{
+	cairo_amigaos_device_t *device = (cairo_amigaos_device_t *)cd->dst->base.device;
+	cairo_int_status_t      status;
+
+	if (boxes->num_boxes == 0)
+		return CAIRO_INT_STATUS_SUCCESS;
+
+	if (device->batch_boxes && boxes->num_boxes > 1) {
+		status = composite_boxes_batched(cd, boxes);
+		if (status != CAIRO_INT_STATUS_NO_MEMORY)
+			return status;
+	}
+
+	/* One submission per box, needs no extra memory */
+	if (likely (_cairo_boxes_for_each_box(boxes, composite_box, cd)))
+		return CAIRO_INT_STATUS_SUCCESS;
+
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+}
+
+static cairo_int_status_t
+composite_boxes (cairo_composite_rectangles_t *extents,
+                 cairo_boxes_t                *boxes)
+{
+	cairo_int_status_t       status;
+	struct composite_op      op;
+	cairo_amigaos_surface_t *dst;
+	struct composite_source  src;
+	struct composite_data    cd;
+
+	dst = (cairo_amigaos_surface_t *)extents->surface;
+
+	status = init_composite_op(&op, dst, composite_operator(extents, FALSE), FALSE);
+	if (unlikely (status))
+		return status;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status)) {
+		fini_composite_op(&op);
+		return status;
+	}
+
+	cd.op    = &op;
+	cd.src   = &src;
+	cd.dst   = dst;
+	cd.alpha = COMP_FIX_ONE;
+
+	status = composite_box_list(&cd, boxes);
+
+	release_source(&src);
+	fini_composite_op(&op);
+
+	return status;
+}
+
+static cairo_int_status_t
+composite_boxes_with_mask (cairo_composite_rectangles_t *extents,
+                           cairo_boxes_t                *boxes)
+{
+	cairo_int_status_t       status;
+	struct composite_op      op;
+	cairo_amigaos_surface_t *dst;
+	const cairo_pattern_t   *mask_pattern;
+	double                   alpha;
+	struct composite_source  src;
+	struct composite_data    cd;
+
+	dst = (cairo_amigaos_surface_t *)extents->surface;
+
+	mask_pattern = &extents->mask_pattern.base;
+	if (mask_pattern->type != CAIRO_PATTERN_TYPE_SOLID)
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	alpha = ((cairo_solid_pattern_t *)mask_pattern)->color.alpha;
+
+	status = init_composite_op(&op, dst,
+	                           composite_operator(extents, ! CAIRO_ALPHA_IS_OPAQUE(alpha)),
+	                           ! CAIRO_ALPHA_IS_OPAQUE(alpha));
+	if (unlikely (status))
+		return status;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status)) {
+		fini_composite_op(&op);
+		return status;
+	}
+
+	cd.op    = &op;
+	cd.src   = &src;
+	cd.dst   = dst;
+	cd.alpha = COMP_FLOAT_TO_FIX(alpha);
+
+	status = composite_box_list(&cd, boxes);
+
+	release_source(&src);
+	fini_composite_op(&op);
+
+	return status;
+}
+
+static cairo_bool_t
+composite_tristrip_batch (const struct composite_op *op,
+                          struct composite_source   *src,
+                          cairo_amigaos_surface_t   *dst,
+                          const cairo_point_t       *points,
+                          int                        num_vertices,
+                          my_vertex_t               *vertices,
+                          const uint16              *indices)
+{
+	float            x1, y1, x2, y2;
+	float            x, y;
+	int              i;
+	struct Rectangle bounds;
+	uint32           error;
+
+	x = _cairo_fixed_to_double(points[0].x);
+	y = _cairo_fixed_to_double(points[0].y);
+
+	x1 = x2 = x;
+	y1 = y2 = y;
+
+	vertices[0] = source_vertex(src, x, y);
+
+	for (i = 1; i < num_vertices; i++) {
+		x = _cairo_fixed_to_double(points[i].x);
+		y = _cairo_fixed_to_double(points[i].y);
+
+		if (x < x1)
+			x1 = x;
+		else if (x > x2)
+			x2 = x;
+		if (y < y1)
+			y1 = y;
+		else if (y > y2)
+			y2 = y;
+
+		vertices[i] = source_vertex(src, x, y);
+	}
+
+	clip_and_init_bounds(dst, &bounds, x1, y1, x2, y2);
+
+	error = CompositeOpTags(op, src, dst, &bounds,
+		COMPTAG_Flags,        COMPFLAG_HardwareOnly | src->flags,
+		COMPTAG_IndexArray,   indices,
+		COMPTAG_VertexArray,  vertices,
+		COMPTAG_VertexFormat, COMPVF_STW0_Present,
+		COMPTAG_NumTriangles, num_vertices - 2,
+		TAG_END);
+
+	return error == COMPERR_Success;
+}
+
+static cairo_int_status_t
+composite_tristrip (cairo_composite_rectangles_t *extents,
+                    cairo_tristrip_t             *strip)
+{
+	cairo_int_status_t       status;
+	struct composite_op      op;
+	cairo_amigaos_surface_t *dst;
+	struct composite_source  src;
+	my_vertex_t             *vertices;
+	uint16                  *indices;
+	int                      batch_size, num_vertices;
+	int                      i, j;
+	cairo_bool_t             committed = FALSE;
+
+	dst = (cairo_amigaos_surface_t *)extents->surface;
+
+	if (strip->num_points < 3)
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	/* Batches overlap by two vertices and start on an even one, so the
+	 * winding of every triangle is the same as in the whole strip. */
+	batch_size = MIN(strip->num_points, MAX_BATCH_VERTICES);
+
+	vertices = _cairo_malloc_ab(batch_size, sizeof(my_vertex_t));
+	indices  = _cairo_malloc_ab(batch_size - 2, 3 * sizeof(uint16));
+	if (unlikely (vertices == NULL || indices == NULL)) {
+		status = _cairo_error(CAIRO_STATUS_NO_MEMORY);
+		goto CLEANUP_VERTICES;
+	}
+
+	for (i = 0; i < batch_size - 2; i++) {
+		j = i * 3;
+		if ((i & 1) == 0) {
+			indices[j + 0] = i + 0;
+			indices[j + 1] = i + 1;
+			indices[j + 2] = i + 2;
+		} else {
+			indices[j + 0] = i + 1;
+			indices[j + 1] = i + 0;
+			indices[j + 2] = i + 2;
+		}
+	}
+
+	status = init_composite_op(&op, dst, composite_operator(extents, FALSE), FALSE);
+	if (unlikely (status))
+		goto CLEANUP_VERTICES;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status))
+		goto CLEANUP_OP;
+
+	for (i = 0; i + 2 < strip->num_points; i += num_vertices - 2) {
+		num_vertices = MIN(strip->num_points - i, batch_size);
+
+		if (unlikely (! composite_tristrip_batch(&op, &src, dst, strip->points + i,
+		                                         num_vertices, vertices, indices))) {
+			/* Earlier batches are already drawn, falling back would draw them again */
+			status = committed ? _cairo_error(CAIRO_STATUS_DEVICE_ERROR) : CAIRO_INT_STATUS_UNSUPPORTED;
+			break;
+		}
+
+		committed = TRUE;
+	}
+
+	release_source(&src);
+
+CLEANUP_OP:
+	fini_composite_op(&op);
+
+CLEANUP_VERTICES:
+	free(vertices);
+	free(indices);
+
+	return status;
+}
+
+/* Checks whether the operation can be rendered with composite_mask_vertices(),
+ * i.e. as geometry carrying per-vertex coverage.
+ */
+static cairo_bool_t
+can_composite_with_coverage (const cairo_composite_rectangles_t *extents,
+                             cairo_antialias_t                   antialias)
+{
+	const cairo_amigaos_surface_t *dst = (const cairo_amigaos_surface_t *)extents->surface;
+	const cairo_amigaos_device_t  *device = (const cairo_amigaos_device_t *)dst->base.device;
+
+	if (! operator_is_supported(composite_operator(extents, antialias != CAIRO_ANTIALIAS_NONE),
+	                           antialias != CAIRO_ANTIALIAS_NONE))
+		return FALSE;
+
+	if (! _cairo_clip_is_region(extents->clip))
+		return FALSE;
+
+	if (device->coverage_ramp == NULL)
+		return FALSE;
+
+	if (! source_is_supported(&extents->source_pattern.base))
+		return FALSE;
+
+	return TRUE;
+}
+
+/* Draws the geometry once per clip box. *committed is set once anything
+ * has reached the destination; from then on a failure can no longer be
+ * handed to the fallback, which would draw the whole operation again, so
+ * it is reported as a device error instead.
+ */
+static cairo_int_status_t
+composite_mask_vertices (const struct composite_op      *op,
+                         const struct composite_source *src,
+                         struct BitMap                 *mask,
+                         cairo_amigaos_surface_t       *dst,
+                         const cairo_clip_t            *clip,
+                         const cairo_rectangle_int_t   *extents,
+                         const my_mask_vertex_t        *vertices,
+                         const uint16                  *indices,
+                         int                            num_triangles,
+                         cairo_bool_t                  *committed)
+{
+	cairo_rectangle_int_t  surface_rect, rect;
+	struct Rectangle       bounds;
+	int                    num_boxes, i;
+	uint32                 error;
+
+	surface_rect.x      = 0;
+	surface_rect.y      = 0;
+	surface_rect.width  = dst->width;
+	surface_rect.height = dst->height;
+
+	num_boxes = (clip != NULL && clip->num_boxes > 0) ? clip->num_boxes : 1;
+
+	for (i = 0; i < num_boxes; i++) {
+		if (clip == NULL)
+			rect = surface_rect;
+		else if (clip->num_boxes == 0)
+			rect = clip->extents;
+		else
+			_cairo_box_round_to_rectangle(&clip->boxes[i], &rect);
+
+		if (! _cairo_rectangle_intersect(&rect, extents) ||
+		    ! _cairo_rectangle_intersect(&rect, &surface_rect))
+			continue;
+
+		bounds.MinX = dst->xoff + rect.x;
+		bounds.MinY = dst->yoff + rect.y;
+		bounds.MaxX = dst->xoff + rect.x + rect.width - 1;
+		bounds.MaxY = dst->yoff + rect.y + rect.height - 1;
+
+		error = CompositeOpTags(op, src, dst, &bounds,
+			COMPTAG_Flags,        COMPFLAG_HardwareOnly | src->flags,
+			COMPTAG_SrcAlphaMask, mask,
+			COMPTAG_IndexArray,   indices,
+			COMPTAG_VertexArray,  vertices,
+			COMPTAG_VertexFormat, COMPVF_STW0_Present | COMPVF_STW1_Present,
+			COMPTAG_NumTriangles, num_triangles,
+			TAG_END);
+
+		if (unlikely (error != COMPERR_Success)) {
+			if (*committed)
+				return _cairo_error(CAIRO_STATUS_DEVICE_ERROR);
+
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+		}
+
+		*committed = TRUE;
+	}
+
+	return CAIRO_INT_STATUS_SUCCESS;
+}
+
+/* Each trapezoid is emitted as up to three bands, each made of two rows of
+ * four vertices. The vertices in a row are the outer and inner ends of the
+ * left edge fringe followed by the inner and outer ends of the right edge
+ * fringe, so the three quads between the rows of a band are the left
+ * fringe, the solid interior and the right fringe.
+ *
+ * With antialiasing the pixel rows cut by the top and bottom of the
+ * trapezoid get bands of their own spanning the whole pixel row, with the
+ * coverage scaled by the fraction of the row the trapezoid covers. The
+ * rows in between form the middle band at full coverage.
+ */
+#define TRAP_ROW_VERTICES  4
+#define TRAP_BAND_INDICES  18
+#define TRAP_VERTICES      (3 * 2 * TRAP_ROW_VERTICES)
+#define TRAP_INDICES       (3 * TRAP_BAND_INDICES)
+#define MAX_BATCH_TRAPS    (MAX_BATCH_VERTICES / TRAP_VERTICES)
+
+/* Returns the horizontal distance from the edge at which the coverage
+ * reaches 0 (outside) or 1 (inside), i.e. half a pixel measured along the
+ * edge normal.
+ */
+static float
+edge_fringe_width (const cairo_line_t *edge)
+{
+	float dx, dy;
+
+	dx = _cairo_fixed_to_double(edge->p2.x - edge->p1.x);
+	dy = _cairo_fixed_to_double(edge->p2.y - edge->p1.y);
+
+	if (dy == 0)
+		return 0.5f;
+
+	return 0.5f * sqrtf(dx * dx + dy * dy) / fabsf(dy);
+}
+
+static void
+emit_trap_row (my_mask_vertex_t              *v,
+               const struct composite_source *src,
+               float                          y,
+               float                          xl,
+               float                          hl,
+               float                          xr,
+               float                          hr,
+               float                          weight)
+{
+	float xi_l, xi_r, coverage;
+
+	if (xl + hl <= xr - hr) {
+		xi_l     = xl + hl;
+		xi_r     = xr - hr;
+		coverage = 1;
+	} else {
+		/* The fringes overlap, so meet where both ramps agree */
+		xi_l     = (xl * hr + xr * hl) / (hl + hr);
+		xi_r     = xi_l;
+		coverage = (xr - xl) / (hl + hr);
+		if (coverage < 0)
+			coverage = 0;
+	}
+
+	v[0] = source_mask_vertex(src, xl - hl, y, 0);
+	v[1] = source_mask_vertex(src, xi_l,    y, coverage * weight);
+	v[2] = source_mask_vertex(src, xi_r,    y, coverage * weight);
+	v[3] = source_mask_vertex(src, xr + hr, y, 0);
+}
+
+/* Emits the band of the trapezoid between the vertex rows y1 and y2, with
+ * the edges evaluated at the trapezoid heights fy1 and fy2. Returns the
+ * number of vertices written.
+ */
+static int
+emit_trap_band (my_mask_vertex_t              *v,
+                uint16                        *idx,
+                int                            base,
+                const struct composite_source *src,
+                const cairo_trapezoid_t       *trap,
+                float                          hl,
+                float                          hr,
+                float                          y1,
+                cairo_fixed_t                  fy1,
+                float                          y2,
+                cairo_fixed_t                  fy2,
+                float                          weight)
+{
+	int j;
+
+	emit_trap_row(v, src, y1,
+	              _cairo_fixed_to_double(_cairo_edge_compute_intersection_x_for_y(&trap->left.p1, &trap->left.p2, fy1)), hl,
+	              _cairo_fixed_to_double(_cairo_edge_compute_intersection_x_for_y(&trap->right.p1, &trap->right.p2, fy1)), hr,
+	              weight);
+	emit_trap_row(v + TRAP_ROW_VERTICES, src, y2,
+	              _cairo_fixed_to_double(_cairo_edge_compute_intersection_x_for_y(&trap->left.p1, &trap->left.p2, fy2)), hl,
+	              _cairo_fixed_to_double(_cairo_edge_compute_intersection_x_for_y(&trap->right.p1, &trap->right.p2, fy2)), hr,
+	              weight);
+
+	for (j = 0; j < 3; j++) {
+		idx[0] = base + j;
+		idx[1] = base + j + 1;
+		idx[2] = base + j + TRAP_ROW_VERTICES;
+		idx[3] = base + j + TRAP_ROW_VERTICES;
+		idx[4] = base + j + 1;
+		idx[5] = base + j + TRAP_ROW_VERTICES + 1;
+		idx += 6;
+	}
+
+	return 2 * TRAP_ROW_VERTICES;
+}
+
+static cairo_int_status_t
+composite_traps_batch (const struct composite_op      *op,
+                       const struct composite_source *src,
+                       struct BitMap                 *mask,
+                       cairo_amigaos_surface_t       *dst,
+                       const cairo_clip_t            *clip,
+                       const cairo_trapezoid_t       *traps,
+                       int                            num_traps,
+                       cairo_antialias_t              antialias,
+                       my_mask_vertex_t              *vertices,
+                       uint16                        *indices,
+                       cairo_bool_t                  *committed)
+{
+	const cairo_trapezoid_t *trap;
+	float                    hl, hr;
+	float                    x1, y1, x2, y2;
+	my_mask_vertex_t        *v, *first;
+	uint16                  *idx;
+	int                      i, n;
+	cairo_rectangle_int_t    rect;
+
+	x1 = y1 = HUGE_VALF;
+	x2 = y2 = -HUGE_VALF;
+
+	v   = vertices;
+	idx = indices;
+	n   = 0;
+
+	for (i = 0; i < num_traps; i++) {
+		trap = &traps[i];
+
+		if (trap->top >= trap->bottom)
+			continue;
+
+		first = v;
+
+		if (antialias != CAIRO_ANTIALIAS_NONE) {
+			cairo_fixed_t top, bottom, row;
+
+			hl = edge_fringe_width(&trap->left);
+			hr = edge_fringe_width(&trap->right);
+
+			top    = trap->top;
+			bottom = trap->bottom;
+			row    = _cairo_fixed_floor(top);
+
+			if (row == _cairo_fixed_floor(bottom - 1)) {
+				/* Top and bottom cut the same pixel row */
+				v += emit_trap_band(v, idx, v - vertices, src, trap, hl, hr,
+				                    _cairo_fixed_to_double(row), top,
+				                    _cairo_fixed_to_double(row + CAIRO_FIXED_ONE), bottom,
+				                    _cairo_fixed_to_double(bottom - top));
+				idx += TRAP_BAND_INDICES;
+			} else {
+				if (top != row) {
+					row += CAIRO_FIXED_ONE;
+					v += emit_trap_band(v, idx, v - vertices, src, trap, hl, hr,
+					                    _cairo_fixed_to_double(row - CAIRO_FIXED_ONE), top,
+					                    _cairo_fixed_to_double(row), row,
+					                    _cairo_fixed_to_double(row - top));
+					idx += TRAP_BAND_INDICES;
+					top = row;
+				}
+
+				row = _cairo_fixed_floor(bottom);
+				if (row > top) {
+					v += emit_trap_band(v, idx, v - vertices, src, trap, hl, hr,
+					                    _cairo_fixed_to_double(top), top,
+					                    _cairo_fixed_to_double(row), row,
+					                    1);
+					idx += TRAP_BAND_INDICES;
+				}
+
+				if (bottom != row) {
+					v += emit_trap_band(v, idx, v - vertices, src, trap, hl, hr,
+					                    _cairo_fixed_to_double(row), row,
+					                    _cairo_fixed_to_double(row + CAIRO_FIXED_ONE), bottom,
+					                    _cairo_fixed_to_double(bottom - row));
+					idx += TRAP_BAND_INDICES;
+				}
+			}
+		} else {
+			hl = hr = 0;
+
+			v += emit_trap_band(v, idx, v - vertices, src, trap, hl, hr,
+			                    _cairo_fixed_to_double(trap->top), trap->top,
+			                    _cairo_fixed_to_double(trap->bottom), trap->bottom,
+			                    1);
+			idx += TRAP_BAND_INDICES;
+		}
+
+		/* The outer fringe vertices bound every band */
+		for (; first < v; first += TRAP_ROW_VERTICES) {
+			x1 = MIN(x1, first[0].x);
+			x2 = MAX(x2, first[3].x);
+			y1 = MIN(y1, first[0].y);
+			y2 = MAX(y2, first[0].y);
+		}
+
+		n = v - vertices;
+	}
+
+	if (n == 0)
+		return CAIRO_INT_STATUS_SUCCESS;
+
+	rect.x      = (int)floorf(x1);
+	rect.y      = (int)floorf(y1);
+	rect.width  = (int)ceilf(x2) - rect.x;
+	rect.height = (int)ceilf(y2) - rect.y;
+
+	return composite_mask_vertices(op, src, mask, dst, clip, &rect,
+	                               vertices, indices, (idx - indices) / 3,
+	                               committed);
+}
+
+static cairo_int_status_t
+composite_traps (cairo_composite_rectangles_t *extents,
+                 cairo_traps_t                *traps,
+                 cairo_antialias_t             antialias)
+{
+	cairo_int_status_t       status;
+	struct composite_op      op;
+	cairo_amigaos_surface_t *dst;
+	cairo_amigaos_device_t  *device;
+	struct composite_source  src;
+	my_mask_vertex_t        *vertices;
+	uint16                  *indices;
+	int                      batch_size, num_traps, i;
+	cairo_bool_t             committed = FALSE;
+
+	if (! can_composite_with_coverage(extents, antialias))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	dst    = (cairo_amigaos_surface_t *)extents->surface;
+	device = (cairo_amigaos_device_t *)dst->base.device;
+
+	if (traps->num_traps == 0)
+		return CAIRO_INT_STATUS_SUCCESS;
+
+	batch_size = MIN(traps->num_traps, MAX_BATCH_TRAPS);
+
+	vertices = _cairo_malloc_ab(batch_size, TRAP_VERTICES * sizeof(my_mask_vertex_t));
+	indices  = _cairo_malloc_ab(batch_size, TRAP_INDICES * sizeof(uint16));
+	if (unlikely (vertices == NULL || indices == NULL)) {
+		status = _cairo_error(CAIRO_STATUS_NO_MEMORY);
+		goto CLEANUP_VERTICES;
+	}
+
+	status = init_composite_op(&op, dst,
+	                           composite_operator(extents, antialias != CAIRO_ANTIALIAS_NONE),
+	                           antialias != CAIRO_ANTIALIAS_NONE);
+	if (unlikely (status))
+		goto CLEANUP_VERTICES;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status))
+		goto CLEANUP_OP;
+
+	for (i = 0; i < traps->num_traps && status == CAIRO_INT_STATUS_SUCCESS; i += num_traps) {
+		num_traps = MIN(traps->num_traps - i, batch_size);
+
+		status = composite_traps_batch(&op, &src, device->coverage_ramp, dst,
+		                               extents->clip, traps->traps + i, num_traps,
+		                               antialias, vertices, indices,
+		                               &committed);
+	}
+
+	release_source(&src);
+
+CLEANUP_OP:
+	fini_composite_op(&op);
+
+CLEANUP_VERTICES:
+	free(vertices);
+	free(indices);
+
+	return status;
+}
+
+/* Convex paths are common (circles, rounded rectangles, rotated rectangles)
+ * and can be drawn as a triangle fan without running the tessellator.
+ */
+#define CONVEX_POINTS_EMBEDDED 64
+#define MAX_CONVEX_POINTS      (MAX_BATCH_VERTICES / 2)
+
+struct convex_path {
+	cairo_point_t *points;
+	int            num_points;
+	int            size;
+	int            num_subpaths;
+	cairo_point_t  points_embedded[CONVEX_POINTS_EMBEDDED];
+};
+
+static cairo_status_t
+_convex_path_line_to (void                *closure,
+                      const cairo_point_t *point)
+{
+	struct convex_path *cp = closure;
+
+	if (cp->num_points > 0 &&
+	    cp->points[cp->num_points - 1].x == point->x &&
+	    cp->points[cp->num_points - 1].y == point->y)
+		return CAIRO_STATUS_SUCCESS;
+
+	if (cp->num_points == cp->size) {
+		cairo_point_t *new_points;
+		int            new_size;
+
+		if (cp->size == MAX_CONVEX_POINTS)
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+
+		new_size = MIN(cp->size * 2, MAX_CONVEX_POINTS);
+
+		if (cp->points == cp->points_embedded) {
+			new_points = _cairo_malloc_ab(new_size, sizeof(cairo_point_t));
+			if (new_points != NULL)
+				memcpy(new_points, cp->points, cp->num_points * sizeof(cairo_point_t));
+		} else {
+			new_points = _cairo_realloc_ab(cp->points, new_size, sizeof(cairo_point_t));
+		}
+
+		if (unlikely (new_points == NULL))
+			return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+
+		cp->points = new_points;
+		cp->size   = new_size;
+	}
+
+	cp->points[cp->num_points++] = *point;
+
+	return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_convex_path_move_to (void                *closure,
+                      const cairo_point_t *point)
+{
+	struct convex_path *cp = closure;
+
+	/* More than one subpath is never convex */
+	if (++cp->num_subpaths > 1)
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	return _convex_path_line_to(closure, point);
+}
+
+static cairo_status_t
+_convex_path_close_path (void *closure)
+{
+	return CAIRO_STATUS_SUCCESS;
+}
+
+/* Returns +1 or -1 depending on the winding direction of the polygon, or 0
+ * if it is not convex. A convex polygon turns the same way at every vertex
+ * and its edges change direction along each axis exactly twice.
+ */
+static int
+_convex_path_orientation (const cairo_point_t *points,
+                          int                  num_points)
+{
+	double dx0, dy0, dx1, dy1, cross;
+	int    sign = 0, x_flips = 0, y_flips = 0;
+	int    last_x = 0, last_y = 0;
+	int    i;
+
+	if (num_points < 3)
+		return 0;
+
+	dx0 = points[0].x - points[num_points - 1].x;
+	dy0 = points[0].y - points[num_points - 1].y;
+
+	for (i = 0; i < num_points; i++) {
+		const cairo_point_t *p0 = &points[i];
+		const cairo_point_t *p1 = &points[(i + 1) % num_points];
+
+		dx1 = p1->x - p0->x;
+		dy1 = p1->y - p0->y;
+
+		cross = dx0 * dy1 - dy0 * dx1;
+		if (cross != 0) {
+			if (sign == 0)
+				sign = cross > 0 ? 1 : -1;
+			else if ((cross > 0) != (sign > 0))
+				return 0;
+		}
+
+		if (dx1 != 0) {
+			if (last_x != 0 && (dx1 > 0) != (last_x > 0))
+				x_flips++;
+			last_x = dx1 > 0 ? 1 : -1;
+		}
+		if (dy1 != 0) {
+			if (last_y != 0 && (dy1 > 0) != (last_y > 0))
+				y_flips++;
+			last_y = dy1 > 0 ? 1 : -1;
+		}
+
+		dx0 = dx1;
+		dy0 = dy1;
+	}
+
+	/* The flip between the last and the first edge is not counted, so a
+	 * convex polygon has at most two along each axis.
+	 */
+	if (x_flips > 2 || y_flips > 2)
+		return 0;
+
+	return sign;
+}
+
+static cairo_int_status_t
+composite_convex_path (cairo_composite_rectangles_t *extents,
+                       const cairo_path_fixed_t     *path,
+                       double                        tolerance,
+                       cairo_antialias_t             antialias)
+{
+	cairo_int_status_t       status;
+	struct convex_path       cp;
+	cairo_amigaos_surface_t *dst;
+	cairo_amigaos_device_t  *device;
+	struct composite_op      op;
+	struct composite_source  src;
+	my_mask_vertex_t        *vertices;
+	uint16                  *indices, *idx;
+	int                      sign, n, i, prev, next;
+	cairo_bool_t             committed = FALSE;
+	float                    half_width;
+	float                    x1, y1, x2, y2;
+	cairo_rectangle_int_t    rect;
+
+	cp.points       = cp.points_embedded;
+	cp.num_points   = 0;
+	cp.size         = CONVEX_POINTS_EMBEDDED;
+	cp.num_subpaths = 0;
+
+	status = _cairo_path_fixed_interpret_flat(path,
+	                                          _convex_path_move_to,
+	                                          _convex_path_line_to,
+	                                          _convex_path_close_path,
+	                                          &cp,
+	                                          tolerance);
+	if (unlikely (status != CAIRO_INT_STATUS_SUCCESS))
+		goto CLEANUP_POINTS;
+
+	n = cp.num_points;
+	if (n > 1 && cp.points[0].x == cp.points[n - 1].x && cp.points[0].y == cp.points[n - 1].y)
+		n--;
+
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+
+	sign = _convex_path_orientation(cp.points, n);
+	if (sign == 0)
+		goto CLEANUP_POINTS;
+
+	/* Too thin for the inset fringe to stay inside the shape */
+	if (antialias != CAIRO_ANTIALIAS_NONE &&
+	    (_cairo_fixed_integer_part(path->extents.p2.x - path->extents.p1.x) < 2 ||
+	     _cairo_fixed_integer_part(path->extents.p2.y - path->extents.p1.y) < 2))
+		goto CLEANUP_POINTS;
+
+	half_width = antialias != CAIRO_ANTIALIAS_NONE ? 0.5f : 0;
+
+	dst    = (cairo_amigaos_surface_t *)extents->surface;
+	device = (cairo_amigaos_device_t *)dst->base.device;
+
+	status = init_composite_op(&op, dst,
+	                           composite_operator(extents, antialias != CAIRO_ANTIALIAS_NONE),
+	                           antialias != CAIRO_ANTIALIAS_NONE);
+	if (unlikely (status))
+		goto CLEANUP_POINTS;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status))
+		goto CLEANUP_OP;
+
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+
+	vertices = _cairo_malloc_ab(2 * n, sizeof(my_mask_vertex_t));
+	indices  = _cairo_malloc_ab(3 * (3 * n - 2), sizeof(uint16));
+	if (unlikely (vertices == NULL || indices == NULL)) {
+		status = _cairo_error(CAIRO_STATUS_NO_MEMORY);
+		goto CLEANUP_VERTICES;
+	}
+
+	x1 = y1 = HUGE_VALF;
+	x2 = y2 = -HUGE_VALF;
+
+	/* Every vertex is split into an outer (coverage 0) and an inner
+	 * (coverage 1) copy, offset half a pixel along the miter of the two
+	 * inward edge normals.
+	 */
+	for (i = 0; i < n; i++) {
+		float px, py, ax, ay, bx, by, len, dot, mx, my;
+
+		prev = (i + n - 1) % n;
+		next = (i + 1) % n;
+
+		px = _cairo_fixed_to_double(cp.points[i].x);
+		py = _cairo_fixed_to_double(cp.points[i].y);
+
+		ax = _cairo_fixed_to_double(cp.points[i].x - cp.points[prev].x);
+		ay = _cairo_fixed_to_double(cp.points[i].y - cp.points[prev].y);
+		bx = _cairo_fixed_to_double(cp.points[next].x - cp.points[i].x);
+		by = _cairo_fixed_to_double(cp.points[next].y - cp.points[i].y);
+
+		len = sqrtf(ax * ax + ay * ay);
+		ax /= len;
+		ay /= len;
+		len = sqrtf(bx * bx + by * by);
+		bx /= len;
+		by /= len;
+
+		/* Rotate the edge directions into inward normals */
+		if (sign > 0) {
+			float t = ax; ax = -ay; ay = t;
+			t = bx; bx = -by; by = t;
+		} else {
+			float t = ax; ax = ay; ay = -t;
+			t = bx; bx = by; by = -t;
+		}
+
+		dot = ax * bx + ay * by;
+		if (1 + dot < 0.25f) {
+			/* The miter of a very sharp corner reaches too far */
+			goto CLEANUP_VERTICES;
+		}
+
+		mx = (ax + bx) / (1 + dot) * half_width;
+		my = (ay + by) / (1 + dot) * half_width;
+
+		vertices[2 * i + 0] = source_mask_vertex(&src, px - mx, py - my, 0);
+		vertices[2 * i + 1] = source_mask_vertex(&src, px + mx, py + my, 1);
+
+		x1 = MIN(x1, px - fabsf(mx));
+		x2 = MAX(x2, px + fabsf(mx));
+		y1 = MIN(y1, py - fabsf(my));
+		y2 = MAX(y2, py + fabsf(my));
+	}
+
+	idx = indices;
+
+	/* Fringe quads along each edge */
+	for (i = 0; i < n; i++) {
+		next = (i + 1) % n;
+
+		idx[0] = 2 * i;
+		idx[1] = 2 * next;
+		idx[2] = 2 * i + 1;
+		idx[3] = 2 * i + 1;
+		idx[4] = 2 * next;
+		idx[5] = 2 * next + 1;
+		idx += 6;
+	}
+
+	/* Fan over the inner vertices */
+	for (i = 1; i < n - 1; i++) {
+		idx[0] = 1;
+		idx[1] = 2 * i + 1;
+		idx[2] = 2 * (i + 1) + 1;
+		idx += 3;
+	}
+
+	rect.x      = (int)floorf(x1);
+	rect.y      = (int)floorf(y1);
+	rect.width  = (int)ceilf(x2) - rect.x;
+	rect.height = (int)ceilf(y2) - rect.y;
+
+	status = composite_mask_vertices(&op, &src, device->coverage_ramp, dst,
+	                                 extents->clip, &rect,
+	                                 vertices, indices, (idx - indices) / 3,
+	                                 &committed);
+
+CLEANUP_VERTICES:
+	free(vertices);
+	free(indices);
+
+	release_source(&src);
+
+CLEANUP_OP:
+	fini_composite_op(&op);
+
+CLEANUP_POINTS:
+	if (cp.points != cp.points_embedded)
+		free(cp.points);
+
+	return status;
+}
+
+/* Glyphs are packed into an ALPHA8 atlas bitmap attached to the scaled
+ * font, so a run of text is drawn as one batch of quads sampling the
+ * source as usual and the glyph coverage from the atlas. The atlas is
+ * only touched with the glyph cache of its font frozen, which holds the
+ * font mutex.
+ */
+#define GLYPH_ATLAS_SIZE 256
+#define GLYPH_MIN_SIZE   4
+#define GLYPH_MAX_SIZE   64
+#define GLYPH_VERTICES   4
+#define GLYPH_INDICES    6
+#define MAX_BATCH_GLYPHS (MAX_BATCH_VERTICES / GLYPH_VERTICES)
+
+typedef struct _cairo_amigaos_glyph_atlas {
+	cairo_scaled_font_private_t  base;
+
+	struct BitMap               *bitmap;
+	struct RastPort              rastport;
+	cairo_rtree_t                rtree;
+} cairo_amigaos_glyph_atlas_t;
+
+typedef struct _cairo_amigaos_glyph {
+	cairo_rtree_node_t            node;
+	cairo_scaled_glyph_private_t  base;
+	cairo_scaled_glyph_t         *glyph;
+	cairo_amigaos_glyph_atlas_t  *atlas;
+} cairo_amigaos_glyph_t;
+
+/* Called when the atlas evicts a glyph */
+static void
+glyph_node_destroy (cairo_rtree_node_t *node)
+{
+	cairo_amigaos_glyph_t *glyph = cairo_container_of(node, cairo_amigaos_glyph_t, node);
+
+	if (glyph->glyph == NULL)
+		return;
+
+	cairo_list_del(&glyph->base.link);
+	glyph->glyph = NULL;
+}
+
+/* Called when the scaled font drops the glyph */
+static void
+glyph_fini (cairo_scaled_glyph_private_t *glyph_private,
+            cairo_scaled_glyph_t         *scaled_glyph,
+            cairo_scaled_font_t          *scaled_font)
+{
+	cairo_amigaos_glyph_t *glyph = cairo_container_of(glyph_private, cairo_amigaos_glyph_t, base);
+
+	glyph_node_destroy(&glyph->node);
+
+	if (! glyph->node.pinned)
+		_cairo_rtree_node_remove(&glyph->atlas->rtree, &glyph->node);
+}
+
+static void
+glyph_atlas_fini (cairo_scaled_font_private_t *font_private,
+                  cairo_scaled_font_t         *scaled_font)
+{
+	cairo_amigaos_glyph_atlas_t *atlas = cairo_container_of(font_private, cairo_amigaos_glyph_atlas_t, base);
+
+	cairo_list_del(&atlas->base.link);
+
+	_cairo_rtree_fini(&atlas->rtree);
+	IGraphics->FreeBitMap(atlas->bitmap);
+	free(atlas);
+}
+
+static cairo_int_status_t
+glyph_atlas_get (cairo_amigaos_device_t       *device,
+                 cairo_scaled_font_t          *scaled_font,
+                 cairo_amigaos_glyph_atlas_t **atlas_out)
+{
+	cairo_scaled_font_private_t *font_private;
+	cairo_amigaos_glyph_atlas_t *atlas;
+
+	font_private = _cairo_scaled_font_find_private(scaled_font, device);
+	if (font_private != NULL) {
+		*atlas_out = cairo_container_of(font_private, cairo_amigaos_glyph_atlas_t, base);
+		return CAIRO_INT_STATUS_SUCCESS;
+	}
+
+	atlas = malloc(sizeof(cairo_amigaos_glyph_atlas_t));
+	if (unlikely (atlas == NULL))
+		return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+
+	atlas->bitmap = IGraphics->AllocBitMapTags(GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, 8,
+		BMATags_PixelFormat, PIXF_ALPHA8,
+		TAG_END);
+	if (atlas->bitmap == NULL) {
+		free(atlas);
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+
+	IGraphics->InitRastPort(&atlas->rastport);
+	atlas->rastport.BitMap = atlas->bitmap;
+
+	_cairo_rtree_init(&atlas->rtree, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE,
+	                  GLYPH_MIN_SIZE, sizeof(cairo_amigaos_glyph_t),
+	                  glyph_node_destroy);
+
+	_cairo_scaled_font_attach_private(scaled_font, &atlas->base, device,
+	                                  glyph_atlas_fini);
+
+	*atlas_out = atlas;
+
+	return CAIRO_INT_STATUS_SUCCESS;
+}
+
+static cairo_bool_t
+glyph_is_supported (const cairo_image_surface_t *image)
+{
+	/* Component alpha and colour glyphs need more than an alpha mask */
+	if (image->format != CAIRO_FORMAT_A8 && image->format != CAIRO_FORMAT_A1)
+		return FALSE;
+
+	return image->width <= GLYPH_MAX_SIZE && image->height <= GLYPH_MAX_SIZE;
+}
+
+/* Finds the glyph in the atlas or uploads it, and pins it there until the
+ * next _cairo_rtree_unpin(). Returns CAIRO_INT_STATUS_UNSUPPORTED if all
+ * the room is taken by pinned glyphs.
+ */
+static cairo_int_status_t
+glyph_atlas_lookup (cairo_amigaos_glyph_atlas_t  *atlas,
+                    cairo_scaled_glyph_t         *scaled_glyph,
+                    cairo_amigaos_glyph_t       **glyph_out)
+{
+	cairo_scaled_glyph_private_t *glyph_private;
+	cairo_image_surface_t        *image = scaled_glyph->surface;
+	cairo_image_surface_t        *a8;
+	cairo_rtree_node_t           *node = NULL;
+	cairo_amigaos_glyph_t        *glyph;
+	int                           width, height;
+	cairo_int_status_t            status;
+
+	glyph_private = _cairo_scaled_glyph_find_private(scaled_glyph, atlas);
+	if (glyph_private != NULL) {
+		glyph = cairo_container_of(glyph_private, cairo_amigaos_glyph_t, base);
+		*glyph_out = _cairo_rtree_pin(&atlas->rtree, &glyph->node);
+		return CAIRO_INT_STATUS_SUCCESS;
+	}
+
+	width  = MAX(image->width, GLYPH_MIN_SIZE);
+	height = MAX(image->height, GLYPH_MIN_SIZE);
+
+	status = _cairo_rtree_insert(&atlas->rtree, width, height, &node);
+	if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+		status = _cairo_rtree_evict_random(&atlas->rtree, width, height, &node);
+		if (status == CAIRO_INT_STATUS_SUCCESS)
+			status = _cairo_rtree_node_insert(&atlas->rtree, node, width, height, &node);
+	}
+	if (status == CAIRO_INT_STATUS_UNSUPPORTED && cairo_list_is_empty(&atlas->rtree.pinned)) {
+		/* Too fragmented to make room, so start over */
+		_cairo_rtree_reset(&atlas->rtree);
+		status = _cairo_rtree_insert(&atlas->rtree, width, height, &node);
+	}
+	if (unlikely (status))
+		return status;
+
+	glyph = (cairo_amigaos_glyph_t *)node;
+	glyph->glyph = NULL;
+
+	a8 = _cairo_image_surface_coerce_to_format(image, CAIRO_FORMAT_A8);
+	if (unlikely (a8->base.status)) {
+		status = a8->base.status;
+		cairo_surface_destroy(&a8->base);
+		_cairo_rtree_node_remove(&atlas->rtree, node);
+		return status;
+	}
+
+	IGraphics->WritePixelArray(a8->data, 0, 0, a8->stride, PIXF_ALPHA8,
+	                           &atlas->rastport, node->x, node->y,
+	                           image->width, image->height);
+
+	cairo_surface_destroy(&a8->base);
+
+	glyph->glyph = scaled_glyph;
+	glyph->atlas = atlas;
+	_cairo_scaled_glyph_attach_private(scaled_glyph, &glyph->base, atlas, glyph_fini);
+
+	*glyph_out = _cairo_rtree_pin(&atlas->rtree, node);
+
+	return CAIRO_INT_STATUS_SUCCESS;
+}
+
+static cairo_int_status_t
+composite_glyph_batch (const struct composite_op      *op,
+                       const struct composite_source *src,
+                       cairo_amigaos_glyph_atlas_t   *atlas,
+                       cairo_amigaos_surface_t       *dst,
+                       const cairo_clip_t            *clip,
+                       const my_mask_vertex_t        *vertices,
+                       const uint16                  *indices,
+                       int                            num_glyphs,
+                       int                            x1,
+                       int                            y1,
+                       int                            x2,
+                       int                            y2,
+                       cairo_bool_t                  *committed)
+{
+	cairo_rectangle_int_t rect;
+
+	rect.x      = x1;
+	rect.y      = y1;
+	rect.width  = x2 - x1;
+	rect.height = y2 - y1;
+
+	return composite_mask_vertices(op, src, atlas->bitmap, dst, clip, &rect,
+	                               vertices, indices, 2 * num_glyphs,
+	                               committed);
+}
+
+static cairo_int_status_t
+composite_glyphs (cairo_composite_rectangles_t *extents,
+                  cairo_scaled_font_t          *scaled_font,
+                  const cairo_glyph_t          *glyphs,
+                  int                           num_glyphs)
+{
+	const cairo_rectangle_int_t *limit = &extents->bounded;
+	cairo_int_status_t           status;
+	cairo_amigaos_surface_t     *dst;
+	cairo_amigaos_device_t      *device;
+	cairo_amigaos_glyph_atlas_t *atlas;
+	cairo_scaled_glyph_t        *scaled_glyph;
+	cairo_amigaos_glyph_t       *glyph;
+	struct composite_op          op;
+	struct composite_source      src;
+	my_mask_vertex_t            *vertices, *v;
+	uint16                      *indices;
+	int                          x1, y1, x2, y2;
+	int                          batch_size, n, i;
+	cairo_bool_t                 committed = FALSE;
+
+	dst    = (cairo_amigaos_surface_t *)extents->surface;
+	device = (cairo_amigaos_device_t *)dst->base.device;
+
+	/* Nothing may be drawn before falling back, so check every glyph first */
+	for (i = 0; i < num_glyphs; i++) {
+		double        gx = glyphs[i].x;
+		unsigned long index;
+
+		index  = _cairo_scaled_font_glyph_phase_index(scaled_font, glyphs[i].index, &gx);
+		status = _cairo_scaled_glyph_lookup(scaled_font, index,
+		                                    CAIRO_SCALED_GLYPH_INFO_SURFACE,
+		                                    &scaled_glyph);
+		if (unlikely (status))
+			return status;
+
+		if (! glyph_is_supported(scaled_glyph->surface))
+			return CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+
+	status = glyph_atlas_get(device, scaled_font, &atlas);
+	if (unlikely (status))
+		return status;
+
+	batch_size = MIN(num_glyphs, MAX_BATCH_GLYPHS);
+
+	vertices = _cairo_malloc_ab(batch_size, GLYPH_VERTICES * sizeof(my_mask_vertex_t));
+	indices  = _cairo_malloc_ab(batch_size, GLYPH_INDICES * sizeof(uint16));
+	if (unlikely (vertices == NULL || indices == NULL)) {
+		status = _cairo_error(CAIRO_STATUS_NO_MEMORY);
+		goto CLEANUP_VERTICES;
+	}
+
+	status = init_composite_op(&op, dst, composite_operator(extents, TRUE), TRUE);
+	if (unlikely (status))
+		goto CLEANUP_VERTICES;
+
+	status = acquire_source(extents, &src);
+	if (unlikely (status))
+		goto CLEANUP_OP;
+
+	for (i = 0; i < batch_size; i++) {
+		uint16 *idx  = &indices[i * GLYPH_INDICES];
+		uint16  base = i * GLYPH_VERTICES;
+
+		idx[0] = base + 0;
+		idx[1] = base + 1;
+		idx[2] = base + 2;
+		idx[3] = base + 2;
+		idx[4] = base + 1;
+		idx[5] = base + 3;
+	}
+
+	v = vertices;
+	n = 0;
+	x1 = y1 = INT_MAX;
+	x2 = y2 = INT_MIN;
+
+	for (i = 0; i < num_glyphs; i++) {
+		cairo_image_surface_t *image;
+		double                 gx = glyphs[i].x;
+		unsigned long          index;
+		int                    x, y, s, t;
+
+		index  = _cairo_scaled_font_glyph_phase_index(scaled_font, glyphs[i].index, &gx);
+		status = _cairo_scaled_glyph_lookup(scaled_font, index,
+		                                    CAIRO_SCALED_GLYPH_INFO_SURFACE,
+		                                    &scaled_glyph);
+		if (unlikely (status))
+			break;
+
+		image = scaled_glyph->surface;
+		if (image->width == 0 || image->height == 0)
+			continue;
+
+		/* Same rounding as the image compositor */
+		x = _cairo_lround(gx - image->base.device_transform.x0);
+		y = _cairo_lround(glyphs[i].y - image->base.device_transform.y0);
+
+		if (x >= limit->x + limit->width || x + image->width <= limit->x ||
+		    y >= limit->y + limit->height || y + image->height <= limit->y)
+			continue;
+
+		status = glyph_atlas_lookup(atlas, scaled_glyph, &glyph);
+		if (status == CAIRO_INT_STATUS_UNSUPPORTED && n > 0) {
+			/* The atlas is full of glyphs still to be drawn */
+			status = composite_glyph_batch(&op, &src, atlas, dst, extents->clip,
+			                               vertices, indices, n, x1, y1, x2, y2,
+			                               &committed);
+
+			v = vertices;
+			n = 0;
+			x1 = y1 = INT_MAX;
+			x2 = y2 = INT_MIN;
+
+			_cairo_rtree_unpin(&atlas->rtree);
+
+			if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+				status = glyph_atlas_lookup(atlas, scaled_glyph, &glyph);
+		}
+		if (unlikely (status))
+			break;
+
+		s = glyph->node.x;
+		t = glyph->node.y;
+
+		v[0] = source_glyph_vertex(&src, x,                y,                 s,                t);
+		v[1] = source_glyph_vertex(&src, x + image->width, y,                 s + image->width, t);
+		v[2] = source_glyph_vertex(&src, x,                y + image->height, s,                t + image->height);
+		v[3] = source_glyph_vertex(&src, x + image->width, y + image->height, s + image->width, t + image->height);
+		v += GLYPH_VERTICES;
+
+		x1 = MIN(x1, x);
+		y1 = MIN(y1, y);
+		x2 = MAX(x2, x + image->width);
+		y2 = MAX(y2, y + image->height);
+
+		if (++n == batch_size) {
+			status = composite_glyph_batch(&op, &src, atlas, dst, extents->clip,
+			                               vertices, indices, n, x1, y1, x2, y2,
+			                               &committed);
+			if (unlikely (status))
+				break;
+
+			v = vertices;
+			n = 0;
+			x1 = y1 = INT_MAX;
+			x2 = y2 = INT_MIN;
+
+			_cairo_rtree_unpin(&atlas->rtree);
+		}
+	}
+
+	if (n > 0 && status == CAIRO_INT_STATUS_SUCCESS) {
+		status = composite_glyph_batch(&op, &src, atlas, dst, extents->clip,
+		                               vertices, indices, n, x1, y1, x2, y2,
+		                               &committed);
+	}
+
+	_cairo_rtree_unpin(&atlas->rtree);
+
+	/* Batches already drawn must not be drawn again by the fallback */
+	if (status == CAIRO_INT_STATUS_UNSUPPORTED && committed)
+		status = _cairo_error(CAIRO_STATUS_DEVICE_ERROR);
+
+	release_source(&src);
+
+CLEANUP_OP:
+	fini_composite_op(&op);
+
+CLEANUP_VERTICES:
+	free(vertices);
+	free(indices);
+
+	return status;
+}
+
+static cairo_int_status_t
+_cairo_amigaos_compositor_paint (const cairo_compositor_t     *_compositor,
+                                 cairo_composite_rectangles_t *extents)
+{
+	cairo_int_status_t status;
+	cairo_boxes_t      boxes;
+
+	_cairo_clip_steal_boxes(extents->clip, &boxes);
 	status = composite_boxes (extents, &boxes);
 	_cairo_clip_unsteal_boxes(extents->clip, &boxes);
 
@@ -542,6 +2609,10 @@ _cairo_amigaos_compositor_stroke (const cairo_compositor_t     *_compositor,
 {
 	cairo_int_status_t status = CAIRO_INT_STATUS_UNSUPPORTED;
 
+	/* Only the shape itself is drawn, nothing clears the rest of the clip */
+	if (! _cairo_operator_bounded_by_mask(extents->op))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
 	if (_cairo_path_fixed_fill_is_rectilinear(path)) {
 		cairo_boxes_t boxes;
 
@@ -582,7 +2653,7 @@ _cairo_amigaos_compositor_stroke (const cairo_compositor_t     *_compositor,
 		                                                   tolerance,
 		                                                   &traps);
 		if (likely (status == CAIRO_INT_STATUS_SUCCESS))
-			status = composite_traps(extents, &traps);
+			status = composite_traps(extents, &traps, antialias);
 		_cairo_traps_fini (&traps);
 	}
 
@@ -599,6 +2670,10 @@ _cairo_amigaos_compositor_fill (const cairo_compositor_t     *_compositor,
 {
 	cairo_int_status_t status = CAIRO_INT_STATUS_UNSUPPORTED;
 
+	/* Only the shape itself is drawn, nothing clears the rest of the clip */
+	if (! _cairo_operator_bounded_by_mask(extents->op))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
 	if (_cairo_path_fixed_fill_is_rectilinear(path)) {
 		cairo_boxes_t boxes;
 
@@ -612,6 +2687,26 @@ _cairo_amigaos_compositor_fill (const cairo_compositor_t     *_compositor,
 		_cairo_boxes_fini(&boxes);
 	}
 
+	if (status == CAIRO_INT_STATUS_UNSUPPORTED && can_composite_with_coverage(extents, antialias)) {
+		status = composite_convex_path(extents, path, tolerance, antialias);
+
+		if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+			cairo_polygon_t polygon;
+			cairo_traps_t   traps;
+
+			_cairo_polygon_init_with_clip(&polygon, extents->clip);
+			status = _cairo_path_fixed_fill_to_polygon(path, tolerance, &polygon);
+			if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+				_cairo_traps_init(&traps);
+				status = _cairo_bentley_ottmann_tessellate_polygon(&traps, &polygon, fill_rule);
+				if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+					status = composite_traps(extents, &traps, antialias);
+				_cairo_traps_fini(&traps);
+			}
+			_cairo_polygon_fini(&polygon);
+		}
+	}
+
 	return status;
 }
 
@@ -623,16 +2718,266 @@ _cairo_amigaos_compositor_glyphs (const cairo_compositor_t     *_compositor,
                                   int                           num_glyphs,
                                   cairo_bool_t                  overlap)
 {
-	return CAIRO_INT_STATUS_UNSUPPORTED;
+	cairo_int_status_t status;
+
+	if (! _cairo_operator_bounded_by_mask(extents->op))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	/* The glyphs are composited one after the other rather than combined
+	 * into a single mask first, which only adds up the same where they
+	 * overlap for ADD.
+	 */
+	if (overlap && extents->op != CAIRO_OPERATOR_ADD)
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	if (! operator_is_supported(composite_operator(extents, TRUE), TRUE) ||
+	    ! _cairo_clip_is_region(extents->clip) ||
+	    ! source_is_supported(&extents->source_pattern.base))
+		return CAIRO_INT_STATUS_UNSUPPORTED;
+
+	_cairo_scaled_font_freeze_cache(scaled_font);
+	status = composite_glyphs(extents, scaled_font, glyphs, num_glyphs);
+	_cairo_scaled_font_thaw_cache(scaled_font);
+
+	return status;
+}
+
+/* Operations the compositor can not handle are rendered with the image
+ * backend into a mapped copy of the destination. Unlike the generic
+ * fallback compositor this maps only the pixels the operation may touch,
+ * skips reading them in when the operation overwrites them anyway and
+ * attaches the boxes that may change as damage, so that unmapping writes
+ * back just those.
+ */
+static cairo_damage_t *
+fallback_damage (const cairo_composite_rectangles_t *extents,
+                 const cairo_rectangle_int_t        *map_rect)
+{
+	const cairo_clip_t    *clip = extents->clip;
+	cairo_damage_t        *damage;
+	cairo_rectangle_int_t  rect;
+	int                    i;
+
+	damage = _cairo_damage_create();
+
+	if (clip == NULL || clip->num_boxes == 0) {
+		rect = *map_rect;
+		if (clip != NULL && ! _cairo_rectangle_intersect(&rect, &clip->extents))
+			return damage;
+
+		rect.x -= map_rect->x;
+		rect.y -= map_rect->y;
+		return _cairo_damage_add_rectangle(damage, &rect);
+	}
+
+	for (i = 0; i < clip->num_boxes; i++) {
+		_cairo_box_round_to_rectangle(&clip->boxes[i], &rect);
+		if (! _cairo_rectangle_intersect(&rect, map_rect))
+			continue;
+
+		rect.x -= map_rect->x;
+		rect.y -= map_rect->y;
+		damage = _cairo_damage_add_rectangle(damage, &rect);
+	}
+
+	return damage;
+}
+
+/* Whether a paint leaves nothing of the destination inside the clip */
+static cairo_bool_t
+paint_overwrites_destination (const cairo_composite_rectangles_t *extents)
+{
+	if (! _cairo_clip_is_region(extents->clip))
+		return FALSE;
+
+	switch (extents->op) {
+		case CAIRO_OPERATOR_CLEAR:
+		case CAIRO_OPERATOR_SOURCE:
+			return TRUE;
+
+		case CAIRO_OPERATOR_OVER:
+			return _cairo_pattern_is_opaque(&extents->source_pattern.base, &extents->source_sample_area);
+
+		default:
+			return FALSE;
+	}
+}
+
+static cairo_image_surface_t *
+fallback_map (const cairo_composite_rectangles_t *extents,
+              cairo_bool_t                        readback,
+              cairo_rectangle_int_t              *map_rect)
+{
+	cairo_amigaos_surface_t *dst = (cairo_amigaos_surface_t *)extents->surface;
+	cairo_image_surface_t   *image;
+	cairo_damage_t          *damage;
+
+	/* Unbounded operators also clear everything outside the mask */
+	*map_rect = extents->is_bounded ? extents->bounded : extents->unbounded;
+
+	damage = fallback_damage(extents, map_rect);
+	if (unlikely (damage->status)) {
+		_cairo_damage_destroy(damage);
+		damage   = NULL;
+		readback = TRUE;
+	}
+
+	image = _cairo_amigaos_surface_map(dst, map_rect, readback);
+	if (unlikely (image == NULL || image->base.status)) {
+		_cairo_damage_destroy(damage);
+		return image != NULL ? image : _cairo_image_surface_clone_subimage(&dst->base, map_rect);
+	}
+
+	image->base.damage = damage;
+
+	return image;
+}
+
+static cairo_int_status_t
+fallback_unmap (const cairo_composite_rectangles_t *extents,
+                cairo_image_surface_t              *image,
+                cairo_int_status_t                  status)
+{
+	cairo_int_status_t unmap_status;
+
+	/* Keep a failed operation from writing back a half rendered image */
+	if (unlikely (status) && image->base.damage != NULL) {
+		_cairo_damage_destroy(image->base.damage);
+		image->base.damage = _cairo_damage_create();
+	}
+
+	unmap_status = _cairo_surface_unmap_image(extents->surface, image);
+
+	return unlikely (status) ? status : unmap_status;
+}
+
+static cairo_int_status_t
+_cairo_amigaos_fallback_paint (const cairo_compositor_t     *_compositor,
+                               cairo_composite_rectangles_t *extents)
+{
+	cairo_image_surface_t *image;
+	cairo_rectangle_int_t  rect;
+	cairo_int_status_t     status;
+
+	image = fallback_map(extents, ! paint_overwrites_destination(extents), &rect);
+
+	status = _cairo_surface_offset_paint(&image->base, rect.x, rect.y,
+	                                     extents->op,
+	                                     &extents->source_pattern.base,
+	                                     extents->clip);
+
+	return fallback_unmap(extents, image, status);
+}
+
+static cairo_int_status_t
+_cairo_amigaos_fallback_mask (const cairo_compositor_t     *_compositor,
+                              cairo_composite_rectangles_t *extents)
+{
+	cairo_image_surface_t *image;
+	cairo_rectangle_int_t  rect;
+	cairo_int_status_t     status;
+
+	image = fallback_map(extents, TRUE, &rect);
+
+	status = _cairo_surface_offset_mask(&image->base, rect.x, rect.y,
+	                                    extents->op,
+	                                    &extents->source_pattern.base,
+	                                    &extents->mask_pattern.base,
+	                                    extents->clip);
+
+	return fallback_unmap(extents, image, status);
+}
+
+static cairo_int_status_t
+_cairo_amigaos_fallback_stroke (const cairo_compositor_t     *_compositor,
+                                cairo_composite_rectangles_t *extents,
+                                const cairo_path_fixed_t     *path,
+                                const cairo_stroke_style_t   *style,
+                                const cairo_matrix_t         *ctm,
+                                const cairo_matrix_t         *ctm_inverse,
+                                double                        tolerance,
+                                cairo_antialias_t             antialias)
+{
+	cairo_image_surface_t *image;
+	cairo_rectangle_int_t  rect;
+	cairo_int_status_t     status;
+
+	image = fallback_map(extents, TRUE, &rect);
+
+	status = _cairo_surface_offset_stroke(&image->base, rect.x, rect.y,
+	                                      extents->op,
+	                                      &extents->source_pattern.base,
+	                                      path, style,
+	                                      ctm, ctm_inverse,
+	                                      tolerance, antialias,
+	                                      extents->clip);
+
+	return fallback_unmap(extents, image, status);
+}
+
+static cairo_int_status_t
+_cairo_amigaos_fallback_fill (const cairo_compositor_t     *_compositor,
+                              cairo_composite_rectangles_t *extents,
+                              const cairo_path_fixed_t     *path,
+                              cairo_fill_rule_t             fill_rule,
+                              double                        tolerance,
+                              cairo_antialias_t             antialias)
+{
+	cairo_image_surface_t *image;
+	cairo_rectangle_int_t  rect;
+	cairo_int_status_t     status;
+
+	image = fallback_map(extents, TRUE, &rect);
+
+	status = _cairo_surface_offset_fill(&image->base, rect.x, rect.y,
+	                                    extents->op,
+	                                    &extents->source_pattern.base,
+	                                    path, fill_rule,
+	                                    tolerance, antialias,
+	                                    extents->clip);
+
+	return fallback_unmap(extents, image, status);
+}
+
+static cairo_int_status_t
+_cairo_amigaos_fallback_glyphs (const cairo_compositor_t     *_compositor,
+                                cairo_composite_rectangles_t *extents,
+                                cairo_scaled_font_t          *scaled_font,
+                                cairo_glyph_t                *glyphs,
+                                int                           num_glyphs,
+                                cairo_bool_t                  overlap)
+{
+	cairo_image_surface_t *image;
+	cairo_rectangle_int_t  rect;
+	cairo_int_status_t     status;
+
+	image = fallback_map(extents, TRUE, &rect);
+
+	status = _cairo_surface_offset_glyphs(&image->base, rect.x, rect.y,
+	                                      extents->op,
+	                                      &extents->source_pattern.base,
+	                                      scaled_font, glyphs, num_glyphs,
+	                                      extents->clip);
+
+	return fallback_unmap(extents, image, status);
 }
 
 const cairo_compositor_t *
 _cairo_amigaos_compositor_get (void)
 {
 	static cairo_compositor_t compositor;
+	static cairo_compositor_t fallback;
 
 	if (compositor.delegate == NULL) {
-		compositor.delegate = &_cairo_fallback_compositor;
+		fallback.delegate = &__cairo_no_compositor;
+
+		fallback.paint  = _cairo_amigaos_fallback_paint;
+		fallback.mask   = _cairo_amigaos_fallback_mask;
+		fallback.stroke = _cairo_amigaos_fallback_stroke;
+		fallback.fill   = _cairo_amigaos_fallback_fill;
+		fallback.glyphs = _cairo_amigaos_fallback_glyphs;
+
+		compositor.delegate = &fallback;
 
 		compositor.paint    = _cairo_amigaos_compositor_paint;
 		compositor.mask     = _cairo_amigaos_compositor_mask;
@@ -28,6 +28,9 @@
 #include "cairoint.h"
 
 #include "cairo-amigaos-private.h"
+#include "cairo-list-inline.h"
+
+#include <proto/graphics.h>
 
 static cairo_device_t *__cairo_amigaos_device;
 
@@ -37,9 +40,155 @@ _cairo_amigaos_device_flush (void *abstract_device)
 	return CAIRO_STATUS_SUCCESS;
 }
 
+void
+_cairo_amigaos_device_reset_solid_cache (cairo_amigaos_device_t *device)
+{
+	while (device->num_solids > 0)
+		cairo_surface_destroy(&device->solid_cache[--device->num_solids].surface->base);
+}
+
+/* Every scratch buffer starts with this header, padded so that the pixel
+ * data after it stays 16 byte aligned.
+ */
+typedef struct _cairo_amigaos_scratch {
+	cairo_list_t bucket_link;
+	cairo_list_t lru_link;
+	size_t       size;
+} cairo_amigaos_scratch_t;
+
+#define SCRATCH_HEADER_SIZE ((sizeof(cairo_amigaos_scratch_t) + 15) & ~15)
+
+static int
+_scratch_bucket (size_t size)
+{
+	int bucket = 0;
+
+	while (size > 1 && bucket < SCRATCH_BUCKETS - 1) {
+		size >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static void
+_scratch_free (cairo_amigaos_device_t  *device,
+               cairo_amigaos_scratch_t *scratch)
+{
+	cairo_list_del(&scratch->bucket_link);
+	cairo_list_del(&scratch->lru_link);
+	device->scratch_size -= scratch->size;
+	free(scratch);
+}
+
+/* Frees the least recently used idle buffers until at most limit bytes
+ * are left.
+ */
+static void
+_scratch_trim (cairo_amigaos_device_t *device,
+               size_t                  limit)
+{
+	while (device->scratch_size > limit) {
+		_scratch_free(device, cairo_list_last_entry(&device->scratch_lru,
+		                                            cairo_amigaos_scratch_t,
+		                                            lru_link));
+	}
+}
+
+/* Returns a buffer of at least size bytes, preferably one that has been
+ * used before. Repeated mappings of the same area ask for the same size
+ * over and over, so an exact fit is usually waiting in the bucket.
+ */
+void *
+_cairo_amigaos_device_get_scratch (cairo_amigaos_device_t *device,
+                                   size_t                  size)
+{
+	cairo_amigaos_scratch_t *scratch = NULL, *iter;
+	int                      bucket;
+
+	if (likely (cairo_device_acquire(&device->base) == CAIRO_STATUS_SUCCESS)) {
+		bucket = _scratch_bucket(size);
+
+		cairo_list_foreach_entry(iter, cairo_amigaos_scratch_t,
+		                         &device->scratch_buckets[bucket], bucket_link)
+		{
+			if (iter->size >= size) {
+				scratch = iter;
+				break;
+			}
+		}
+
+		/* Anything in the next bucket up is large enough */
+		if (scratch == NULL && bucket + 1 < SCRATCH_BUCKETS &&
+		    ! cairo_list_is_empty(&device->scratch_buckets[bucket + 1]))
+		{
+			scratch = cairo_list_first_entry(&device->scratch_buckets[bucket + 1],
+			                                 cairo_amigaos_scratch_t,
+			                                 bucket_link);
+		}
+
+		if (scratch != NULL) {
+			cairo_list_del(&scratch->bucket_link);
+			cairo_list_del(&scratch->lru_link);
+			device->scratch_size -= scratch->size;
+		}
+
+		cairo_device_release(&device->base);
+	}
+
+	if (scratch == NULL) {
+		scratch = malloc(SCRATCH_HEADER_SIZE + size);
+		if (unlikely (scratch == NULL))
+			return NULL;
+
+		scratch->size = size;
+	}
+
+	return (uint8_t *)scratch + SCRATCH_HEADER_SIZE;
+}
+
+/* Returns a buffer from _cairo_amigaos_device_get_scratch() to the pool */
+void
+_cairo_amigaos_device_put_scratch (cairo_amigaos_device_t *device,
+                                   void                   *data)
+{
+	cairo_amigaos_scratch_t *scratch;
+
+	scratch = (cairo_amigaos_scratch_t *)((uint8_t *)data - SCRATCH_HEADER_SIZE);
+
+	if (scratch->size > device->scratch_high_water ||
+	    unlikely (cairo_device_acquire(&device->base) != CAIRO_STATUS_SUCCESS))
+	{
+		free(scratch);
+		return;
+	}
+
+	cairo_list_add(&scratch->bucket_link, &device->scratch_buckets[_scratch_bucket(scratch->size)]);
+	cairo_list_add(&scratch->lru_link, &device->scratch_lru);
+	device->scratch_size += scratch->size;
+
+	_scratch_trim(device, device->scratch_high_water);
+
+	cairo_device_release(&device->base);
+}
+
 static void
 _cairo_amigaos_device_finish (void *abstract_device)
 {
+	cairo_amigaos_device_t *device = abstract_device;
+
+	if (cairo_device_acquire(&device->base) == CAIRO_STATUS_SUCCESS) {
+		_cairo_amigaos_device_reset_solid_cache(device);
+
+		if (device->has_gradient_cache) {
+			_cairo_cache_fini(&device->gradients);
+			device->has_gradient_cache = FALSE;
+		}
+
+		_scratch_trim(device, 0);
+
+		cairo_device_release(&device->base);
+	}
 }
 
 static void
@@ -47,6 +196,16 @@ _cairo_amigaos_device_destroy (void *abstract_device)
 {
 	cairo_amigaos_device_t *device = abstract_device;
 
+	_cairo_amigaos_device_reset_solid_cache(device);
+
+	if (device->has_gradient_cache)
+		_cairo_cache_fini(&device->gradients);
+
+	_scratch_trim(device, 0);
+
+	if (device->coverage_ramp != NULL)
+		IGraphics->FreeBitMap(device->coverage_ramp);
+
 	free(device);
 }
 
@@ -59,10 +218,42 @@ static const cairo_device_backend_t _cairo_amigaos_device_backend = {
 	.destroy = _cairo_amigaos_device_destroy
 };
 
+/* Creates a 1 pixel high ALPHA8 bitmap where texel i has alpha i. Mapping
+ * the second set of texture coordinates into it lets a single composite
+ * call render antialiased edges with per-vertex coverage.
+ */
+static struct BitMap *
+_create_coverage_ramp (void)
+{
+	struct BitMap   *bitmap;
+	struct RastPort  rastport;
+	uint8            ramp[COVERAGE_RAMP_SIZE];
+	int              i;
+
+	bitmap = IGraphics->AllocBitMapTags(COVERAGE_RAMP_SIZE, 1, 8,
+		BMATags_PixelFormat, PIXF_ALPHA8,
+		TAG_END);
+	if (bitmap == NULL)
+		return NULL;
+
+	for (i = 0; i < COVERAGE_RAMP_SIZE; i++)
+		ramp[i] = i * 255 / (COVERAGE_RAMP_SIZE - 1);
+
+	IGraphics->InitRastPort(&rastport);
+	rastport.BitMap = bitmap;
+
+	IGraphics->WritePixelArray(ramp, 0, 0, COVERAGE_RAMP_SIZE, PIXF_ALPHA8,
+	                           &rastport, 0, 0, COVERAGE_RAMP_SIZE, 1);
+
+	return bitmap;
+}
+
 cairo_device_t *
 _cairo_amigaos_device_get (void)
 {
 	cairo_amigaos_device_t *device;
+	const char             *env;
+	int                     i;
 
 	if (__cairo_amigaos_device != NULL)
 		return cairo_device_reference(__cairo_amigaos_device);
@@ -73,6 +264,25 @@ _cairo_amigaos_device_get (void)
 
 	device->compositor = _cairo_amigaos_compositor_get();
 
+	device->coverage_ramp = _create_coverage_ramp();
+
+	/* CAIRO_AMIGAOS_BATCH_BOXES=0 submits the boxes of an operation one
+	 * at a time instead of in one batch, for benchmarking and debugging.
+	 */
+	env = getenv("CAIRO_AMIGAOS_BATCH_BOXES");
+	device->batch_boxes = env == NULL || strcmp(env, "0") != 0;
+
+	device->num_solids = 0;
+
+	for (i = 0; i < SCRATCH_BUCKETS; i++)
+		cairo_list_init(&device->scratch_buckets[i]);
+	cairo_list_init(&device->scratch_lru);
+	device->scratch_size       = 0;
+	device->scratch_high_water = SCRATCH_HIGH_WATER;
+
+	/* Without the cache gradients are simply rendered for every use */
+	device->has_gradient_cache = _cairo_amigaos_gradient_cache_init(&device->gradients) == CAIRO_STATUS_SUCCESS;
+
 	if (_cairo_atomic_ptr_cmpxchg((void **)&__cairo_amigaos_device, NULL, device))
 		return cairo_device_reference(&device->base);
 
@@ -80,3 +290,30 @@ _cairo_amigaos_device_get (void)
 	return cairo_device_reference(__cairo_amigaos_device);
 }
 
+/* Sets how many bytes of idle scratch buffers, used when mapping bitmaps
+ * that can not be locked, the device keeps around for reuse. Anything
+ * above the limit is freed, least recently used first. A limit of 0
+ * disables the pool.
+ */
+void
+cairo_amigaos_device_set_scratch_high_water (cairo_device_t *abstract_device,
+                                             unsigned long   bytes)
+{
+	cairo_amigaos_device_t *device = (cairo_amigaos_device_t *)abstract_device;
+
+	if (abstract_device == NULL || abstract_device->status)
+		return;
+
+	if (abstract_device->backend->type != CAIRO_DEVICE_TYPE_AMIGAOS) {
+		_cairo_device_set_error(abstract_device, CAIRO_STATUS_DEVICE_TYPE_MISMATCH);
+		return;
+	}
+
+	if (cairo_device_acquire(abstract_device) != CAIRO_STATUS_SUCCESS)
+		return;
+
+	device->scratch_high_water = bytes;
+	_scratch_trim(device, bytes);
+
+	cairo_device_release(abstract_device);
+}
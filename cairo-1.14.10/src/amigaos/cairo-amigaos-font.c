@@ -38,24 +38,219 @@
 #define FLOAT_TO_FIXED(x) ((int32)((x) * 0x00010000L))
 #define FIXED_TO_FLOAT(x) ((float)(x) / 0x00010000L)
 
-typedef struct _cairo_amigaos_scaled_font {
-	cairo_scaled_font_t  base;
+/* Glyph codes below this have their metrics in a direct-mapped table */
+#define GLYPH_METRICS_ASCII 128
+
+/* Number of other glyph codes whose metrics are kept per scaled font */
+#define GLYPH_METRICS_CACHE_SIZE 1024
+
+/* Number of slots in the direct-mapped kerning pair cache */
+#define KERN_CACHE_SIZE 256
+
+/* Number of sizes whose extents are remembered per font face */
+#define FONT_EXTENTS_CACHE_SIZE 32
+
+/* Number of outline engines a font face keeps open for its scaled fonts */
+#define ENGINE_POOL_SIZE 4
+
+/*
+ * Glyph paths are traced from a mono glyph map rendered at least this
+ * many pixels high, but at no more than the given multiple of the size
+ * of the font itself.
+ */
+#define GLYPH_PATH_SIZE          256
+#define GLYPH_PATH_MAX_OVERSAMPLE 4
+
+/* Subpixel glyphs are rendered this many times wider and then filtered */
+#define LCD_SET_FACTOR FLOAT_TO_FIXED(3)
+
+typedef enum _cairo_amigaos_glyph_mode {
+	GLYPH_MODE_MONO,
+	GLYPH_MODE_GRAY,
+	GLYPH_MODE_LCD_RGB,
+	GLYPH_MODE_LCD_BGR
+} cairo_amigaos_glyph_mode_t;
+
+/*
+ * The glyph map is the only place the engine reports the black box and
+ * origin, and getting one renders the glyph, so the parts of it that
+ * layout and metrics need are kept here instead.
+ */
+typedef struct _cairo_amigaos_glyph_metrics {
+	cairo_cache_entry_t  base;
+
+	BOOL                 valid:1;
+	BOOL                 missing:1;
+
+	int16                x0, y0;
+	uint16               black_width, black_height;
+	FIXED                width;
+	FIXED                yorigin;
+} cairo_amigaos_glyph_metrics_t;
+
+typedef struct _cairo_amigaos_kern_pair {
+	uint32_t  code, code2;
+	int32_t   kern;
+} cairo_amigaos_kern_pair_t;
+
+
+/* What a scaled font of a given point height learns from its ASCII glyphs */
+typedef struct _cairo_amigaos_font_extents {
+	cairo_cache_entry_t            base;
 
+	int32                          point_height;
+	cairo_amigaos_glyph_mode_t     mode;
+
+	cairo_font_extents_t           extents;
+	cairo_amigaos_glyph_metrics_t  ascii_metrics[GLYPH_METRICS_ASCII];
+} cairo_amigaos_font_extents_t;
+
+/*
+ * An opened outline font. The scaled fonts of a face share these, and
+ * whichever font holds the lock switches the engine to its own size.
+ */
+typedef struct _cairo_amigaos_engine {
 	struct OutlineFont  *outline_font;
 
-	BOOL                 antialias:1;
+	cairo_mutex_t        mutex;
+	int32                point_height;
+	FIXED                set_factor;
 	BOOL                 ucs2_only:1;
 
-	double               xscale, yscale;
-	double               xspace;
-} cairo_amigaos_scaled_font_t;
+	int                  users;
+} cairo_amigaos_engine_t;
 
 typedef struct _cairo_amigaos_font_face {
-	cairo_font_face_t  base;
+	cairo_font_face_t       base;
+
+	char                   *filename;
 
-	char              *filename;
+	/* Protects the extents cache and the engine pool */
+	cairo_mutex_t           mutex;
+	cairo_cache_t           extents;
+	BOOL                    has_extents_cache:1;
+
+	cairo_amigaos_engine_t  engines[ENGINE_POOL_SIZE];
+	int                     num_engines;
 } cairo_amigaos_font_face_t;
 
+typedef struct _cairo_amigaos_scaled_font {
+	cairo_scaled_font_t            base;
+
+	/* Our own reference, as the base drops its face before fini */
+	cairo_amigaos_font_face_t     *face;
+	cairo_amigaos_engine_t        *engine;
+	int32                          point_height;
+
+	cairo_amigaos_glyph_mode_t     mode;
+	BOOL                           hint_metrics:1;
+	BOOL                           ucs2_only:1;
+
+	double                         xscale, yscale;
+	double                         xspace;
+
+	/* Protected by the scaled font mutex */
+	cairo_amigaos_glyph_metrics_t  ascii_metrics[GLYPH_METRICS_ASCII];
+	cairo_cache_t                  metrics;
+	cairo_amigaos_kern_pair_t      kern_pairs[KERN_CACHE_SIZE];
+} cairo_amigaos_scaled_font_t;
+
+static void
+_engine_init (cairo_amigaos_engine_t *engine,
+              struct OutlineFont     *outline_font)
+{
+	struct EGlyphEngine *ge = &outline_font->olf_EEngine;
+
+	engine->outline_font = outline_font;
+	engine->point_height = 0;
+	engine->set_factor   = FLOAT_TO_FIXED(1);
+	engine->users        = 0;
+
+	CAIRO_MUTEX_INIT(engine->mutex);
+
+	IDiskfont->ESetInfo(ge,
+	                    OT_DeviceDPI, 72 | (72 << 16),
+	                    TAG_END);
+
+	if (IDiskfont->ESetInfo(ge,
+	                        OT_GlyphCode_32, 'A',
+	                        TAG_END) != OTERR_UnknownTag)
+	{
+		debugf("Full UCS-4 support\n");
+		engine->ucs2_only = FALSE;
+	} else {
+		debugf("Only UCS-2 supported\n");
+		engine->ucs2_only = TRUE;
+	}
+}
+
+/*
+ * Picks the least used engine of the face, opening another one while
+ * the pool has room and every open engine already has users.
+ */
+static cairo_amigaos_engine_t *
+_engine_get (cairo_amigaos_font_face_t *face)
+{
+	cairo_amigaos_engine_t *engine = NULL;
+	struct OutlineFont     *outline_font;
+	int                     i;
+
+	CAIRO_MUTEX_LOCK(face->mutex);
+
+	for (i = 0; i < face->num_engines; i++) {
+		if (engine == NULL || face->engines[i].users < engine->users)
+			engine = &face->engines[i];
+	}
+
+	if ((engine == NULL || engine->users > 0) && face->num_engines < ENGINE_POOL_SIZE) {
+		outline_font = IDiskfont->OpenOutlineFont(face->filename, NULL, OFF_OPEN);
+		if (outline_font != NULL) {
+			engine = &face->engines[face->num_engines++];
+			_engine_init(engine, outline_font);
+		}
+	}
+
+	if (engine != NULL)
+		engine->users++;
+
+	CAIRO_MUTEX_UNLOCK(face->mutex);
+
+	return engine;
+}
+
+/* Idle engines stay open for the next scaled font until the face goes */
+static void
+_engine_put (cairo_amigaos_font_face_t *face,
+             cairo_amigaos_engine_t    *engine)
+{
+	CAIRO_MUTEX_LOCK(face->mutex);
+	engine->users--;
+	CAIRO_MUTEX_UNLOCK(face->mutex);
+}
+
+static void
+_engine_lock (cairo_amigaos_scaled_font_t *font)
+{
+	cairo_amigaos_engine_t *engine = font->engine;
+
+	CAIRO_MUTEX_LOCK(engine->mutex);
+
+	if (engine->point_height != font->point_height || engine->set_factor != FLOAT_TO_FIXED(1)) {
+		IDiskfont->ESetInfo(&engine->outline_font->olf_EEngine,
+		                    OT_PointHeight, font->point_height,
+		                    OT_SetFactor,   FLOAT_TO_FIXED(1),
+		                    TAG_END);
+		engine->point_height = font->point_height;
+		engine->set_factor   = FLOAT_TO_FIXED(1);
+	}
+}
+
+static void
+_engine_unlock (cairo_amigaos_scaled_font_t *font)
+{
+	CAIRO_MUTEX_UNLOCK(font->engine->mutex);
+}
+
 static void
 _cairo_amigaos_scaled_font_fini (void *abstract_font)
 {
@@ -63,15 +258,20 @@ _cairo_amigaos_scaled_font_fini (void *abstract_font)
 
 	debugf("_cairo_amigaos_scaled_font_fini(%p)\n", abstract_font);
 
-	IDiskfont->CloseOutlineFont(font->outline_font, NULL);
-	font->outline_font = NULL;
+	_cairo_cache_fini(&font->metrics);
+
+	_engine_put(font->face, font->engine);
+	font->engine = NULL;
+
+	cairo_font_face_destroy(&font->face->base);
+	font->face = NULL;
 }
 
 static struct GlyphMap *
 _get_glyph_map (cairo_amigaos_scaled_font_t *font,
                 uint32_t                     code)
 {
-	struct EGlyphEngine *engine = &font->outline_font->olf_EEngine;
+	struct EGlyphEngine *engine = &font->engine->outline_font->olf_EEngine;
 	struct GlyphMap     *gm;
 
 	debugf("_get_glyph_map(%p, 0x%x)\n", font, code);
@@ -84,7 +284,7 @@ _get_glyph_map (cairo_amigaos_scaled_font_t *font,
 	                    TAG_END);
 
 	IDiskfont->EObtainInfo(engine,
-	                       font->antialias ? OT_GlyphMap8Bit : OT_GlyphMap, &gm,
+	                       font->mode != GLYPH_MODE_MONO ? OT_GlyphMap8Bit : OT_GlyphMap, &gm,
 	                       TAG_END);
 
 	return gm;
@@ -94,7 +294,7 @@ static void
 _release_glyph_map (cairo_amigaos_scaled_font_t *font,
                     struct GlyphMap             *gm)
 {
-	struct EGlyphEngine *engine = &font->outline_font->olf_EEngine;
+	struct EGlyphEngine *engine = &font->engine->outline_font->olf_EEngine;
 
 	debugf("_release_glyph_map(%p, %p)\n", font, gm);
 
@@ -111,12 +311,14 @@ _get_kern (cairo_amigaos_scaled_font_t *font,
            uint32_t                     code,
            uint32_t                     code2)
 {
-	struct EGlyphEngine *engine = &font->outline_font->olf_EEngine;
+	struct EGlyphEngine *engine = &font->engine->outline_font->olf_EEngine;
 	int32_t              kern;
 
 	if (font->ucs2_only && (code > 0xFFFF || code2 > 0xFFFF))
 		return 0;
 
+	_engine_lock(font);
+
 	IDiskfont->ESetInfo(engine,
 	                    OT_GlyphCode,  code,
 	                    OT_GlyphCode2, code2,
@@ -126,24 +328,142 @@ _get_kern (cairo_amigaos_scaled_font_t *font,
 	                       OT_TextKernPair, &kern,
 	                       TAG_END);
 
+	_engine_unlock(font);
+
 	return kern;
 }
 
+static cairo_bool_t
+_glyph_metrics_equal (const void *key_a, const void *key_b)
+{
+	const cairo_amigaos_glyph_metrics_t *a = key_a;
+	const cairo_amigaos_glyph_metrics_t *b = key_b;
+
+	return a->base.hash == b->base.hash;
+}
+
+static void
+_glyph_metrics_from_map (cairo_amigaos_glyph_metrics_t *metrics,
+                         const struct GlyphMap         *gm)
+{
+	metrics->valid = TRUE;
+
+	if (gm == NULL) {
+		metrics->missing = TRUE;
+		return;
+	}
+
+	metrics->missing      = FALSE;
+	metrics->x0           = gm->glm_X0;
+	metrics->y0           = gm->glm_Y0;
+	metrics->black_width  = gm->glm_BlackWidth;
+	metrics->black_height = gm->glm_BlackHeight;
+	metrics->width        = gm->glm_Width;
+	metrics->yorigin      = gm->glm_YOrigin;
+}
+
+/*
+ * Fills in the metrics for a glyph, rendering it only the first time the
+ * code is seen. Returns FALSE if the font has no such glyph.
+ */
+static cairo_bool_t
+_get_glyph_metrics (cairo_amigaos_scaled_font_t   *font,
+                    uint32_t                       code,
+                    cairo_amigaos_glyph_metrics_t *metrics_out)
+{
+	cairo_amigaos_glyph_metrics_t  lookup, *metrics;
+	struct GlyphMap               *gm;
+
+	if (code < GLYPH_METRICS_ASCII) {
+		metrics = &font->ascii_metrics[code];
+		if (unlikely (! metrics->valid)) {
+			_engine_lock(font);
+			gm = _get_glyph_map(font, code);
+			_glyph_metrics_from_map(metrics, gm);
+			_release_glyph_map(font, gm);
+			_engine_unlock(font);
+		}
+
+		*metrics_out = *metrics;
+		return ! metrics->missing;
+	}
+
+	lookup.base.hash = code;
+	metrics = _cairo_cache_lookup(&font->metrics, &lookup.base);
+	if (metrics != NULL) {
+		*metrics_out = *metrics;
+		return ! metrics->missing;
+	}
+
+	_engine_lock(font);
+	gm = _get_glyph_map(font, code);
+	_glyph_metrics_from_map(metrics_out, gm);
+	_release_glyph_map(font, gm);
+	_engine_unlock(font);
+
+	/* Uncached metrics are still good for this call */
+	metrics = malloc(sizeof(cairo_amigaos_glyph_metrics_t));
+	if (likely (metrics != NULL)) {
+		*metrics = *metrics_out;
+		metrics->base.hash = code;
+		metrics->base.size = 1;
+
+		if (unlikely (_cairo_cache_insert(&font->metrics, &metrics->base)))
+			free(metrics);
+	}
+
+	return ! metrics_out->missing;
+}
+
+static int32_t
+_get_cached_kern (cairo_amigaos_scaled_font_t *font,
+                  uint32_t                     code,
+                  uint32_t                     code2)
+{
+	cairo_amigaos_kern_pair_t *pair;
+
+	pair = &font->kern_pairs[(code * 31 + code2) & (KERN_CACHE_SIZE - 1)];
+	if (pair->code != code || pair->code2 != code2) {
+		pair->code  = code;
+		pair->code2 = code2;
+		pair->kern  = _get_kern(font, code, code2);
+	}
+
+	return pair->kern;
+}
+
+/*
+ * The advance of a glyph in device pixels, rounded to a whole pixel when
+ * metrics are hinted. Both the reported extents and text_to_glyphs use
+ * this, so laid out text always matches the advances cairo sums up.
+ */
+static double
+_get_glyph_advance (cairo_amigaos_scaled_font_t         *font,
+                    const cairo_amigaos_glyph_metrics_t *metrics)
+{
+	double advance = FIXED_TO_FLOAT(metrics->width) * font->xscale;
+
+	if (font->hint_metrics)
+		advance = _cairo_lround(advance);
+
+	return advance;
+}
+
 static cairo_status_t
-_cairo_amigaos_scaled_font_glyph_init_metrics (cairo_amigaos_scaled_font_t *font,
-                                               cairo_scaled_glyph_t        *glyph,
-                                               struct GlyphMap             *gm)
+_cairo_amigaos_scaled_font_glyph_init_metrics (cairo_amigaos_scaled_font_t         *font,
+                                               cairo_scaled_glyph_t                *glyph,
+                                               const cairo_amigaos_glyph_metrics_t *metrics)
 {
 	cairo_text_extents_t extents;
 
-	debugf("_cairo_amigaos_scaled_font_glyph_init_metrics(%p, %p, %p)\n", font, glyph, gm);
+	debugf("_cairo_amigaos_scaled_font_glyph_init_metrics(%p, %p, %p)\n", font, glyph, metrics);
 
-	if (gm != NULL) {
-		extents.x_bearing = gm->glm_X0;
-		extents.y_bearing = -gm->glm_Y0;
-		extents.width     = gm->glm_BlackWidth;
-		extents.height    = gm->glm_BlackHeight;
-		extents.x_advance = FIXED_TO_FLOAT(gm->glm_Width);
+	if (! metrics->missing) {
+		extents.x_bearing = metrics->x0;
+		extents.y_bearing = -metrics->y0;
+		extents.width     = metrics->black_width;
+		extents.height    = metrics->black_height;
+		extents.x_advance = _get_glyph_advance(font, metrics) / font->xscale;
 		extents.y_advance = 0;
 	} else {
 		extents.x_bearing = 0;
@@ -166,8 +486,7 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a8 (cairo_amigaos_scaled_font_t *f
 {
 	cairo_image_surface_t *surface;
 	uint8_t               *src, *dst;
-	int                    src_mod, dst_mod;
-	int                    x, y;
+	int                    y;
 
 	debugf("_cairo_amigaos_scaled_font_glyph_init_surface_a8(%p, %p, %p)\n", font, glyph, gm);
 
@@ -190,15 +509,11 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a8 (cairo_amigaos_scaled_font_t *f
 	src = gm->glm_BitMap + (gm->glm_BMModulo * gm->glm_BlackTop) + gm->glm_BlackLeft;
 	dst = surface->data;
 
-	src_mod = gm->glm_BMModulo - gm->glm_BlackWidth;
-	dst_mod = surface->stride - gm->glm_BlackWidth;
-
 	for (y = 0; y < gm->glm_BlackHeight; y++) {
-		for (x = 0; x < gm->glm_BlackWidth; x++)
-			*dst++ = *src++;
+		memcpy(dst, src, gm->glm_BlackWidth);
 
-		src += src_mod;
-		dst += dst_mod;
+		src += gm->glm_BMModulo;
+		dst += surface->stride;
 	}
 
 	cairo_surface_set_device_offset(&surface->base, 0, gm->glm_Y0);
@@ -208,6 +523,45 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a8 (cairo_amigaos_scaled_font_t *f
 	return CAIRO_STATUS_SUCCESS;
 }
 
+static inline uint32_t
+_load_be32 (const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/*
+ * Copies width bits starting at bit shift of src to the start of dst,
+ * 32 bits at a time, without reading past the last source byte holding
+ * any of them.
+ */
+static void
+_copy_bits (uint8_t       *dst,
+            const uint8_t *src,
+            unsigned int   shift,
+            int            width)
+{
+	int      dst_bytes = (width + 7) >> 3;
+	int      src_bytes = (shift + width + 7) >> 3;
+	int      byte;
+	uint32_t word;
+
+	for (byte = 0; byte + 4 <= dst_bytes; byte += 4) {
+		word = _load_be32(src + byte);
+		if (shift != 0 && byte + 4 < src_bytes)
+			word = (word << shift) | (src[byte + 4] >> (8 - shift));
+		else
+			word <<= shift;
+
+		*(uint32_t *)(dst + byte) = cpu_to_be32(word);
+	}
+
+	for (; byte < dst_bytes; byte++) {
+		dst[byte] = src[byte] << shift;
+		if (shift != 0 && byte + 1 < src_bytes)
+			dst[byte] |= src[byte + 1] >> (8 - shift);
+	}
+}
+
 static cairo_status_t
 _cairo_amigaos_scaled_font_glyph_init_surface_a1 (cairo_amigaos_scaled_font_t *font,
                                                   cairo_scaled_glyph_t        *glyph,
@@ -215,8 +569,11 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a1 (cairo_amigaos_scaled_font_t *f
 {
 	cairo_image_surface_t *surface;
 	uint8_t               *src, *dst;
-	int                    y, byte;
+	int                    y;
 	unsigned int           shift;
+#ifndef WORDS_BIGENDIAN
+	int                    byte;
+#endif
 
 	debugf("_cairo_amigaos_scaled_font_glyph_init_surface_a1(%p, %p, %p)\n", font, glyph, gm);
 
@@ -245,13 +602,13 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a1 (cairo_amigaos_scaled_font_t *f
 	shift = gm->glm_BlackLeft & 7;
 
 	for (y = 0; y < gm->glm_BlackHeight; y++) {
-		for (byte = 0; byte < ((gm->glm_BlackWidth + 7) >> 3); byte++) {
-			dst[byte] = (src[byte] << shift) | (src[byte + 1] >> (8 - shift));
-			debugf("%d%d%d%d%d%d%d%d",
-			       (dst[byte] >> 7) & 1, (dst[byte] >> 6) & 1, (dst[byte] >> 5) & 1, (dst[byte] >> 4) & 1,
-			       (dst[byte] >> 3) & 1, (dst[byte] >> 2) & 1, (dst[byte] >> 1) & 1, dst[byte] & 1);
-		}
-		debugf("\n");
+		_copy_bits(dst, src, shift, gm->glm_BlackWidth);
+
+		/* The engine's maps are MSB first, cairo's follow the CPU */
+#ifndef WORDS_BIGENDIAN
+		for (byte = 0; byte < ((gm->glm_BlackWidth + 7) >> 3); byte++)
+			dst[byte] = CAIRO_BITSWAP8(dst[byte]);
+#endif
 
 		src += gm->glm_BMModulo;
 		dst += surface->stride;
@@ -264,45 +621,437 @@ _cairo_amigaos_scaled_font_glyph_init_surface_a1 (cairo_amigaos_scaled_font_t *f
 	return CAIRO_STATUS_SUCCESS;
 }
 
+/* FreeType's default LCD filter, in 1/256ths */
+static const uint8_t lcd_filter[5] = { 0x08, 0x4D, 0x56, 0x4D, 0x08 };
+
+static inline int
+_lcd_subpixel (const uint8_t *row, int width, int x)
+{
+	return x >= 0 && x < width ? row[x] : 0;
+}
+
+/*
+ * Renders the glyph three times wider, spreads it over the neighbouring
+ * subpixels to tame colour fringes, and packs each three subpixels into
+ * one component alpha pixel. The gray glyph map in gm places the result
+ * where the 8-bit glyph would have gone. Expects the engine locked.
+ */
+static cairo_status_t
+_cairo_amigaos_scaled_font_glyph_init_surface_lcd (cairo_amigaos_scaled_font_t *font,
+                                                   cairo_scaled_glyph_t        *glyph,
+                                                   struct GlyphMap             *gm)
+{
+	struct EGlyphEngine   *engine = &font->engine->outline_font->olf_EEngine;
+	cairo_image_surface_t *surface;
+	struct GlyphMap       *lcd_gm;
+	const uint8_t         *src;
+	uint32_t              *dst;
+	int                    start, start_x, lead;
+	int                    width, x, y, i, k;
+	int                    sub[3];
+
+	debugf("_cairo_amigaos_scaled_font_glyph_init_surface_lcd(%p, %p, %p)\n", font, glyph, gm);
+
+	if (gm == NULL) {
+		surface = (cairo_image_surface_t *)cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+		if (surface->base.status != CAIRO_STATUS_SUCCESS)
+			return surface->base.status;
+
+		_cairo_scaled_glyph_set_surface(glyph, &font->base, surface);
+
+		return CAIRO_STATUS_SUCCESS;
+	}
+
+	/* The next lock puts the engine back to its normal width */
+	font->engine->set_factor = LCD_SET_FACTOR;
+
+	IDiskfont->ESetInfo(engine,
+	                    OT_SetFactor, LCD_SET_FACTOR,
+	                    OT_GlyphCode, _cairo_scaled_glyph_index(glyph),
+	                    TAG_END);
+
+	lcd_gm = NULL;
+	IDiskfont->EObtainInfo(engine,
+	                       OT_GlyphMap8Bit, &lcd_gm,
+	                       TAG_END);
+
+	if (lcd_gm == NULL)
+		return _cairo_amigaos_scaled_font_glyph_init_surface_a8(font, glyph, gm);
+
+	/*
+	 * First filtered subpixel relative to the left edge of the gray
+	 * glyph, rounded down to a whole pixel with the remainder as lead.
+	 */
+	start   = 3 * gm->glm_X0 - lcd_gm->glm_X0 - 2;
+	start_x = start >= 0 ? start / 3 : -((2 - start) / 3);
+	lead    = start - 3 * start_x;
+
+	width = (lead + lcd_gm->glm_BlackWidth + 4 + 2) / 3;
+
+	surface = (cairo_image_surface_t *)cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+	                                                               width,
+	                                                               lcd_gm->glm_BlackHeight);
+	if (surface->base.status != CAIRO_STATUS_SUCCESS) {
+		_release_glyph_map(font, lcd_gm);
+		return surface->base.status;
+	}
+
+	for (y = 0; y < lcd_gm->glm_BlackHeight; y++) {
+		src = lcd_gm->glm_BitMap + lcd_gm->glm_BMModulo * (lcd_gm->glm_BlackTop + y) + lcd_gm->glm_BlackLeft;
+		dst = (uint32_t *)(surface->data + surface->stride * y);
+
+		for (x = 0; x < width; x++) {
+			for (i = 0; i < 3; i++) {
+				sub[i] = 0;
+				for (k = 0; k < 5; k++)
+					sub[i] += lcd_filter[k] * _lcd_subpixel(src, lcd_gm->glm_BlackWidth, 3 * x + i - lead - 4 + k);
+				sub[i] >>= 8;
+			}
+
+			if (font->mode == GLYPH_MODE_LCD_BGR)
+				dst[x] = ((uint32_t)sub[1] << 24) | (sub[2] << 16) | (sub[1] << 8) | sub[0];
+			else
+				dst[x] = ((uint32_t)sub[1] << 24) | (sub[0] << 16) | (sub[1] << 8) | sub[2];
+		}
+	}
+
+	pixman_image_set_component_alpha(surface->pixman_image, TRUE);
+
+	cairo_surface_set_device_offset(&surface->base, -start_x, lcd_gm->glm_Y0);
+
+	_release_glyph_map(font, lcd_gm);
+
+	_cairo_scaled_glyph_set_surface(glyph, &font->base, surface);
+
+	return CAIRO_STATUS_SUCCESS;
+}
+
+typedef struct _cairo_amigaos_contour {
+	int *points;
+	int  num_points, size;
+} cairo_amigaos_contour_t;
+
+/* Steps right, down, left and up along the pixel grid */
+static const int _contour_dx[4] = { 1, 0, -1, 0 };
+static const int _contour_dy[4] = { 0, 1, 0, -1 };
+
+static inline BOOL
+_glyph_pixel (const struct GlyphMap *gm, int x, int y)
+{
+	int bit;
+
+	if (x < 0 || y < 0 || x >= gm->glm_BlackWidth || y >= gm->glm_BlackHeight)
+		return FALSE;
+
+	bit = gm->glm_BlackLeft + x;
+	return (gm->glm_BitMap[gm->glm_BMModulo * (gm->glm_BlackTop + y) + (bit >> 3)] & (0x80 >> (bit & 7))) != 0;
+}
+
+/*
+ * Whether the pixel boundary leaves the grid point (x, y) in direction
+ * d with the set pixels on its right.
+ */
+static BOOL
+_glyph_boundary (const struct GlyphMap *gm, int x, int y, int d)
+{
+	switch (d) {
+	case 0:  return _glyph_pixel(gm, x, y) && ! _glyph_pixel(gm, x, y - 1);
+	case 1:  return _glyph_pixel(gm, x - 1, y) && ! _glyph_pixel(gm, x, y);
+	case 2:  return _glyph_pixel(gm, x - 1, y - 1) && ! _glyph_pixel(gm, x - 1, y);
+	default: return _glyph_pixel(gm, x, y - 1) && ! _glyph_pixel(gm, x - 1, y - 1);
+	}
+}
+
+static cairo_status_t
+_contour_add_point (cairo_amigaos_contour_t *contour, int x, int y)
+{
+	if (contour->num_points == contour->size) {
+		int *points;
+
+		points = _cairo_realloc_ab(contour->points, 2 * contour->size, 2 * sizeof(int));
+		if (unlikely (points == NULL))
+			return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+
+		contour->points = points;
+		contour->size  *= 2;
+	}
+
+	contour->points[2 * contour->num_points + 0] = x;
+	contour->points[2 * contour->num_points + 1] = y;
+	contour->num_points++;
+
+	return CAIRO_STATUS_SUCCESS;
+}
+
+/*
+ * Whether every corner strictly between i and k lies within a glyph
+ * map pixel of the straight line from i to k, and alongside it.
+ */
+static BOOL
+_contour_is_straight (const cairo_amigaos_contour_t *contour, int i, int k)
+{
+	const int *p = contour->points;
+	int        n = contour->num_points;
+	int64_t    ax, ay, dx, dy, len, cross, dot;
+	int        j;
+
+	ax  = p[2 * i];
+	ay  = p[2 * i + 1];
+	dx  = p[2 * (k % n)] - ax;
+	dy  = p[2 * (k % n) + 1] - ay;
+	len = dx * dx + dy * dy;
+
+	for (j = i + 1; j < k; j++) {
+		cross = dx * (p[2 * j + 1] - ay) - dy * (p[2 * j] - ax);
+		dot   = dx * (p[2 * j] - ax) + dy * (p[2 * j + 1] - ay);
+
+		if (cross * cross > len || dot < 0 || dot > len)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Adds the corners of a closed contour to the path, replacing each
+ * staircase of pixel steps with the straight line it follows.
+ */
+static cairo_status_t
+_glyph_path_add_contour (cairo_path_fixed_t            *path,
+                         const cairo_amigaos_contour_t *contour,
+                         int                            yorigin,
+                         int                            scale)
+{
+	const int     *p = contour->points;
+	int            n = contour->num_points;
+	int            i, k;
+	cairo_status_t status;
+
+	status = _cairo_path_fixed_move_to(path,
+	                                   _cairo_fixed_from_double((double)p[0] / scale),
+	                                   _cairo_fixed_from_double((double)(p[1] - yorigin) / scale));
+
+	for (i = 0; i < n && status == CAIRO_STATUS_SUCCESS; i = k) {
+		k = i + 1;
+		while (k + 1 < n + (i > 0) && _contour_is_straight(contour, i, k + 1))
+			k++;
+
+		if (k < n) {
+			status = _cairo_path_fixed_line_to(path,
+			                                   _cairo_fixed_from_double((double)p[2 * k] / scale),
+			                                   _cairo_fixed_from_double((double)(p[2 * k + 1] - yorigin) / scale));
+		}
+	}
+
+	if (status == CAIRO_STATUS_SUCCESS)
+		status = _cairo_path_fixed_close_path(path);
+
+	return status;
+}
+
+/*
+ * Traces the outlines of the set pixels of a mono glyph map. Each
+ * boundary is walked with the set pixels on its right, turning right
+ * where two pixels only touch at a corner, so outer contours run
+ * clockwise, holes anticlockwise and no two contours cross.
+ */
+static cairo_status_t
+_glyph_path_trace (cairo_path_fixed_t    *path,
+                   const struct GlyphMap *gm,
+                   int                    scale)
+{
+	cairo_amigaos_contour_t contour;
+	uint8_t                *visited;
+	int                     width, height;
+	int                     x, y, cx, cy, d, nd, turn;
+	cairo_status_t          status = CAIRO_STATUS_SUCCESS;
+
+	width  = gm->glm_BlackWidth;
+	height = gm->glm_BlackHeight;
+
+	/* Every contour has a rightward edge along the top of a pixel */
+	visited = calloc(width * height + 1, 1);
+	if (unlikely (visited == NULL))
+		return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+
+	contour.size       = 64;
+	contour.num_points = 0;
+	contour.points     = _cairo_malloc_ab(contour.size, 2 * sizeof(int));
+	if (unlikely (contour.points == NULL)) {
+		free(visited);
+		return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+	}
+
+	for (y = 0; y < height && status == CAIRO_STATUS_SUCCESS; y++) {
+		for (x = 0; x < width && status == CAIRO_STATUS_SUCCESS; x++) {
+			if (visited[y * width + x] || ! _glyph_boundary(gm, x, y, 0))
+				continue;
+
+			/* Nothing leads into (x, y) from the left, so it is a corner */
+			contour.num_points = 0;
+			status = _contour_add_point(&contour, x, y);
+
+			cx = x;
+			cy = y;
+			d  = 0;
+			do {
+				if (d == 0)
+					visited[cy * width + cx] = TRUE;
+
+				cx += _contour_dx[d];
+				cy += _contour_dy[d];
+
+				/* Prefer turning right, then straight on, then left */
+				for (turn = 1, nd = d; turn >= -1; turn--) {
+					nd = (d + turn + 4) & 3;
+					if (_glyph_boundary(gm, cx, cy, nd))
+						break;
+				}
+
+				if (nd != d && (cx != x || cy != y || nd != 0) && status == CAIRO_STATUS_SUCCESS)
+					status = _contour_add_point(&contour, cx, cy);
+
+				d = nd;
+			} while (cx != x || cy != y || d != 0);
+
+			if (status == CAIRO_STATUS_SUCCESS)
+				status = _glyph_path_add_contour(path, &contour, gm->glm_Y0, scale);
+		}
+	}
+
+	free(contour.points);
+	free(visited);
+
+	return status;
+}
+
+/*
+ * The outline engine only hands out rendered glyphs, so the path is
+ * traced from the outline of a glyph map rendered at least
+ * GLYPH_PATH_SIZE pixels high, with its pixel steps straightened out.
+ */
+static cairo_status_t
+_cairo_amigaos_scaled_font_glyph_init_path (cairo_amigaos_scaled_font_t *font,
+                                            cairo_scaled_glyph_t        *glyph)
+{
+	struct EGlyphEngine *engine = &font->engine->outline_font->olf_EEngine;
+	cairo_path_fixed_t  *path;
+	struct GlyphMap     *gm;
+	uint32_t             code;
+	int                  scale;
+	cairo_status_t       status;
+
+	debugf("_cairo_amigaos_scaled_font_glyph_init_path(%p, %p)\n", font, glyph);
+
+	path = _cairo_path_fixed_create();
+	if (unlikely (path == NULL))
+		return _cairo_error(CAIRO_STATUS_NO_MEMORY);
+
+	scale = ceil(GLYPH_PATH_SIZE / font->yscale);
+	if (scale > GLYPH_PATH_MAX_OVERSAMPLE)
+		scale = GLYPH_PATH_MAX_OVERSAMPLE;
+	if (scale < 1)
+		scale = 1;
+
+	code = _cairo_scaled_glyph_index(glyph);
+
+	status = CAIRO_STATUS_SUCCESS;
+
+	if (! font->ucs2_only || code <= 0xFFFF) {
+		_engine_lock(font);
+
+		/* The next lock puts the engine back to the size of the font */
+		font->engine->point_height = font->point_height * scale;
+
+		IDiskfont->ESetInfo(engine,
+		                    OT_PointHeight, font->engine->point_height,
+		                    OT_GlyphCode,   code,
+		                    TAG_END);
+
+		gm = NULL;
+		IDiskfont->EObtainInfo(engine,
+		                       OT_GlyphMap, &gm,
+		                       TAG_END);
+
+		if (gm != NULL) {
+			status = _glyph_path_trace(path, gm, scale);
+			_release_glyph_map(font, gm);
+		}
+
+		_engine_unlock(font);
+	}
+
+	if (unlikely (status)) {
+		_cairo_path_fixed_destroy(path);
+		return status;
+	}
+
+	_cairo_scaled_glyph_set_path(glyph, &font->base, path);
+
+	return CAIRO_STATUS_SUCCESS;
+}
+
 static cairo_int_status_t
 _cairo_amigaos_scaled_font_glyph_init (void                      *abstract_font,
                                        cairo_scaled_glyph_t      *glyph,
                                        cairo_scaled_glyph_info_t  info)
 {
-	cairo_amigaos_scaled_font_t *font = abstract_font;
-	struct GlyphMap             *gm;
-	cairo_status_t               status;
+	cairo_amigaos_scaled_font_t   *font = abstract_font;
+	cairo_amigaos_glyph_metrics_t  metrics;
+	struct GlyphMap               *gm;
+	cairo_status_t                 status;
 
 	debugf("_cairo_amigaos_scaled_font_glyph_init(%p, %p, %d)\n", abstract_font, glyph, info);
 
-	if (info & CAIRO_SCALED_GLYPH_INFO_PATH)
-		return CAIRO_INT_STATUS_UNSUPPORTED;
+	if (info & CAIRO_SCALED_GLYPH_INFO_PATH) {
+		status = _cairo_amigaos_scaled_font_glyph_init_path(font, glyph);
+		if (status != CAIRO_STATUS_SUCCESS)
+			return status;
+
+		info &= ~CAIRO_SCALED_GLYPH_INFO_PATH;
+		if (info == 0)
+			return CAIRO_STATUS_SUCCESS;
+	}
+
+	/* Extents alone never need the glyph rendered again */
+	if (info == CAIRO_SCALED_GLYPH_INFO_METRICS) {
+		_get_glyph_metrics(font, _cairo_scaled_glyph_index(glyph), &metrics);
+		return _cairo_amigaos_scaled_font_glyph_init_metrics(font, glyph, &metrics);
+	}
+
+	_engine_lock(font);
 
 	gm = _get_glyph_map(font, _cairo_scaled_glyph_index(glyph));
 
+	status = CAIRO_STATUS_SUCCESS;
+
 	if (info & CAIRO_SCALED_GLYPH_INFO_METRICS) {
-		status = _cairo_amigaos_scaled_font_glyph_init_metrics(font, glyph, gm);
-		if (status != CAIRO_STATUS_SUCCESS) {
-			_release_glyph_map(font, gm);
-			return status;
-		}
+		_glyph_metrics_from_map(&metrics, gm);
+		status = _cairo_amigaos_scaled_font_glyph_init_metrics(font, glyph, &metrics);
 	}
 
-	if (info & CAIRO_SCALED_GLYPH_INFO_SURFACE) {
-		if (font->antialias)
-			status = _cairo_amigaos_scaled_font_glyph_init_surface_a8(font, glyph, gm);
-		else
-			status = _cairo_amigaos_scaled_font_glyph_init_surface_a1(font, glyph, gm);
+	if (status == CAIRO_STATUS_SUCCESS && (info & CAIRO_SCALED_GLYPH_INFO_SURFACE)) {
+		switch (font->mode) {
+			case GLYPH_MODE_MONO:
+				status = _cairo_amigaos_scaled_font_glyph_init_surface_a1(font, glyph, gm);
+				break;
 
-		if (status != CAIRO_STATUS_SUCCESS) {
-			_release_glyph_map(font, gm);
-			return status;
+			case GLYPH_MODE_GRAY:
+				status = _cairo_amigaos_scaled_font_glyph_init_surface_a8(font, glyph, gm);
+				break;
+
+			case GLYPH_MODE_LCD_RGB:
+			case GLYPH_MODE_LCD_BGR:
+				status = _cairo_amigaos_scaled_font_glyph_init_surface_lcd(font, glyph, gm);
+				break;
 		}
 	}
 
 	_release_glyph_map(font, gm);
 
-	return CAIRO_STATUS_SUCCESS;
+	_engine_unlock(font);
+
+	return status;
 }
 
 static cairo_int_status_t
@@ -317,12 +1066,12 @@ _cairo_amigaos_scaled_font_text_to_glyphs (void                        *abstract
                                            int                         *num_clusters,
                                            cairo_text_cluster_flags_t  *cluster_flags)
 {
-	cairo_amigaos_scaled_font_t *font = abstract_font;
-	uint32_t                    *ucs4;
-	int                          len, i, j;
-	cairo_glyph_t               *glyphs;
-	struct GlyphMap             *gm;
-	cairo_status_t               status;
+	cairo_amigaos_scaled_font_t   *font = abstract_font;
+	uint32_t                      *ucs4;
+	int                            len, i, j;
+	cairo_glyph_t                 *glyphs;
+	cairo_amigaos_glyph_metrics_t  metrics;
+	cairo_status_t                 status;
 
 	debugf("_cairo_amigaos_scaled_font_text_to_glyphs(%p, %f, %f, %p, %d, %p, %p, %p, %p, %p)\n",
 	        abstract_font, x, y, utf8, utf8_len, glyphs_out, num_glyphs, clusters, num_clusters, cluster_flags);
@@ -334,23 +1083,20 @@ _cairo_amigaos_scaled_font_text_to_glyphs (void                        *abstract
 	glyphs = _cairo_malloc_ab(len, sizeof(cairo_glyph_t));
 
 	for (i = j = 0; i < len; i++) {
-		gm = _get_glyph_map(font, ucs4[i]);
-		if (gm == NULL) {
+		if (! _get_glyph_metrics(font, ucs4[i], &metrics)) {
 			x += font->xspace;
 			continue;
 		}
 
 		if (i > 0) {
-			x -= gm->glm_X0 + FIXED_TO_FLOAT(_get_kern(font, ucs4[i - 1], ucs4[i]));
+			x -= FIXED_TO_FLOAT(_get_cached_kern(font, ucs4[i - 1], ucs4[i]));
 		}
 
 		glyphs[j].index = ucs4[i];
 		glyphs[j].x     = x;
 		glyphs[j].y     = y;
 
-		x += gm->glm_X1 - gm->glm_X0;
-
-		_release_glyph_map(font, gm);
+		x += _get_glyph_advance(font, &metrics);
 
 		j++;
 	}
@@ -386,15 +1132,104 @@ static cairo_bool_t
 _cairo_amigaos_font_face_destroy (void *abstract_face)
 {
 	cairo_amigaos_font_face_t *face = abstract_face;
+	int                        i;
 
 	debugf("_cairo_amigaos_font_face_destroy(%p)\n", abstract_face);
 
 	free(face->filename);
 	face->filename = NULL;
 
+	if (face->has_extents_cache) {
+		_cairo_cache_fini(&face->extents);
+		face->has_extents_cache = FALSE;
+	}
+
+	for (i = 0; i < face->num_engines; i++) {
+		IDiskfont->CloseOutlineFont(face->engines[i].outline_font, NULL);
+		CAIRO_MUTEX_FINI(face->engines[i].mutex);
+	}
+	face->num_engines = 0;
+
+	CAIRO_MUTEX_FINI(face->mutex);
+
 	return TRUE;
 }
 
+static cairo_bool_t
+_font_extents_equal (const void *key_a, const void *key_b)
+{
+	const cairo_amigaos_font_extents_t *a = key_a;
+	const cairo_amigaos_font_extents_t *b = key_b;
+
+	return a->point_height == b->point_height && a->mode == b->mode;
+}
+
+/*
+ * Copies the extents and ASCII glyph metrics of an earlier scaled font
+ * of the same point height and glyph mode, if there was one.
+ */
+static cairo_bool_t
+_font_extents_lookup (cairo_amigaos_font_face_t   *face,
+                      cairo_amigaos_scaled_font_t *font,
+                      int32                        point_height,
+                      cairo_font_extents_t        *extents_out)
+{
+	cairo_amigaos_font_extents_t lookup, *extents;
+
+	if (! face->has_extents_cache)
+		return FALSE;
+
+	lookup.base.hash    = (uint32)point_height ^ font->mode;
+	lookup.point_height = point_height;
+	lookup.mode         = font->mode;
+
+	CAIRO_MUTEX_LOCK(face->mutex);
+
+	extents = _cairo_cache_lookup(&face->extents, &lookup.base);
+	if (extents != NULL) {
+		*extents_out = extents->extents;
+		memcpy(font->ascii_metrics, extents->ascii_metrics, sizeof(font->ascii_metrics));
+	}
+
+	CAIRO_MUTEX_UNLOCK(face->mutex);
+
+	return extents != NULL;
+}
+
+static void
+_font_extents_insert (cairo_amigaos_font_face_t         *face,
+                      const cairo_amigaos_scaled_font_t *font,
+                      int32                              point_height,
+                      const cairo_font_extents_t        *extents_in)
+{
+	cairo_amigaos_font_extents_t *extents;
+
+	if (! face->has_extents_cache)
+		return;
+
+	extents = malloc(sizeof(cairo_amigaos_font_extents_t));
+	if (unlikely (extents == NULL))
+		return;
+
+	extents->base.hash    = (uint32)point_height ^ font->mode;
+	extents->base.size    = 1;
+	extents->point_height = point_height;
+	extents->mode         = font->mode;
+	extents->extents   = *extents_in;
+	memcpy(extents->ascii_metrics, font->ascii_metrics, sizeof(extents->ascii_metrics));
+
+	CAIRO_MUTEX_LOCK(face->mutex);
+
+	/* Another font of this size may have got here first */
+	if (_cairo_cache_lookup(&face->extents, &extents->base) != NULL ||
+	    _cairo_cache_insert(&face->extents, &extents->base) != CAIRO_STATUS_SUCCESS)
+	{
+		free(extents);
+	}
+
+	CAIRO_MUTEX_UNLOCK(face->mutex);
+}
+
 static cairo_status_t
 _cairo_amigaos_font_face_scaled_font_create (void                        *abstract_face,
                                              const cairo_matrix_t        *font_matrix,
@@ -402,18 +1237,19 @@ _cairo_amigaos_font_face_scaled_font_create (void                        *abstra
                                              const cairo_font_options_t  *options,
                                              cairo_scaled_font_t        **font_out)
 {
-	cairo_amigaos_font_face_t   *face = abstract_face;
-	cairo_status_t               status;
-	cairo_matrix_t               scale;
-	double                       xscale, yscale;
-	struct OutlineFont          *outline_font;
-	struct EGlyphEngine         *engine;
-	cairo_amigaos_scaled_font_t *font;
-	uint32_t                     code;
-	double                       yorigin, ascent, descent;
-	double                       width, max_width;
-	struct GlyphMap             *gm;
-	cairo_font_extents_t         extents;
+	cairo_amigaos_font_face_t     *face = abstract_face;
+	cairo_status_t                 status;
+	cairo_matrix_t                 scale;
+	double                         xscale, yscale;
+	cairo_amigaos_engine_t        *engine;
+	struct TagItem                *otags;
+	cairo_amigaos_scaled_font_t   *font;
+	int32                          point_height;
+	uint32_t                       code;
+	double                         yorigin, ascent, descent;
+	double                         width, max_width;
+	cairo_amigaos_glyph_metrics_t  metrics;
+	cairo_font_extents_t           extents;
 
 	debugf("_cairo_amigaos_font_face_scaled_font_create(%p, %p, %p, %p, %p)\n",
 	       abstract_face, font_matrix, ctm, options, font_out);
@@ -423,40 +1259,31 @@ _cairo_amigaos_font_face_scaled_font_create (void                        *abstra
 	if (status != CAIRO_STATUS_SUCCESS)
 		return status;
 
-	outline_font = IDiskfont->OpenOutlineFont(face->filename, NULL, OFF_OPEN);
-	if (outline_font == NULL)
+	engine = _engine_get(face);
+	if (engine == NULL)
 		return _cairo_error(CAIRO_STATUS_NO_MEMORY);
 
-	engine = &outline_font->olf_EEngine;
-
 	font = malloc(sizeof(cairo_amigaos_scaled_font_t));
 
-	font->outline_font = outline_font;
+	font->face      = face;
+	font->engine    = engine;
+	font->ucs2_only = engine->ucs2_only;
 
 	font->xscale = xscale;
 	font->yscale = yscale;
 
-	debugf("Setting OT_PointHeight to 0x%lx\n", FLOAT_TO_FIXED(font->yscale));
-	IDiskfont->ESetInfo(engine,
-	                    OT_DeviceDPI,   72 | (72 << 16),
-	                    OT_PointHeight, FLOAT_TO_FIXED(font->yscale),
-	                    TAG_END);
+	/* The engine is switched to this size when the font locks it */
+	point_height = FLOAT_TO_FIXED(font->yscale);
+	font->point_height = point_height;
 
-	if (IDiskfont->ESetInfo(engine,
-	                        OT_GlyphCode_32, 'A',
-	                        TAG_END) != OTERR_UnknownTag)
-	{
-		debugf("Full UCS-4 support\n");
-		font->ucs2_only = FALSE;
-	} else {
-		debugf("Only UCS-2 supported\n");
-		font->ucs2_only = TRUE;
-	}
+	debugf("Using OT_PointHeight 0x%lx\n", point_height);
+
+	otags = engine->outline_font->olf_OTagList;
 
-	font->xspace = FIXED_TO_FLOAT(IUtility->GetTagData(OT_SpaceFactor, 0, outline_font->olf_OTagList)) * font->yscale;
+	font->xspace = FIXED_TO_FLOAT(IUtility->GetTagData(OT_SpaceFactor, 0, otags)) * font->yscale;
 
 	if (font->xspace == 0)
-		font->xspace = FIXED_TO_FLOAT(IUtility->GetTagData(OT_SpaceWidth, 0, outline_font->olf_OTagList));
+		font->xspace = FIXED_TO_FLOAT(IUtility->GetTagData(OT_SpaceWidth, 0, otags));
 
 	if (font->xspace == 0)
 		font->xspace = font->yscale / 3;
@@ -469,64 +1296,119 @@ _cairo_amigaos_font_face_scaled_font_create (void                        *abstra
 	switch(options->antialias) {
 		case CAIRO_ANTIALIAS_NONE:
 			debugf("Antialiasing disabled\n");
-			font->antialias = FALSE;
+			font->mode = GLYPH_MODE_MONO;
 			break;
 
-		case CAIRO_ANTIALIAS_DEFAULT:
-		case CAIRO_ANTIALIAS_GRAY:
 		case CAIRO_ANTIALIAS_SUBPIXEL:
+			/* Only horizontal subpixel layouts are filtered */
+			if (options->subpixel_order == CAIRO_SUBPIXEL_ORDER_BGR) {
+				debugf("Subpixel antialiasing enabled (BGR)\n");
+				font->mode = GLYPH_MODE_LCD_BGR;
+				break;
+			} else if (options->subpixel_order == CAIRO_SUBPIXEL_ORDER_DEFAULT ||
+			           options->subpixel_order == CAIRO_SUBPIXEL_ORDER_RGB) {
+				debugf("Subpixel antialiasing enabled (RGB)\n");
+				font->mode = GLYPH_MODE_LCD_RGB;
+				break;
+			}
+			/* fall through */
+
+		case CAIRO_ANTIALIAS_DEFAULT:
 		case CAIRO_ANTIALIAS_FAST:
+		case CAIRO_ANTIALIAS_GRAY:
 		case CAIRO_ANTIALIAS_GOOD:
 		case CAIRO_ANTIALIAS_BEST:
 			debugf("Antialiasing enabled\n");
-			font->antialias = TRUE;
+			font->mode = GLYPH_MODE_GRAY;
+			break;
+	}
+
+	/*
+	 * The image surface asks for hinted metrics itself, but the native
+	 * surface supplies no font options, so DEFAULT is what reaches us
+	 * when drawing to a window. Hint there too, as the FreeType backend
+	 * does; only an explicit OFF gives fractional advances.
+	 */
+	switch (options->hint_metrics) {
+		case CAIRO_HINT_METRICS_ON:
+		case CAIRO_HINT_METRICS_DEFAULT:
+			font->hint_metrics = TRUE;
+			break;
+
+		case CAIRO_HINT_METRICS_OFF:
+			font->hint_metrics = FALSE;
 			break;
 	}
 
+	memset(font->ascii_metrics, 0, sizeof(font->ascii_metrics));
+	memset(font->kern_pairs, 0xff, sizeof(font->kern_pairs));
+
+	status = _cairo_cache_init(&font->metrics,
+	                           _glyph_metrics_equal,
+	                           NULL,
+	                           free,
+	                           GLYPH_METRICS_CACHE_SIZE);
+	if (status) {
+		_engine_put(face, engine);
+		free(font);
+		return status;
+	}
+
 	status = _cairo_scaled_font_init(&font->base, &face->base,
 	                                 font_matrix, ctm, options,
 	                                 &cairo_amigaos_scaled_font_backend);
 	if (status) {
-		IDiskfont->CloseOutlineFont(outline_font, NULL);
+		_cairo_cache_fini(&font->metrics);
+		_engine_put(face, engine);
 		free(font);
 		return status;
 	}
 
-	ascent = descent = 0;
-	max_width = font->xspace;
-	for (code = 0; code < 128; code++) {
-		gm = _get_glyph_map(font, code);
-		if (gm == NULL)
-			continue;
+	cairo_font_face_reference(&face->base);
 
-		if (gm->glm_BlackWidth == 0)
-			continue;
+	/*
+	 * The engine reports no ascent or descent, so they are measured from
+	 * the ASCII glyphs once for each size of the face.
+	 */
+	if (! _font_extents_lookup(face, font, point_height, &extents)) {
+		ascent = descent = 0;
+		max_width = font->xspace;
+		for (code = 0; code < GLYPH_METRICS_ASCII; code++) {
+			/* This also fills in the direct-mapped metrics for layout */
+			if (! _get_glyph_metrics(font, code, &metrics))
+				continue;
 
-		yorigin = FIXED_TO_FLOAT(gm->glm_YOrigin);
+			if (metrics.black_width == 0)
+				continue;
 
-		if (ascent < yorigin)
-			ascent = yorigin;
+			yorigin = FIXED_TO_FLOAT(metrics.yorigin);
 
-		if (descent < (gm->glm_BlackHeight - yorigin))
-			descent = gm->glm_BlackHeight - yorigin;
+			if (ascent < yorigin)
+				ascent = yorigin;
 
-		width = FIXED_TO_FLOAT(gm->glm_Width);
+			if (descent < (metrics.black_height - yorigin))
+				descent = metrics.black_height - yorigin;
 
-		if (max_width < width)
-			max_width = width;
+			width = FIXED_TO_FLOAT(metrics.width);
 
-		_release_glyph_map(font, gm);
-	}
+			if (max_width < width)
+				max_width = width;
+		}
 
-	extents.ascent        = ascent / font->yscale;
-	extents.descent       = descent / font->yscale;
-	extents.height        = extents.ascent * 1.2 + extents.descent;
-	extents.max_x_advance = max_width;
-	extents.max_y_advance = 0;
+		extents.ascent        = ascent / font->yscale;
+		extents.descent       = descent / font->yscale;
+		extents.height        = extents.ascent * 1.2 + extents.descent;
+		extents.max_x_advance = max_width;
+		extents.max_y_advance = 0;
+
+		_font_extents_insert(face, font, point_height, &extents);
+	}
 
 	status = _cairo_scaled_font_set_metrics (&font->base, &extents);
 	if (status) {
-		IDiskfont->CloseOutlineFont(outline_font, NULL);
+		_cairo_cache_fini(&font->metrics);
+		_engine_put(face, engine);
+		cairo_font_face_destroy(&face->base);
 		free(font);
 		return status;
 	}
@@ -555,6 +1437,17 @@ cairo_amigaos_font_face_create (const char *filename)
 
 	face->filename = strdup(filename);
 
+	CAIRO_MUTEX_INIT(face->mutex);
+
+	face->num_engines = 0;
+
+	/* Without the cache every scaled font measures its own extents */
+	face->has_extents_cache = _cairo_cache_init(&face->extents,
+	                                            _font_extents_equal,
+	                                            NULL,
+	                                            free,
+	                                            FONT_EXTENTS_CACHE_SIZE) == CAIRO_STATUS_SUCCESS;
+
 	_cairo_font_face_init(&face->base, &cairo_amigaos_font_face_backend);
 
 	return &face->base;
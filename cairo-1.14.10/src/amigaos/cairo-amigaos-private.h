@@ -37,6 +37,21 @@
 
 #define DEBUG_AMIGAOS_BACKENDS 0
 
+/* Width of the ALPHA8 ramp used to turn per-vertex coverage into alpha */
+#define COVERAGE_RAMP_SIZE 256
+
+/* Number of 1x1 solid colour sources kept around for reuse */
+#define SOLID_CACHE_SIZE 16
+
+/* Total size in texels of the cached gradient textures */
+#define GRADIENT_CACHE_SIZE (1024 * 1024)
+
+/* Scratch buffers are kept in buckets by the power of two of their size */
+#define SCRATCH_BUCKETS 32
+
+/* Default limit in bytes on the idle scratch buffers kept around */
+#define SCRATCH_HIGH_WATER (16 * 1024 * 1024)
+
 typedef struct _cairo_amigaos_surface {
 	cairo_surface_t        base;
 
@@ -54,6 +69,7 @@ typedef struct _cairo_amigaos_surface {
 	APTR                   map_lock;
 	uint32                 map_pixfmt;
 	cairo_image_surface_t *map_image;
+	cairo_bool_t           map_readback;
 } cairo_amigaos_surface_t;
 
 static inline cairo_bool_t
@@ -66,14 +82,56 @@ typedef struct _cairo_amigaos_device {
 	cairo_device_t            base;
 
 	const cairo_compositor_t *compositor;
+
+	struct BitMap            *coverage_ramp;
+
+	cairo_bool_t              batch_boxes;
+
+	/* Most recently used first, protected by the device mutex */
+	struct {
+		uint32                   argb;
+		cairo_amigaos_surface_t *surface;
+	}                         solid_cache[SOLID_CACHE_SIZE];
+	int                       num_solids;
+
+	/* Gradient textures, protected by the device mutex */
+	cairo_cache_t             gradients;
+	cairo_bool_t              has_gradient_cache;
+
+	/* Idle pixel buffers for mapping bitmaps that can not be locked,
+	 * protected by the device mutex
+	 */
+	cairo_list_t              scratch_buckets[SCRATCH_BUCKETS];
+	cairo_list_t              scratch_lru;
+	size_t                    scratch_size;
+	size_t                    scratch_high_water;
 } cairo_amigaos_device_t;
 
 cairo_device_t *
 _cairo_amigaos_device_get (void);
 
+void
+_cairo_amigaos_device_reset_solid_cache (cairo_amigaos_device_t *device);
+
+void *
+_cairo_amigaos_device_get_scratch (cairo_amigaos_device_t *device,
+                                   size_t                  size);
+
+void
+_cairo_amigaos_device_put_scratch (cairo_amigaos_device_t *device,
+                                   void                   *data);
+
+cairo_image_surface_t *
+_cairo_amigaos_surface_map (cairo_amigaos_surface_t     *surface,
+                            const cairo_rectangle_int_t *extents,
+                            cairo_bool_t                 readback);
+
 const cairo_compositor_t *
 _cairo_amigaos_compositor_get (void);
 
+cairo_status_t
+_cairo_amigaos_gradient_cache_init (cairo_cache_t *cache);
+
 #if DEBUG_AMIGAOS_BACKENDS
 void _cairo_amigaos_debugf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
 #define debugf(fmt, args...) _cairo_amigaos_debugf(fmt, ## args)
@@ -28,6 +28,7 @@
 #include "cairoint.h"
 
 #include "cairo-amigaos-private.h"
+#include "cairo-damage-private.h"
 #include "cairo-default-context-private.h"
 #include "cairo-compositor-private.h"
 #include "cairo-image-surface-private.h"
@@ -147,11 +148,16 @@ _cairo_amigaos_surface_create_similar_image (void           *abstract_surface,
 	return cairo_image_surface_create(format, width, height);
 }
 
-static cairo_image_surface_t *
-_cairo_amigaos_surface_map_to_image (void                        *abstract_surface,
-                                     const cairo_rectangle_int_t *extents)
+/* Maps the surface like map_to_image. Without readback the contents of a
+ * copied image are left undefined, for callers that overwrite everything
+ * they attach as damage to the image before unmapping it.
+ */
+cairo_image_surface_t *
+_cairo_amigaos_surface_map (cairo_amigaos_surface_t     *surface,
+                            const cairo_rectangle_int_t *extents,
+                            cairo_bool_t                 readback)
 {
-	cairo_amigaos_surface_t *surface = abstract_surface;
+	cairo_amigaos_device_t  *device = (cairo_amigaos_device_t *)surface->base.device;
 	int                      x, y, width, height;
 	uint32                   pixfmt;
 	cairo_format_t           format;
@@ -159,8 +165,8 @@ _cairo_amigaos_surface_map_to_image (void                        *abstract_surfa
 	uint8_t                 *data;
 	cairo_image_surface_t   *image;
 
-	debugf("_cairo_amigaos_surface_map_to_image(%p, %p)\n",
-	       abstract_surface, extents);
+	debugf("_cairo_amigaos_surface_map(%p, %p, %d)\n",
+	       surface, extents, readback);
 
 	assert(surface->map_image == NULL);
 
@@ -180,6 +186,7 @@ _cairo_amigaos_surface_map_to_image (void                        *abstract_surfa
 	surface->map_rect.y      = y;
 	surface->map_rect.width  = width;
 	surface->map_rect.height = height;
+	surface->map_readback    = readback;
 
 	pixfmt = IGraphics->GetBitMapAttr(surface->bitmap, BMA_PIXELFORMAT);
 	format = _amigaos_pixel_format_to_cairo_format(pixfmt);
@@ -249,22 +256,24 @@ _cairo_amigaos_surface_map_to_image (void                        *abstract_surfa
 	}
 
 	stride = width * bpp;
-	data   = (uint8_t *)malloc(height * stride);
+	data   = _cairo_amigaos_device_get_scratch(device, (size_t)height * stride);
 	if (data == NULL) {
 		surface->map_pixfmt = PIXF_NONE;
 		surface->map_image  = NULL;
 		return _cairo_image_surface_create_in_error(_cairo_error(CAIRO_STATUS_NO_MEMORY));
 	}
 
-	IGraphics->ReadPixelArray(surface->rastport, surface->xoff + x, surface->yoff + y,
-	                          data, 0, 0, stride, pixfmt,
-	                          width, height);
+	if (readback) {
+		IGraphics->ReadPixelArray(surface->rastport, surface->xoff + x, surface->yoff + y,
+		                          data, 0, 0, stride, pixfmt,
+		                          width, height);
+	}
 
 	image = (cairo_image_surface_t *)cairo_image_surface_create_for_data(data, format,
 	                                                                     width, height,
 	                                                                     stride);
 	if (unlikely (image->base.backend == NULL)) {
-		free(data);
+		_cairo_amigaos_device_put_scratch(device, data);
 		surface->map_pixfmt = PIXF_NONE;
 		surface->map_image  = NULL;
 		return image;
@@ -276,15 +285,24 @@ _cairo_amigaos_surface_map_to_image (void                        *abstract_surfa
 	return image;
 }
 
+static cairo_image_surface_t *
+_cairo_amigaos_surface_map_to_image (void                        *abstract_surface,
+                                     const cairo_rectangle_int_t *extents)
+{
+	return _cairo_amigaos_surface_map(abstract_surface, extents, TRUE);
+}
+
 static cairo_int_status_t
 _cairo_amigaos_surface_unmap_image (void                  *abstract_surface,
                                     cairo_image_surface_t *image)
 {
 	cairo_amigaos_surface_t *surface = abstract_surface;
+	cairo_amigaos_device_t  *device  = (cairo_amigaos_device_t *)surface->base.device;
 	int                      x, y, width, height;
 	uint32                   pixfmt;
 	int                      stride;
 	uint8                   *data;
+	cairo_damage_t          *damage;
 
 	debugf("_cairo_amigaos_surface_unmap_image(%p, %p)\n",
 	       abstract_surface, image);
@@ -305,13 +323,36 @@ _cairo_amigaos_surface_unmap_image (void                  *abstract_surface,
 		pixfmt = surface->map_pixfmt;
 		stride = image->stride;
 		data   = image->data;
-
-		IGraphics->WritePixelArray(data, 0, 0, stride, pixfmt,
-	                           surface->rastport, surface->xoff + x, surface->yoff + y,
-	                           width, height);
+		damage = image->base.damage;
+
+		/* With damage attached only the damaged boxes, given in image
+		 * coordinates, are written back. If the damage was lost, an image
+		 * that was never read in holds nothing worth writing back.
+		 */
+		if (damage == NULL || (damage->status && surface->map_readback)) {
+			IGraphics->WritePixelArray(data, 0, 0, stride, pixfmt,
+			                           surface->rastport, surface->xoff + x, surface->yoff + y,
+			                           width, height);
+		} else if (damage->status == CAIRO_STATUS_SUCCESS) {
+			const struct _cairo_damage_chunk *chunk;
+			int                               i;
+
+			for (chunk = &damage->chunks; chunk != NULL; chunk = chunk->next) {
+				for (i = 0; i < chunk->count; i++) {
+					const cairo_box_t *box = &chunk->base[i];
+
+					IGraphics->WritePixelArray(data, box->p1.x, box->p1.y, stride, pixfmt,
+					                           surface->rastport,
+					                           surface->xoff + x + box->p1.x,
+					                           surface->yoff + y + box->p1.y,
+					                           box->p2.x - box->p1.x,
+					                           box->p2.y - box->p1.y);
+				}
+			}
+		}
 
 		cairo_surface_destroy(&image->base);
-		free(data);
+		_cairo_amigaos_device_put_scratch(device, data);
 	}
 
 	surface->map_image = NULL;
@@ -526,8 +567,9 @@ cairo_amigaos_surface_create_from_rastport (struct RastPort *rastport,
 	surface->height = height;
 
 	surface->map_lock   = NULL;
-	surface->map_pixfmt = PIXF_NONE;
-	surface->map_image  = NULL;
+	surface->map_pixfmt   = PIXF_NONE;
+	surface->map_image    = NULL;
+	surface->map_readback = TRUE;
 
 	pixfmt = IGraphics->GetBitMapAttr(bitmap, BMA_PIXELFORMAT);
 
@@ -50,6 +50,10 @@ cairo_amigaos_surface_create_from_rastport (struct RastPort *rastport,
                                             int              width,
                                             int              height);
 
+cairo_public void
+cairo_amigaos_device_set_scratch_high_water (cairo_device_t *device,
+                                             unsigned long   bytes);
+
 CAIRO_END_DECLS
 
 #endif /* CAIRO_HAS_AMIGAOS_SURFACE */
@@ -0,0 +1,1026 @@
+/* -*- Mode: c; tab-width: 8; c-basic-offset: 4; indent-tabs-mode: t; -*- */
+/*
+ * Copyright (c) 2026  The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* An analytic coverage scan converter.
+ *
+ * Rather than sampling each pixel row on a grid like the tor
+ * converters, every edge is clipped to the pixel row and walked
+ * across the pixel columns it passes through.  For each pixel it adds
+ * the signed height it covers and the signed area to its left, in
+ * units of the 24.8 fixed point input, into an accumulation row.  A
+ * running sum of the heights then gives the exact area covered by the
+ * polygon in every pixel.
+ *
+ * Sums of signed areas only give the coverage directly where the
+ * winding number is 0 or 1, so before accumulating a row its edges are
+ * reduced to the boundary of the region the fill rule selects.  The
+ * row is cut into slabs at every y where an edge starts or ends, and
+ * walking the edges of a slab left to right while counting the
+ * winding number shows which of them enter or leave the filled
+ * region.  Only those are accumulated, each oriented so that the
+ * region lies to its right.  Where two neighbours cross within the
+ * slab they swap places, and only those two can change whether they
+ * are on the boundary.  The active edges are kept in order from row to
+ * row, so sorting them is usually a single pass.
+ *
+ * The cost is proportional to the number of pixels the boundary passes
+ * through, so long thin edges are cheap.
+ */
+
+#include "cairoint.h"
+#include "cairo-spans-private.h"
+#include "cairo-error-private.h"
+#include "cairo-combsort-inline.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define PIXEL_BITS CAIRO_FIXED_FRAC_BITS
+#define ONE_PIXEL CAIRO_FIXED_ONE
+
+/* Twice the area of a pixel: the largest accumulated pixel value for a
+ * single winding. */
+#define FULL_AREA (2 * ONE_PIXEL * ONE_PIXEL)
+
+struct quorem {
+    int32_t quo;
+    int32_t rem;
+};
+
+struct edge {
+    struct edge *next, *prev;
+
+    int32_t dir;
+    int32_t vertical;
+
+    /* Current position along the edge, and where it ends. */
+    cairo_fixed_t y, ybot;
+    struct quorem x;
+    cairo_fixed_t xbot;
+
+    /* The line the edge lies on, and its step over a pixel row. */
+    cairo_fixed_t x0, y0;
+    int32_t dx, dy;
+    struct quorem dxdy;
+};
+
+/* The edges of the polygon, vertically clipped and bucketed by the
+ * pixel row in which they start. */
+struct polygon {
+    int32_t ymin, ymax;
+
+    int num_edges;
+    struct edge *edges;
+    struct edge **y_buckets;
+
+    struct edge *y_buckets_embedded[64];
+    struct edge edges_embedded[32];
+};
+
+/* The part of an active edge within the current pixel row. */
+struct segment {
+    struct edge *edge;
+    int32_t dir;
+    cairo_bool_t more;
+
+    /* From y1 to y2 relative to the top of the row, y1 < y2. */
+    int y1, y2;
+    cairo_fixed_t x1, x2;
+
+    /* Where the edge crosses the top and bottom of the current slab,
+     * the winding number to its left and the y at which it next
+     * crosses its right hand neighbour within the slab. */
+    cairo_fixed_t top, bottom;
+    int winding;
+    int cross;
+
+    /* The part of the boundary not yet accumulated: from (px, py) down
+     * to the current position if @state is 1, up from it if -1. */
+    int state;
+    cairo_fixed_t px;
+    int py;
+};
+
+struct analytic_scan_converter {
+    struct polygon polygon[1];
+
+    /* Edges crossing the current pixel row, left to right as of the
+     * bottom of the previous row. */
+    struct edge head, tail;
+    int num_sloped;
+
+    /* Room for reducing a row to its boundary: a segment for each
+     * active edge, their order left to right, those within the current
+     * slab, and the y of every segment end. */
+    struct segment *segments;
+    int *order;
+    int *slab;
+    int *events;
+
+    /* Accumulation row for [xmin, xmax), with the height of anything
+     * to the left of xmin summed separately.  @touched marks the
+     * pixels listed in @cells. */
+    int32_t *cover;
+    int32_t *area;
+    uint8_t *touched;
+    int *cells;
+    int num_cells;
+    int left;
+    void *row_data;
+
+    cairo_half_open_span_t *spans;
+    cairo_half_open_span_t spans_embedded[64];
+    int num_spans;
+
+    int32_t xmin, xmax;
+    int32_t ymin, ymax;
+};
+
+#define I(x) _cairo_fixed_integer_floor(x)
+
+/* Compute the floored division (x*a)/b. Assumes / and % perform symmetric
+ * division. */
+static struct quorem
+floored_muldivrem(int x, int a, int b)
+{
+    struct quorem qr;
+    long long xa = (long long)x*a;
+    qr.quo = xa/b;
+    qr.rem = xa%b;
+    if ((xa>=0) != (b>=0) && qr.rem) {
+	qr.quo -= 1;
+	qr.rem += b;
+    }
+    return qr;
+}
+
+static inline struct quorem
+edge_x_at (const struct edge *e, cairo_fixed_t y)
+{
+    struct quorem x;
+
+    x = floored_muldivrem (y - e->y0, e->dx, e->dy);
+    x.quo += e->x0;
+    return x;
+}
+
+static cairo_status_t
+polygon_init (struct polygon *polygon, int ymin, int ymax)
+{
+    unsigned h = ymax - ymin;
+
+    polygon->y_buckets = polygon->y_buckets_embedded;
+    if (h > ARRAY_LENGTH (polygon->y_buckets_embedded)) {
+	polygon->y_buckets = _cairo_malloc_ab (h, sizeof (struct edge *));
+	if (unlikely (NULL == polygon->y_buckets))
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    }
+    memset (polygon->y_buckets, 0, h * sizeof (struct edge *));
+
+    polygon->num_edges = 0;
+    polygon->edges = polygon->edges_embedded;
+    polygon->ymin = ymin;
+    polygon->ymax = ymax;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+polygon_fini (struct polygon *polygon)
+{
+    if (polygon->y_buckets != polygon->y_buckets_embedded)
+	free (polygon->y_buckets);
+
+    if (polygon->edges != polygon->edges_embedded)
+	free (polygon->edges);
+}
+
+static void
+polygon_add_edge (struct polygon *polygon,
+		  const cairo_edge_t *edge)
+{
+    struct edge *e, **bucket;
+    cairo_fixed_t ytop, ybot;
+
+    ytop = MAX (edge->top, _cairo_fixed_from_int (polygon->ymin));
+    ybot = MIN (edge->bottom, _cairo_fixed_from_int (polygon->ymax));
+    if (ybot <= ytop)
+	return;
+
+    e = polygon->edges + polygon->num_edges++;
+    e->dir = edge->dir;
+    e->y = ytop;
+    e->ybot = ybot;
+
+    e->x0 = edge->line.p1.x;
+    e->y0 = edge->line.p1.y;
+    e->dx = edge->line.p2.x - edge->line.p1.x;
+    e->dy = edge->line.p2.y - edge->line.p1.y;
+
+    e->vertical = e->dx == 0;
+    if (e->vertical) {
+	e->x.quo = e->x0;
+	e->x.rem = 0;
+	e->dxdy.quo = e->dxdy.rem = 0;
+	e->xbot = e->x0;
+    } else {
+	e->x = edge_x_at (e, ytop);
+	e->dxdy = floored_muldivrem (e->dx, ONE_PIXEL, e->dy);
+	if (ybot == edge->line.p2.y)
+	    e->xbot = edge->line.p2.x;
+	else
+	    e->xbot = edge_x_at (e, ybot).quo;
+    }
+
+    bucket = &polygon->y_buckets[I(ytop) - polygon->ymin];
+    e->next = *bucket;
+    *bucket = e;
+}
+
+/* Adds to the accumulation row at pixel x. */
+static inline void
+cell_add (struct analytic_scan_converter *c, int x, int cover, int area)
+{
+    x -= c->xmin;
+    if (x < 0) {
+	c->left += cover;
+	return;
+    }
+    if (x >= c->xmax - c->xmin)
+	return;
+
+    if (! c->touched[x]) {
+	c->touched[x] = 1;
+	c->cells[c->num_cells++] = x;
+    }
+    c->cover[x] += cover;
+    c->area[x] += area;
+}
+
+/* Accumulates the line from (x1, y1) to (x2, y2), which lies within a
+ * single pixel row.  The y coordinates are relative to the top of the
+ * row and ordered in the direction of the edge, so the sign of y2 - y1
+ * carries its winding. */
+static void
+render_line (struct analytic_scan_converter *c,
+	     cairo_fixed_t x1, int y1,
+	     cairo_fixed_t x2, int y2)
+{
+    int ex1, ex2, fx1, fx2;
+    int first, incr, delta, mod;
+    int dx, p;
+
+    ex1 = I(x1); fx1 = _cairo_fixed_fractional_part (x1);
+    ex2 = I(x2); fx2 = _cairo_fixed_fractional_part (x2);
+
+    if (y1 == y2)
+	return;
+
+    if (ex1 == ex2) {
+	delta = y2 - y1;
+	cell_add (c, ex1, delta, (fx1 + fx2) * delta);
+	return;
+    }
+
+    /* Step across the pixel columns, splitting the height between
+     * them by where the line crosses each column boundary. */
+    dx = x2 - x1;
+    p = (ONE_PIXEL - fx1) * (y2 - y1);
+    first = ONE_PIXEL;
+    incr = 1;
+    if (dx < 0) {
+	p = fx1 * (y2 - y1);
+	first = 0;
+	incr = -1;
+	dx = -dx;
+    }
+
+    delta = p / dx;
+    mod = p % dx;
+    if (mod < 0) {
+	delta--;
+	mod += dx;
+    }
+
+    cell_add (c, ex1, delta, (fx1 + first) * delta);
+    ex1 += incr;
+    y1 += delta;
+
+    if (ex1 != ex2) {
+	int lift, rem;
+
+	p = ONE_PIXEL * (y2 - y1 + delta);
+	lift = p / dx;
+	rem = p % dx;
+	if (rem < 0) {
+	    lift--;
+	    rem += dx;
+	}
+
+	mod -= dx;
+	do {
+	    delta = lift;
+	    mod += rem;
+	    if (mod >= 0) {
+		mod -= dx;
+		delta++;
+	    }
+
+	    cell_add (c, ex1, delta, ONE_PIXEL * delta);
+	    ex1 += incr;
+	    y1 += delta;
+	} while (ex1 != ex2);
+    }
+
+    delta = y2 - y1;
+    cell_add (c, ex2, delta, (fx2 + ONE_PIXEL - first) * delta);
+}
+
+#define INT_CMP(a, b) ((a) - (b))
+CAIRO_COMBSORT_DECLARE (sort_ints, int, INT_CMP)
+
+/* Fills in the part of the edge within the pixel row starting at top
+ * and advances the edge to the next row. */
+static void
+edge_row_segment (struct edge *e,
+		  cairo_fixed_t top,
+		  struct segment *seg)
+{
+    cairo_fixed_t bottom = top + ONE_PIXEL;
+
+    seg->edge = e;
+    seg->dir = e->dir;
+    seg->x1 = e->x.quo;
+    seg->y1 = e->y - top;
+    seg->state = 0;
+    seg->px = seg->x1;
+    seg->py = seg->y1;
+
+    if (e->ybot <= bottom) {
+	seg->x2 = e->xbot;
+	seg->y2 = e->ybot - top;
+	seg->more = FALSE;
+    } else {
+	if (! e->vertical) {
+	    if (seg->y1 == 0) {
+		e->x.quo += e->dxdy.quo;
+		e->x.rem += e->dxdy.rem;
+		if (e->x.rem >= e->dy) {
+		    ++e->x.quo;
+		    e->x.rem -= e->dy;
+		}
+	    } else
+		e->x = edge_x_at (e, bottom);
+	}
+	e->y = bottom;
+
+	seg->x2 = e->x.quo;
+	seg->y2 = ONE_PIXEL;
+	seg->more = TRUE;
+    }
+}
+
+static inline cairo_fixed_t
+segment_x_at (const struct segment *seg, cairo_fixed_t top, int y)
+{
+    if (y == seg->y1 || seg->edge->vertical)
+	return seg->x1;
+    if (y == seg->y2)
+	return seg->x2;
+    return edge_x_at (seg->edge, top + y).quo;
+}
+
+static inline cairo_bool_t
+segment_before (const struct segment *a, const struct segment *b)
+{
+    return a->top < b->top || (a->top == b->top && a->bottom < b->bottom);
+}
+
+/* Sorts the slab left to right along its top, and then its bottom.  It
+ * is nearly always in order already. */
+static void
+sort_slab (const struct segment *segments, int *slab, int n)
+{
+    int i, j;
+
+    for (i = 1; i < n; i++) {
+	int k = slab[i];
+
+	for (j = i; j > 0 && segment_before (&segments[k], &segments[slab[j-1]]); j--)
+	    slab[j] = slab[j-1];
+	slab[j] = k;
+    }
+}
+
+/* Whether the segment is on the boundary of the filled region, and
+ * if so which way round: 1 if the region is to its right when walked
+ * downwards, -1 if to its left. */
+static inline int
+segment_state (const struct segment *seg, unsigned int winding_mask)
+{
+    cairo_bool_t left = (seg->winding & winding_mask) != 0;
+    cairo_bool_t right = ((seg->winding + seg->dir) & winding_mask) != 0;
+
+    if (left == right)
+	return 0;
+    return left ? -1 : 1;
+}
+
+/* Accumulates the boundary the segment has traced since it last
+ * changed state, up to (x, y). */
+static inline void
+segment_flush (struct analytic_scan_converter *c,
+	       struct segment *seg,
+	       cairo_fixed_t x, int y)
+{
+    if (seg->state > 0)
+	render_line (c, seg->px, seg->py, x, y);
+    else if (seg->state < 0)
+	render_line (c, x, y, seg->px, seg->py);
+
+    seg->px = x;
+    seg->py = y;
+}
+
+static inline void
+segment_set_state (struct analytic_scan_converter *c,
+		   struct segment *seg,
+		   cairo_fixed_t top, int y,
+		   unsigned int winding_mask)
+{
+    int state = segment_state (seg, winding_mask);
+
+    if (state != seg->state) {
+	segment_flush (c, seg, segment_x_at (seg, top, y), y);
+	seg->state = state;
+    }
+}
+
+/* Where a crosses b, its right hand neighbour, no earlier than y;
+ * INT_MAX if they are in order at the bottom of the slab. */
+static inline int
+segment_cross (const struct segment *a,
+	       const struct segment *b,
+	       int y0, int y1, int y)
+{
+    int64_t d0, d1;
+    int yc;
+
+    if (a->bottom <= b->bottom)
+	return INT_MAX;
+
+    d0 = b->top - a->top;
+    d1 = a->bottom - b->bottom;
+    if (d0 <= 0)
+	return y;
+
+    yc = y0 + (int) ((y1 - y0) * d0 / (d0 + d1));
+    return yc < y ? y : yc;
+}
+
+/* Walks the slab between y0 and y1, between which none of the
+ * segments start or end, tracking which are on the boundary.  Each
+ * swap of a pair of neighbours puts one more pair in order at the
+ * bottom of the slab, so the walk ends. */
+static void
+render_slab (struct analytic_scan_converter *c,
+	     cairo_fixed_t top,
+	     int *slab, int n,
+	     int y0, int y1,
+	     unsigned int winding_mask)
+{
+    struct segment *segments = c->segments;
+    cairo_bool_t crossed = FALSE;
+    int i, j, winding = 0;
+
+    sort_slab (segments, slab, n);
+    for (i = 0; i < n; i++) {
+	struct segment *seg = &segments[slab[i]];
+	int state;
+
+	seg->winding = winding;
+	winding += seg->dir;
+
+	state = segment_state (seg, winding_mask);
+	if (state != seg->state) {
+	    segment_flush (c, seg, seg->top, y0);
+	    seg->state = state;
+	}
+
+	if (i + 1 < n) {
+	    seg->cross = segment_cross (seg, &segments[slab[i+1]],
+					y0, y1, y0);
+	    crossed |= seg->cross != INT_MAX;
+	}
+    }
+
+    while (crossed) {
+	struct segment *a, *b;
+	int y = y1;
+
+	j = -1;
+	for (i = 0; i + 1 < n; i++) {
+	    if (segments[slab[i]].cross < y) {
+		y = segments[slab[i]].cross;
+		j = i;
+	    }
+	}
+	if (j < 0)
+	    break;
+
+	a = &segments[slab[j]];
+	b = &segments[slab[j+1]];
+	slab[j] = b - segments;
+	slab[j+1] = a - segments;
+
+	b->winding = a->winding;
+	a->winding = b->winding + b->dir;
+	segment_set_state (c, a, top, y, winding_mask);
+	segment_set_state (c, b, top, y, winding_mask);
+
+	for (i = j > 0 ? j - 1 : 0; i + 1 < n && i <= j + 1; i++) {
+	    segments[slab[i]].cross = segment_cross (&segments[slab[i]],
+						     &segments[slab[i+1]],
+						     y0, y1, y);
+	}
+    }
+}
+
+/* Accumulates the row starting at top, advancing the active edges past
+ * it and dropping those that end within it. */
+static void
+render_row (struct analytic_scan_converter *c,
+	    cairo_fixed_t top,
+	    unsigned int winding_mask)
+{
+    struct segment *segments = c->segments;
+    int *order = c->order, *slab = c->slab, *events = c->events;
+    struct edge *e, *next;
+    int i, j, k, n, num_events;
+    cairo_bool_t ordered = TRUE;
+
+    n = 0;
+    num_events = 0;
+    events[num_events++] = 0;
+    for (e = c->head.next; e != &c->tail; e = e->next) {
+	struct segment *seg = &segments[n];
+
+	edge_row_segment (e, top, seg);
+	if (seg->y1 > 0)
+	    events[num_events++] = seg->y1;
+	if (seg->y2 < ONE_PIXEL)
+	    events[num_events++] = seg->y2;
+	if (n && (seg->x1 < seg[-1].x1 || seg->x2 < seg[-1].x2))
+	    ordered = FALSE;
+
+	order[n] = n;
+	n++;
+    }
+    events[num_events++] = ONE_PIXEL;
+
+    /* Most rows are a single slab already in order, in which case the
+     * winding number to the left of each edge is known straight away
+     * and the edges stay where they are. */
+    if (ordered && num_events == 2) {
+	int winding = 0;
+
+	for (i = 0, e = c->head.next; i < n; i++, e = next) {
+	    struct segment *seg = &segments[i];
+
+	    next = e->next;
+
+	    seg->winding = winding;
+	    winding += seg->dir;
+	    seg->state = segment_state (seg, winding_mask);
+	    segment_flush (c, seg, seg->x2, seg->y2);
+
+	    if (! seg->more) {
+		e->prev->next = next;
+		next->prev = e->prev;
+		c->num_sloped -= ! e->vertical;
+	    }
+	}
+	return;
+    }
+
+    if (num_events > 2)
+	sort_ints (events, num_events);
+
+    for (k = 0; k + 1 < num_events; k++) {
+	int y0 = events[k], y1 = events[k+1], m;
+
+	if (y0 == y1)
+	    continue;
+
+	m = 0;
+	for (i = 0; i < n; i++) {
+	    struct segment *seg = &segments[order[i]];
+
+	    if (seg->y1 <= y0 && seg->y2 >= y1) {
+		seg->top = segment_x_at (seg, top, y0);
+		seg->bottom = segment_x_at (seg, top, y1);
+		slab[m++] = order[i];
+	    }
+	}
+	if (m == 0)
+	    continue;
+
+	if (m == n) {
+	    render_slab (c, top, order, n, y0, y1, winding_mask);
+	    continue;
+	}
+
+	render_slab (c, top, slab, m, y0, y1, winding_mask);
+
+	/* Keep the order found, for the slabs below */
+	for (i = j = 0; i < n; i++) {
+	    struct segment *seg = &segments[order[i]];
+
+	    if (seg->y1 <= y0 && seg->y2 >= y1)
+		order[i] = slab[j++];
+	}
+    }
+
+    for (i = 0; i < n; i++)
+	segment_flush (c, &segments[i], segments[i].x2, segments[i].y2);
+
+    /* Relink the edges that carry on, left to right */
+    c->head.next = &c->tail;
+    c->tail.prev = &c->head;
+    c->num_sloped = 0;
+    for (i = 0; i < n; i++) {
+	struct segment *seg = &segments[order[i]];
+
+	if (! seg->more)
+	    continue;
+
+	e = seg->edge;
+	e->prev = c->tail.prev;
+	e->next = &c->tail;
+	c->tail.prev->next = e;
+	c->tail.prev = e;
+	c->num_sloped += ! e->vertical;
+    }
+}
+
+/* Maps an accumulated pixel value onto an alpha value.  Only the
+ * boundary of the filled region is accumulated, so the value is the
+ * covered area already, give or take rounding. */
+static inline int
+area_to_alpha (int area)
+{
+    if (area < 0)
+	area = 0;
+    else if (area > FULL_AREA)
+	area = FULL_AREA;
+
+    return (area * 255 + FULL_AREA/2) / FULL_AREA;
+}
+
+static inline void
+add_span (struct analytic_scan_converter *c, int x, int alpha, int *last)
+{
+    if (alpha != *last) {
+	c->spans[c->num_spans].x = x;
+	c->spans[c->num_spans].coverage = alpha;
+	c->num_spans++;
+	*last = alpha;
+    }
+}
+
+/* Turns the accumulation row into spans, clearing it as it goes. */
+static void
+sweep_row (struct analytic_scan_converter *c)
+{
+    int width = c->xmax - c->xmin;
+    int cover = c->left, last = 0, prev_x = 0;
+    int i, n;
+
+    c->num_spans = 0;
+    c->left = 0;
+
+    /* Walk every pixel if the row is busy, otherwise just the cells. */
+    n = c->num_cells;
+    if (n > 1 && n * 8 < width) {
+	sort_ints (c->cells, n);
+    } else if (n > 1) {
+	n = 0;
+	for (i = 0; i < width; i++)
+	    if (c->touched[i])
+		c->cells[n++] = i;
+    }
+
+    for (i = 0; i < n; i++) {
+	int x = c->cells[i];
+
+	if (x > prev_x)
+	    add_span (c, c->xmin + prev_x,
+		      area_to_alpha (cover * 2*ONE_PIXEL),
+		      &last);
+
+	cover += c->cover[x];
+	add_span (c, c->xmin + x,
+		  area_to_alpha (cover * 2*ONE_PIXEL - c->area[x]),
+		  &last);
+
+	c->cover[x] = 0;
+	c->area[x] = 0;
+	c->touched[x] = 0;
+	prev_x = x + 1;
+    }
+    c->num_cells = 0;
+
+    if (prev_x < width)
+	add_span (c, c->xmin + prev_x,
+		  area_to_alpha (cover * 2*ONE_PIXEL),
+		  &last);
+    if (last)
+	add_span (c, c->xmax, 0, &last);
+}
+
+/* If every active edge is vertical and spans whole rows, the rows
+ * until the next edge starts or ends are identical.  Returns how many
+ * rows can be emitted at once. */
+static int
+vertical_run (struct analytic_scan_converter *c, int i, int h)
+{
+    cairo_fixed_t top = _cairo_fixed_from_int (c->ymin + i);
+    struct polygon *polygon = c->polygon;
+    struct edge *e;
+    int n = h - i, rows;
+
+    for (e = c->head.next; e != &c->tail; e = e->next) {
+	if (e->y != top)
+	    return 1;
+
+	rows = (e->ybot - top) >> PIXEL_BITS;
+	if (rows < n)
+	    n = rows;
+    }
+
+    for (rows = 1; rows < n && polygon->y_buckets[i + rows] == NULL; rows++)
+	;
+    return rows;
+}
+
+static cairo_status_t
+analytic_scan_converter_render (struct analytic_scan_converter *c,
+				unsigned int winding_mask,
+				cairo_span_renderer_t *renderer)
+{
+    struct polygon *polygon = c->polygon;
+    int i, j, h = c->ymax - c->ymin;
+    cairo_status_t status;
+
+    for (i = 0; i < h; i = j) {
+	cairo_fixed_t top = _cairo_fixed_from_int (c->ymin + i);
+	struct edge *e, *next;
+
+	j = i + 1;
+
+	for (e = polygon->y_buckets[i]; e != NULL; e = next) {
+	    next = e->next;
+	    e->prev = &c->head;
+	    e->next = c->head.next;
+	    c->head.next->prev = e;
+	    c->head.next = e;
+	    c->num_sloped += ! e->vertical;
+	}
+
+	if (c->head.next == &c->tail) {
+	    while (j < h && polygon->y_buckets[j] == NULL)
+		j++;
+	    continue;
+	}
+
+	if (c->num_sloped == 0)
+	    j = i + vertical_run (c, i, h);
+
+	render_row (c, top, winding_mask);
+
+	if (j != i + 1) {
+	    cairo_fixed_t y = _cairo_fixed_from_int (c->ymin + j);
+
+	    for (e = c->head.next; e != &c->tail; e = next) {
+		next = e->next;
+		e->y = y;
+		if (e->ybot <= y) {
+		    e->prev->next = next;
+		    next->prev = e->prev;
+		}
+	    }
+	}
+
+	sweep_row (c);
+	if (c->num_spans) {
+	    status = renderer->render_rows (renderer, c->ymin+i, j-i,
+					    c->spans, c->num_spans);
+	    if (unlikely (status))
+		return status;
+	}
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_analytic_scan_converter_init (struct analytic_scan_converter *c,
+			       int xmin, int ymin,
+			       int xmax, int ymax)
+{
+    cairo_status_t status;
+    int width = xmax - xmin;
+    int max_num_spans;
+    char *data;
+
+    status = polygon_init (c->polygon, ymin, ymax);
+    if (unlikely (status))
+	return status;
+
+    c->spans = c->spans_embedded;
+    c->row_data = NULL;
+    c->segments = NULL;
+
+    max_num_spans = width + 1;
+    if (max_num_spans > ARRAY_LENGTH(c->spans_embedded)) {
+	c->spans = _cairo_malloc_ab (max_num_spans,
+				     sizeof (cairo_half_open_span_t));
+	if (unlikely (c->spans == NULL))
+	    goto bail;
+    }
+
+    /* cover, area and cells are ints, followed by the touched bytes */
+    data = _cairo_malloc_ab (width + 1, 3 * sizeof (int32_t) + 1);
+    if (unlikely (data == NULL))
+	goto bail;
+    memset (data, 0, (width + 1) * (3 * sizeof (int32_t) + 1));
+
+    c->row_data = data;
+    c->cover = (int32_t *) data;
+    c->area = c->cover + width + 1;
+    c->cells = (int *) (c->area + width + 1);
+    c->touched = (uint8_t *) (c->cells + width + 1);
+    c->num_cells = 0;
+    c->left = 0;
+
+    c->xmin = xmin;
+    c->xmax = xmax;
+    c->ymin = ymin;
+    c->ymax = ymax;
+
+    c->head.prev = NULL;
+    c->head.next = &c->tail;
+    c->tail.prev = &c->head;
+    c->tail.next = NULL;
+    c->num_sloped = 0;
+
+    return CAIRO_STATUS_SUCCESS;
+
+bail:
+    if (c->spans != c->spans_embedded)
+	free (c->spans);
+    polygon_fini (c->polygon);
+    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+}
+
+static void
+_analytic_scan_converter_fini (struct analytic_scan_converter *self)
+{
+    if (self->spans != self->spans_embedded)
+	free (self->spans);
+
+    free (self->row_data);
+    free (self->segments);
+    polygon_fini (self->polygon);
+}
+
+static cairo_status_t
+analytic_scan_converter_allocate_edges (struct analytic_scan_converter *c,
+					int num_edges)
+{
+    c->polygon->num_edges = 0;
+    c->polygon->edges = c->polygon->edges_embedded;
+    if (num_edges > ARRAY_LENGTH (c->polygon->edges_embedded)) {
+	c->polygon->edges = _cairo_malloc_ab (num_edges, sizeof (struct edge));
+	if (unlikely (c->polygon->edges == NULL))
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    }
+
+    /* A segment, two indices and two events per edge, plus the events
+     * at the top and bottom of the row */
+    c->segments = _cairo_malloc_ab_plus_c (num_edges,
+					   sizeof (struct segment) + 4 * sizeof (int),
+					   2 * sizeof (int));
+    if (unlikely (c->segments == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    c->order = (int *) (c->segments + num_edges);
+    c->slab = c->order + num_edges;
+    c->events = c->slab + num_edges;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+struct _cairo_analytic_scan_converter {
+    cairo_scan_converter_t base;
+
+    struct analytic_scan_converter converter[1];
+    cairo_fill_rule_t fill_rule;
+};
+
+typedef struct _cairo_analytic_scan_converter cairo_analytic_scan_converter_t;
+
+static void
+_cairo_analytic_scan_converter_destroy (void *converter)
+{
+    cairo_analytic_scan_converter_t *self = converter;
+    _analytic_scan_converter_fini (self->converter);
+    free(self);
+}
+
+cairo_status_t
+_cairo_analytic_scan_converter_add_polygon (void		*converter,
+					    const cairo_polygon_t *polygon)
+{
+    cairo_analytic_scan_converter_t *self = converter;
+    cairo_status_t status;
+    int i;
+
+    status = analytic_scan_converter_allocate_edges (self->converter,
+						     polygon->num_edges);
+    if (unlikely (status))
+	return status;
+
+    for (i = 0; i < polygon->num_edges; i++)
+	polygon_add_edge (self->converter->polygon, &polygon->edges[i]);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_cairo_analytic_scan_converter_generate (void			*converter,
+					 cairo_span_renderer_t	*renderer)
+{
+    cairo_analytic_scan_converter_t *self = converter;
+
+    return analytic_scan_converter_render (self->converter,
+					   self->fill_rule == CAIRO_FILL_RULE_WINDING ? ~0 : 1,
+					   renderer);
+}
+
+cairo_scan_converter_t *
+_cairo_analytic_scan_converter_create (int			xmin,
+				       int			ymin,
+				       int			xmax,
+				       int			ymax,
+				       cairo_fill_rule_t	fill_rule)
+{
+    cairo_analytic_scan_converter_t *self;
+    cairo_status_t status;
+
+    self = malloc (sizeof(struct _cairo_analytic_scan_converter));
+    if (unlikely (self == NULL)) {
+	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	goto bail_nomem;
+    }
+
+    self->base.destroy = _cairo_analytic_scan_converter_destroy;
+    self->base.generate = _cairo_analytic_scan_converter_generate;
+
+    status = _analytic_scan_converter_init (self->converter,
+					    xmin, ymin, xmax, ymax);
+    if (unlikely (status)) {
+	free (self);
+	goto bail_nomem;
+    }
+
+    self->fill_rule = fill_rule;
+
+    return &self->base;
+
+ bail_nomem:
+    return _cairo_scan_converter_create_in_error (status);
+}
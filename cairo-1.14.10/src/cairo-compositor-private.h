@@ -178,6 +178,11 @@ struct cairo_mask_compositor {
 struct cairo_traps_compositor {
     cairo_compositor_t base;
 
+    unsigned int flags;
+/* composite_glyphs() is called without the scaled font frozen, and
+ * freezes it itself only when it has to fetch a glyph from the font. */
+#define CAIRO_TRAPS_COMPOSITOR_GLYPHS_UNFROZEN 0x1
+
     cairo_int_status_t
 	(*acquire) (void *surface);
 
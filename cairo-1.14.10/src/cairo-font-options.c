@@ -55,7 +55,8 @@ static const cairo_font_options_t _cairo_font_options_nil = {
     CAIRO_LCD_FILTER_DEFAULT,
     CAIRO_HINT_STYLE_DEFAULT,
     CAIRO_HINT_METRICS_DEFAULT,
-    CAIRO_ROUND_GLYPH_POS_DEFAULT
+    CAIRO_ROUND_GLYPH_POS_DEFAULT,
+    0
 };
 
 /**
@@ -73,6 +74,7 @@ _cairo_font_options_init_default (cairo_font_options_t *options)
     options->hint_style = CAIRO_HINT_STYLE_DEFAULT;
     options->hint_metrics = CAIRO_HINT_METRICS_DEFAULT;
     options->round_glyph_positions = CAIRO_ROUND_GLYPH_POS_DEFAULT;
+    options->subpixel_positions = 0;
 }
 
 void
@@ -85,6 +87,7 @@ _cairo_font_options_init_copy (cairo_font_options_t		*options,
     options->hint_style = other->hint_style;
     options->hint_metrics = other->hint_metrics;
     options->round_glyph_positions = other->round_glyph_positions;
+    options->subpixel_positions = other->subpixel_positions;
 }
 
 /**
@@ -226,6 +229,8 @@ cairo_font_options_merge (cairo_font_options_t       *options,
 	options->hint_metrics = other->hint_metrics;
     if (other->round_glyph_positions != CAIRO_ROUND_GLYPH_POS_DEFAULT)
 	options->round_glyph_positions = other->round_glyph_positions;
+    if (other->subpixel_positions != 0)
+	options->subpixel_positions = other->subpixel_positions;
 }
 slim_hidden_def (cairo_font_options_merge);
 
@@ -259,7 +264,8 @@ cairo_font_options_equal (const cairo_font_options_t *options,
 	    options->lcd_filter == other->lcd_filter &&
 	    options->hint_style == other->hint_style &&
 	    options->hint_metrics == other->hint_metrics &&
-	    options->round_glyph_positions == other->round_glyph_positions);
+	    options->round_glyph_positions == other->round_glyph_positions &&
+	    options->subpixel_positions == other->subpixel_positions);
 }
 slim_hidden_def (cairo_font_options_equal);
 
@@ -287,7 +293,8 @@ cairo_font_options_hash (const cairo_font_options_t *options)
 	    (options->subpixel_order << 4) |
 	    (options->lcd_filter << 8) |
 	    (options->hint_style << 12) |
-	    (options->hint_metrics << 16));
+	    (options->hint_metrics << 16) |
+	    (options->subpixel_positions << 20));
 }
 slim_hidden_def (cairo_font_options_hash);
 
@@ -533,3 +540,53 @@ cairo_font_options_get_hint_metrics (const cairo_font_options_t *options)
 
     return options->hint_metrics;
 }
+
+/**
+ * cairo_font_options_set_subpixel_positions:
+ * @options: a #cairo_font_options_t
+ * @positions: the number of horizontal positions within a pixel
+ *
+ * Sets the number of horizontal subpixel positions glyphs are rendered
+ * at by raster backends. Glyphs are normally placed on whole device
+ * pixels; with 2 or 4 positions each glyph is cached once for every
+ * position it is drawn at, so that slowly moving text does not jump by
+ * whole pixels. Values other than 0, 2 and 4 turn subpixel positioning
+ * off. 0, the default, leaves the option unset: options merged over it
+ * with cairo_font_options_merge() may set it, and if none do glyphs stay
+ * on whole pixels.
+ *
+ * Since: 1.14.12
+ **/
+void
+cairo_font_options_set_subpixel_positions (cairo_font_options_t *options,
+					   int                   positions)
+{
+    if (cairo_font_options_status (options))
+	return;
+
+    if (positions != 0 && positions != 2 && positions != 4)
+	positions = 1;
+
+    options->subpixel_positions = positions;
+}
+
+/**
+ * cairo_font_options_get_subpixel_positions:
+ * @options: a #cairo_font_options_t
+ *
+ * Gets the number of horizontal subpixel positions for the font
+ * options object. See cairo_font_options_set_subpixel_positions().
+ *
+ * Return value: the number of positions, 1 if subpixel positioning is
+ * off or 0 if it has not been set
+ *
+ * Since: 1.14.12
+ **/
+int
+cairo_font_options_get_subpixel_positions (const cairo_font_options_t *options)
+{
+    if (cairo_font_options_status ((cairo_font_options_t *) options))
+	return 0;
+
+    return options->subpixel_positions;
+}
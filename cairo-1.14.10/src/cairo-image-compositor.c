@@ -809,30 +809,90 @@ check_composite_glyphs (const cairo_composite_rectangles_t *extents,
 }
 
 #if HAS_PIXMAN_GLYPHS
-static pixman_glyph_cache_t *global_glyph_cache;
+/* Rather than one pixman glyph cache behind one lock for the whole
+ * process, there are a few shared caches with a lock each, and a thread
+ * picks one by hashing its identity. The slots are not per-thread: two
+ * threads that hash alike share a slot and take turns on its lock.
+ *
+ * Glyphs found in the slot are composited without touching the scaled
+ * font at all (the traps compositor does not freeze it for us, see
+ * CAIRO_TRAPS_COMPOSITOR_GLYPHS_UNFROZEN), so threads sharing a font do
+ * not serialise on its mutex once their slot is warm. Only a miss
+ * freezes the font, to fetch the glyph from the font's own cache.
+ *
+ * Lock order is font before slot, as glyph eviction calls
+ * _cairo_image_scaled_glyph_fini() with the font locked; so the slot is
+ * always dropped before the font is frozen, and the font is thawed only
+ * after the slot is released.
+ */
+#define GLYPH_CACHE_SLOT_BITS 3
+#define GLYPH_CACHE_SLOTS (1 << GLYPH_CACHE_SLOT_BITS)
+
+typedef struct _glyph_cache_slot {
+    cairo_mutex_t mutex;
+    pixman_glyph_cache_t *cache;
+} glyph_cache_slot_t;
+
+static glyph_cache_slot_t *glyph_cache_slots[GLYPH_CACHE_SLOTS];
+
+static inline unsigned int
+current_glyph_cache_slot (void)
+{
+    uintptr_t id = _cairo_thread_self ();
+    uint32_t hash;
 
-static inline pixman_glyph_cache_t *
-get_glyph_cache (void)
+    /* Thread handles are usually addresses a page or a stack apart, so
+     * take the slot from the top bits of a multiplicative hash. */
+    hash = (uint32_t) id;
+    if (sizeof (id) > sizeof (hash))
+	hash ^= (uint32_t) (id >> 16 >> 16);
+    return (hash * 2654435761u) >> (32 - GLYPH_CACHE_SLOT_BITS);
+}
+
+static glyph_cache_slot_t *
+get_glyph_cache_slot (void)
 {
-    if (!global_glyph_cache)
-	global_glyph_cache = pixman_glyph_cache_create ();
+    glyph_cache_slot_t **slot = &glyph_cache_slots[current_glyph_cache_slot ()];
+    glyph_cache_slot_t *new_slot;
+
+    if (likely (_cairo_atomic_ptr_get (slot) != NULL))
+	return *slot;
+
+    CAIRO_MUTEX_LOCK (_cairo_glyph_cache_mutex);
+    if (*slot == NULL) {
+	new_slot = malloc (sizeof (glyph_cache_slot_t));
+	if (likely (new_slot != NULL)) {
+	    new_slot->cache = pixman_glyph_cache_create ();
+	    if (likely (new_slot->cache != NULL)) {
+		CAIRO_MUTEX_INIT (new_slot->mutex);
+		_cairo_atomic_ptr_cmpxchg (slot, NULL, new_slot);
+	    } else {
+		free (new_slot);
+	    }
+	}
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_glyph_cache_mutex);
 
-    return global_glyph_cache;
+    return *slot;
 }
 
 void
 _cairo_image_scaled_glyph_fini (cairo_scaled_font_t *scaled_font,
 				cairo_scaled_glyph_t *scaled_glyph)
 {
-    CAIRO_MUTEX_LOCK (_cairo_glyph_cache_mutex);
+    int n;
 
-    if (global_glyph_cache) {
-	pixman_glyph_cache_remove (
-	    global_glyph_cache, scaled_font,
-	    (void *)_cairo_scaled_glyph_index (scaled_glyph));
-    }
+    for (n = 0; n < GLYPH_CACHE_SLOTS; n++) {
+	glyph_cache_slot_t *slot = _cairo_atomic_ptr_get (&glyph_cache_slots[n]);
 
-    CAIRO_MUTEX_UNLOCK (_cairo_glyph_cache_mutex);
+	if (slot == NULL)
+	    continue;
+
+	CAIRO_MUTEX_LOCK (slot->mutex);
+	pixman_glyph_cache_remove (slot->cache, scaled_font,
+				   (void *)_cairo_scaled_glyph_key (scaled_glyph));
+	CAIRO_MUTEX_UNLOCK (slot->mutex);
+    }
 }
 
 static cairo_int_status_t
@@ -846,22 +906,23 @@ composite_glyphs (void				*_dst,
 		  cairo_composite_glyphs_info_t *info)
 {
     cairo_int_status_t status = CAIRO_INT_STATUS_SUCCESS;
+    glyph_cache_slot_t *slot;
     pixman_glyph_cache_t *glyph_cache;
     pixman_glyph_t pglyphs_stack[CAIRO_STACK_ARRAY_LENGTH (pixman_glyph_t)];
     pixman_glyph_t *pglyphs = pglyphs_stack;
     pixman_glyph_t *pg;
+    cairo_bool_t font_frozen = FALSE;
     int i;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
-    CAIRO_MUTEX_LOCK (_cairo_glyph_cache_mutex);
+    slot = get_glyph_cache_slot ();
+    if (unlikely (slot == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    glyph_cache = get_glyph_cache();
-    if (unlikely (glyph_cache == NULL)) {
-	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	goto out_unlock;
-    }
+    CAIRO_MUTEX_LOCK (slot->mutex);
 
+    glyph_cache = slot->cache;
     pixman_glyph_cache_freeze (glyph_cache);
 
     if (info->num_glyphs > ARRAY_LENGTH (pglyphs_stack)) {
@@ -874,22 +935,32 @@ composite_glyphs (void				*_dst,
 
     pg = pglyphs;
     for (i = 0; i < info->num_glyphs; i++) {
-	unsigned long index = info->glyphs[i].index;
+	double x = info->glyphs[i].x;
+	unsigned long index;
 	const void *glyph;
 
+	index = _cairo_scaled_font_glyph_phase_index (info->font,
+						      info->glyphs[i].index,
+						      &x);
+
 	glyph = pixman_glyph_cache_lookup (glyph_cache, info->font, (void *)index);
 	if (!glyph) {
 	    cairo_scaled_glyph_t *scaled_glyph;
 	    cairo_image_surface_t *glyph_surface;
 
 	    /* This call can actually end up recursing, so we have to
-	     * drop the mutex around it.
+	     * drop the mutex around it; the font is frozen from here on
+	     * so that the glyph outlives its insertion into the slot.
 	     */
-	    CAIRO_MUTEX_UNLOCK (_cairo_glyph_cache_mutex);
+	    CAIRO_MUTEX_UNLOCK (slot->mutex);
+	    if (! font_frozen) {
+		_cairo_scaled_font_freeze_cache (info->font);
+		font_frozen = TRUE;
+	    }
 	    status = _cairo_scaled_glyph_lookup (info->font, index,
 						 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 						 &scaled_glyph);
-	    CAIRO_MUTEX_LOCK (_cairo_glyph_cache_mutex);
+	    CAIRO_MUTEX_LOCK (slot->mutex);
 
 	    if (unlikely (status))
 		goto out_thaw;
@@ -905,7 +976,7 @@ composite_glyphs (void				*_dst,
 	    }
 	}
 
-	pg->x = _cairo_lround (info->glyphs[i].x);
+	pg->x = _cairo_lround (x);
 	pg->y = _cairo_lround (info->glyphs[i].y);
 	pg->glyph = glyph;
 	pg++;
@@ -940,8 +1011,11 @@ out_thaw:
     if (pglyphs != pglyphs_stack)
 	free(pglyphs);
 
-out_unlock:
-    CAIRO_MUTEX_UNLOCK (_cairo_glyph_cache_mutex);
+    CAIRO_MUTEX_UNLOCK (slot->mutex);
+
+    if (font_frozen)
+	_cairo_scaled_font_thaw_cache (info->font);
+
     return status;
 }
 #else
@@ -964,12 +1038,19 @@ composite_one_glyph (void				*_dst,
     cairo_image_surface_t *glyph_surface;
     cairo_scaled_glyph_t *scaled_glyph;
     cairo_status_t status;
+    unsigned long glyph_index;
+    double glyph_x;
     int x, y;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
+    glyph_x = info->glyphs[0].x;
+    glyph_index = _cairo_scaled_font_glyph_phase_index (info->font,
+							info->glyphs[0].index,
+							&glyph_x);
+
     status = _cairo_scaled_glyph_lookup (info->font,
-					 info->glyphs[0].index,
+					 glyph_index,
 					 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 					 &scaled_glyph);
 
@@ -982,7 +1063,7 @@ composite_one_glyph (void				*_dst,
 
     /* round glyph locations to the nearest pixel */
     /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-    x = _cairo_lround (info->glyphs[0].x -
+    x = _cairo_lround (glyph_x -
 		       glyph_surface->base.device_transform.x0);
     y = _cairo_lround (info->glyphs[0].y -
 		       glyph_surface->base.device_transform.y0);
@@ -1017,6 +1098,8 @@ composite_glyphs_via_mask (void				*_dst,
     pixman_image_t *mask;
     pixman_format_code_t format;
     cairo_status_t status;
+    unsigned long glyph_index;
+    double glyph_x;
     int i;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -1030,8 +1113,13 @@ composite_glyphs_via_mask (void				*_dst,
      * mask formats.
      */
 
+    glyph_x = info->glyphs[0].x;
+    glyph_index = _cairo_scaled_font_glyph_phase_index (info->font,
+							info->glyphs[0].index,
+							&glyph_x);
+
     status = _cairo_scaled_glyph_lookup (info->font,
-					 info->glyphs[0].index,
+					 glyph_index,
 					 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 					 &scaled_glyph);
     if (unlikely (status)) {
@@ -1040,7 +1128,7 @@ composite_glyphs_via_mask (void				*_dst,
     }
 
     memset (glyph_cache, 0, sizeof (glyph_cache));
-    glyph_cache[info->glyphs[0].index % ARRAY_LENGTH (glyph_cache)] = scaled_glyph;
+    glyph_cache[glyph_index % ARRAY_LENGTH (glyph_cache)] = scaled_glyph;
 
     format = PIXMAN_a8;
     i = (info->extents.width + 3) & ~3;
@@ -1068,14 +1156,19 @@ composite_glyphs_via_mask (void				*_dst,
 
     status = CAIRO_STATUS_SUCCESS;
     for (i = 0; i < info->num_glyphs; i++) {
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 	cairo_image_surface_t *glyph_surface;
+	int cache_index;
 	int x, y;
 
+	glyph_x = info->glyphs[i].x;
+	glyph_index = _cairo_scaled_font_glyph_phase_index (info->font,
+							    info->glyphs[i].index,
+							    &glyph_x);
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
-	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
+	    _cairo_scaled_glyph_key (scaled_glyph) != glyph_index)
 	{
 	    status = _cairo_scaled_glyph_lookup (info->font, glyph_index,
 						 CAIRO_SCALED_GLYPH_INFO_SURFACE,
@@ -1120,7 +1213,7 @@ composite_glyphs_via_mask (void				*_dst,
 
 	    /* round glyph locations to the nearest pixel */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
+	    x = _cairo_lround (glyph_x -
 			       glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
@@ -1196,12 +1289,18 @@ composite_glyphs (void				*_dst,
 	int x, y;
 	cairo_image_surface_t *glyph_surface;
 	cairo_scaled_glyph_t *scaled_glyph;
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	double glyph_x = info->glyphs[i].x;
+	unsigned long glyph_index;
+	int cache_index;
+
+	glyph_index = _cairo_scaled_font_glyph_phase_index (info->font,
+							    info->glyphs[i].index,
+							    &glyph_x);
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
-	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
+	    _cairo_scaled_glyph_key (scaled_glyph) != glyph_index)
 	{
 	    status = _cairo_scaled_glyph_lookup (info->font, glyph_index,
 						 CAIRO_SCALED_GLYPH_INFO_SURFACE,
@@ -1217,7 +1316,7 @@ composite_glyphs (void				*_dst,
 	if (glyph_surface->width && glyph_surface->height) {
 	    /* round glyph locations to the nearest pixel */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
+	    x = _cairo_lround (glyph_x -
 			       glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
@@ -1269,6 +1368,9 @@ _cairo_image_traps_compositor_get (void)
 #endif
 	compositor.check_composite_glyphs = check_composite_glyphs;
 	compositor.composite_glyphs = composite_glyphs;
+#if HAS_PIXMAN_GLYPHS
+	compositor.flags |= CAIRO_TRAPS_COMPOSITOR_GLYPHS_UNFROZEN;
+#endif
     }
 
     return &compositor.base;
@@ -1573,6 +1675,7 @@ typedef struct _cairo_image_span_renderer {
     int bpp;
 
     pixman_image_t *src, *mask;
+    pixman_image_t *band_dst;
     union {
 	struct fill {
 	    int stride;
@@ -2957,6 +3060,7 @@ span_renderer_init (cairo_abstract_span_renderer_t	*_r,
     r->composite = composite;
     r->mask = NULL;
     r->src = NULL;
+    r->band_dst = NULL;
     r->base.finish = NULL;
 
     status = mono_renderer_init (r, composite, antialias, needs_clip);
@@ -3069,6 +3173,53 @@ span_renderer_init (cairo_abstract_span_renderer_t	*_r,
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Whether the rows are composited by pixman as they are rendered, onto
+ * r->u.composite.dst, rather than written directly or gathered into a
+ * mask for compositing at the end. */
+static cairo_bool_t
+span_renderer_composites_rows (const cairo_image_span_renderer_t *r)
+{
+    return r->base.render_rows == _mono_spans ||
+	   r->base.render_rows == _mono_unbounded_spans ||
+	   r->base.render_rows == _inplace_spans ||
+	   r->base.render_rows == _inplace_opacity_spans ||
+	   r->base.render_rows == _inplace_src_spans ||
+	   r->base.render_rows == _inplace_src_opacity_spans;
+}
+
+static cairo_int_status_t
+span_renderer_band_init (cairo_abstract_span_renderer_t *_r)
+{
+    cairo_image_span_renderer_t *r = (cairo_image_span_renderer_t *) _r;
+    cairo_image_surface_t *dst = (cairo_image_surface_t *) r->composite->surface;
+    pixman_image_t *image;
+
+    TRACE ((stderr, "%s\n", __FUNCTION__));
+
+    if (! span_renderer_composites_rows (r))
+	return CAIRO_INT_STATUS_SUCCESS;
+
+    /* pixman updates an image's cached state the first time it is used
+     * after a change, so no two threads may composite onto the same
+     * image. Give the band a destination image of its own over the same
+     * pixels... */
+    image = pixman_image_create_bits (dst->pixman_format,
+				      dst->width, dst->height,
+				      (uint32_t *) dst->data, dst->stride);
+    if (unlikely (image == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    r->u.composite.dst = r->band_dst = image;
+
+    /* ...and bring the source, which may be shared with the other bands
+     * through the pattern caches, up to date here while there is still
+     * only the one thread; an empty composite does just that. */
+    pixman_image_composite32 (PIXMAN_OP_DST, r->src, r->mask, image,
+			      0, 0, 0, 0, 0, 0, 0, 0);
+
+    return CAIRO_INT_STATUS_SUCCESS;
+}
+
 static void
 span_renderer_fini (cairo_abstract_span_renderer_t *_r,
 		    cairo_int_status_t status)
@@ -3081,6 +3232,8 @@ span_renderer_fini (cairo_abstract_span_renderer_t *_r,
 	if (r->base.finish)
 	    r->base.finish (r);
     }
+    if (r->band_dst)
+	pixman_image_unref (r->band_dst);
     if (likely (status == CAIRO_INT_STATUS_SUCCESS && r->bpp == 0)) {
 	const cairo_composite_rectangles_t *composite = r->composite;
 
@@ -3119,6 +3272,10 @@ _cairo_image_spans_compositor_get (void)
 #if PIXMAN_HAS_OP_LERP
 	spans.flags |= CAIRO_SPANS_COMPOSITOR_HAS_LERP;
 #endif
+#if ! PIXMAN_HAS_COMPOSITOR
+	spans.flags |= CAIRO_SPANS_COMPOSITOR_HAS_BANDS;
+	spans.renderer_band_init = span_renderer_band_init;
+#endif
 
 	//spans.acquire = acquire;
 	//spans.release = release;
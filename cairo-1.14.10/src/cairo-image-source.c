@@ -61,6 +61,48 @@
 #define PIXMAN_HAS_ATOMIC_OPS 1
 #endif
 
+/* The same gradient is often drawn many times over, for instance the
+ * face of every button in a toolbar. Keep the last few prepared pixman
+ * gradient images, keyed by everything that goes into them: the stops, the
+ * geometry after it has been fitted into range, the transform left after
+ * the integer offset is split off, and the extend mode.
+ *
+ * pixman does not count references atomically, so unlike the solid colours
+ * an image is only ever handed back to the thread that created it, and only
+ * that thread may drop a reference to it. Any thread may evict any entry;
+ * an image evicted by another thread is parked on the orphan list and
+ * released by its owner the next time it looks in the cache. Orphans left
+ * by threads that have since exited are released when a thread that comes
+ * to carry the same id looks in, or at _cairo_image_reset_static_data().
+ */
+typedef struct _cairo_image_gradient_key {
+    unsigned long hash;
+    uintptr_t owner;
+    cairo_pattern_type_t type;
+    cairo_extend_t extend;
+    pixman_point_fixed_t p1, p2;
+    pixman_fixed_t r1, r2;
+    cairo_bool_t has_transform;
+    pixman_transform_t transform;
+    unsigned int n_stops;
+} cairo_image_gradient_key_t;
+
+static struct {
+    cairo_image_gradient_key_t key;
+    pixman_gradient_stop_t *stops;
+    pixman_image_t *image;
+} gradient_cache[32];
+static unsigned int n_gradients_cached;
+static unsigned int gradient_cache_hand;
+
+typedef struct _cairo_image_gradient_orphan {
+    struct _cairo_image_gradient_orphan *next;
+    uintptr_t owner;
+    pixman_image_t *image;
+} cairo_image_gradient_orphan_t;
+
+static cairo_image_gradient_orphan_t *gradient_orphans;
+
 #if PIXMAN_HAS_ATOMIC_OPS
 static pixman_image_t *__pixman_transparent_image;
 static pixman_image_t *__pixman_black_image;
@@ -267,6 +309,21 @@ UNLOCK:
 void
 _cairo_image_reset_static_data (void)
 {
+    while (n_gradients_cached) {
+	n_gradients_cached--;
+	pixman_image_unref (gradient_cache[n_gradients_cached].image);
+	free (gradient_cache[n_gradients_cached].stops);
+    }
+    gradient_cache_hand = 0;
+
+    while (gradient_orphans) {
+	cairo_image_gradient_orphan_t *orphan = gradient_orphans;
+
+	gradient_orphans = orphan->next;
+	pixman_image_unref (orphan->image);
+	free (orphan);
+    }
+
 #if PIXMAN_HAS_ATOMIC_OPS
     while (n_cached)
 	pixman_image_unref (cache[--n_cached].image);
@@ -288,30 +345,137 @@ _cairo_image_reset_static_data (void)
 #endif
 }
 
+/* Called with the cache mutex held. */
+static void
+_gradient_cache_release_orphans (uintptr_t owner)
+{
+    cairo_image_gradient_orphan_t **prev = &gradient_orphans;
+
+    while (*prev) {
+	cairo_image_gradient_orphan_t *orphan = *prev;
+
+	if (orphan->owner == owner) {
+	    *prev = orphan->next;
+	    pixman_image_unref (orphan->image);
+	    free (orphan);
+	} else {
+	    prev = &orphan->next;
+	}
+    }
+}
+
+static cairo_bool_t
+_gradient_cache_entry_equal (unsigned int i,
+			     const cairo_image_gradient_key_t *key,
+			     const cairo_gradient_pattern_t *pattern)
+{
+    const cairo_image_gradient_key_t *a = &gradient_cache[i].key;
+    const pixman_gradient_stop_t *stops = gradient_cache[i].stops;
+    unsigned int n;
+
+    if (a->hash != key->hash ||
+	a->owner != key->owner ||
+	a->type != key->type ||
+	a->extend != key->extend ||
+	a->n_stops != key->n_stops ||
+	a->has_transform != key->has_transform)
+	return FALSE;
+
+    if (memcmp (&a->p1, &key->p1, sizeof (key->p1)) ||
+	memcmp (&a->p2, &key->p2, sizeof (key->p2)) ||
+	a->r1 != key->r1 || a->r2 != key->r2)
+	return FALSE;
+
+    if (key->has_transform &&
+	memcmp (&a->transform, &key->transform, sizeof (key->transform)))
+	return FALSE;
+
+    for (n = 0; n < key->n_stops; n++) {
+	const cairo_gradient_stop_t *stop = &pattern->stops[n];
+
+	if (stops[n].x != _cairo_fixed_16_16_from_double (stop->offset) ||
+	    stops[n].color.red   != stop->color.red_short ||
+	    stops[n].color.green != stop->color.green_short ||
+	    stops[n].color.blue  != stop->color.blue_short ||
+	    stops[n].color.alpha != stop->color.alpha_short)
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
 static pixman_image_t *
 _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
 			    const cairo_rectangle_int_t *extents,
 			    int *ix, int *iy)
 {
     pixman_image_t	  *pixman_image;
-    pixman_gradient_stop_t pixman_stops_static[2];
-    pixman_gradient_stop_t *pixman_stops = pixman_stops_static;
-    pixman_transform_t      pixman_transform;
+    pixman_gradient_stop_t *pixman_stops;
+    cairo_image_gradient_key_t key;
     cairo_matrix_t matrix;
     cairo_circle_double_t extremes[2];
-    pixman_point_fixed_t p1, p2;
     unsigned int i;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
-    if (pattern->n_stops > ARRAY_LENGTH(pixman_stops_static)) {
-	pixman_stops = _cairo_malloc_ab (pattern->n_stops,
-					 sizeof(pixman_gradient_stop_t));
-	if (unlikely (pixman_stops == NULL))
-	    return NULL;
+    _cairo_gradient_pattern_fit_to_range (pattern, PIXMAN_MAX_INT >> 1, &matrix, extremes);
+
+    memset (&key, 0, sizeof (key));
+    key.owner = _cairo_thread_self ();
+    key.type = pattern->base.type;
+    key.extend = pattern->base.extend;
+    key.n_stops = pattern->n_stops;
+
+    key.p1.x = _cairo_fixed_16_16_from_double (extremes[0].center.x);
+    key.p1.y = _cairo_fixed_16_16_from_double (extremes[0].center.y);
+    key.p2.x = _cairo_fixed_16_16_from_double (extremes[1].center.x);
+    key.p2.y = _cairo_fixed_16_16_from_double (extremes[1].center.y);
+    if (pattern->base.type == CAIRO_PATTERN_TYPE_RADIAL) {
+	key.r1 = _cairo_fixed_16_16_from_double (extremes[0].radius);
+	key.r2 = _cairo_fixed_16_16_from_double (extremes[1].radius);
     }
 
+    *ix = *iy = 0;
+    status = _cairo_matrix_to_pixman_matrix_offset (&matrix, pattern->base.filter,
+						    extents->x + extents->width/2.,
+						    extents->y + extents->height/2.,
+						    &key.transform, ix, iy);
+    if (unlikely (status != CAIRO_INT_STATUS_SUCCESS &&
+		  status != CAIRO_INT_STATUS_NOTHING_TO_DO))
+	return NULL;
+    key.has_transform = status != CAIRO_INT_STATUS_NOTHING_TO_DO;
+    if (! key.has_transform)
+	memset (&key.transform, 0, sizeof (key.transform));
+
+    key.hash = _cairo_hash_bytes (_CAIRO_HASH_INIT_VALUE, &key, sizeof (key));
+    for (i = 0; i < pattern->n_stops; i++) {
+	key.hash = _cairo_hash_bytes (key.hash,
+				      &pattern->stops[i].offset,
+				      sizeof (double));
+	key.hash = _cairo_hash_bytes (key.hash,
+				      &pattern->stops[i].color.red_short,
+				      4 * sizeof (unsigned short));
+    }
+
+    CAIRO_MUTEX_LOCK (_cairo_image_gradient_cache_mutex);
+    if (gradient_orphans != NULL)
+	_gradient_cache_release_orphans (key.owner);
+    for (i = 0; i < n_gradients_cached; i++) {
+	if (_gradient_cache_entry_equal (i, &key, pattern)) {
+	    pixman_image = pixman_image_ref (gradient_cache[i].image);
+	    CAIRO_MUTEX_UNLOCK (_cairo_image_gradient_cache_mutex);
+	    return pixman_image;
+	}
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_gradient_cache_mutex);
+
+    /* The stops are kept along with the image in the cache. */
+    pixman_stops = _cairo_malloc_ab (MAX (pattern->n_stops, 1),
+				     sizeof(pixman_gradient_stop_t));
+    if (unlikely (pixman_stops == NULL))
+	return NULL;
+
     for (i = 0; i < pattern->n_stops; i++) {
 	pixman_stops[i].x = _cairo_fixed_16_16_from_double (pattern->stops[i].offset);
 	pixman_stops[i].color.red   = pattern->stops[i].color.red_short;
@@ -320,46 +484,26 @@ _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
 	pixman_stops[i].color.alpha = pattern->stops[i].color.alpha_short;
     }
 
-    _cairo_gradient_pattern_fit_to_range (pattern, PIXMAN_MAX_INT >> 1, &matrix, extremes);
-
-    p1.x = _cairo_fixed_16_16_from_double (extremes[0].center.x);
-    p1.y = _cairo_fixed_16_16_from_double (extremes[0].center.y);
-    p2.x = _cairo_fixed_16_16_from_double (extremes[1].center.x);
-    p2.y = _cairo_fixed_16_16_from_double (extremes[1].center.y);
-
     if (pattern->base.type == CAIRO_PATTERN_TYPE_LINEAR) {
-	pixman_image = pixman_image_create_linear_gradient (&p1, &p2,
+	pixman_image = pixman_image_create_linear_gradient (&key.p1, &key.p2,
 							    pixman_stops,
 							    pattern->n_stops);
     } else {
-	pixman_fixed_t r1, r2;
-
-	r1   = _cairo_fixed_16_16_from_double (extremes[0].radius);
-	r2   = _cairo_fixed_16_16_from_double (extremes[1].radius);
-
-	pixman_image = pixman_image_create_radial_gradient (&p1, &p2, r1, r2,
+	pixman_image = pixman_image_create_radial_gradient (&key.p1, &key.p2,
+							    key.r1, key.r2,
 							    pixman_stops,
 							    pattern->n_stops);
     }
 
-    if (pixman_stops != pixman_stops_static)
-	free (pixman_stops);
-
     if (unlikely (pixman_image == NULL))
-	return NULL;
+	goto FREE_STOPS;
 
-    *ix = *iy = 0;
-    status = _cairo_matrix_to_pixman_matrix_offset (&matrix, pattern->base.filter,
-						    extents->x + extents->width/2.,
-						    extents->y + extents->height/2.,
-						    &pixman_transform, ix, iy);
-    if (status != CAIRO_INT_STATUS_NOTHING_TO_DO) {
-	if (unlikely (status != CAIRO_INT_STATUS_SUCCESS) ||
-	    ! pixman_image_set_transform (pixman_image, &pixman_transform))
-	{
-	    pixman_image_unref (pixman_image);
-	    return NULL;
-	}
+    if (key.has_transform &&
+	! pixman_image_set_transform (pixman_image, &key.transform))
+    {
+	pixman_image_unref (pixman_image);
+	pixman_image = NULL;
+	goto FREE_STOPS;
     }
 
     {
@@ -384,6 +528,44 @@ _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
 	pixman_image_set_repeat (pixman_image, pixman_repeat);
     }
 
+    CAIRO_MUTEX_LOCK (_cairo_image_gradient_cache_mutex);
+    if (n_gradients_cached < ARRAY_LENGTH (gradient_cache)) {
+	i = n_gradients_cached++;
+    } else {
+	/* Replace the entries round robin, whichever thread owns them. */
+	i = gradient_cache_hand++ % ARRAY_LENGTH (gradient_cache);
+
+	if (gradient_cache[i].key.owner == key.owner) {
+	    pixman_image_unref (gradient_cache[i].image);
+	} else {
+	    cairo_image_gradient_orphan_t *orphan;
+
+	    /* The owner may be compositing with the image right now, so
+	     * leave dropping the cache's reference to it. */
+	    orphan = malloc (sizeof (cairo_image_gradient_orphan_t));
+	    if (unlikely (orphan == NULL)) {
+		gradient_cache_hand--;
+		CAIRO_MUTEX_UNLOCK (_cairo_image_gradient_cache_mutex);
+		goto FREE_STOPS;
+	    }
+
+	    orphan->owner = gradient_cache[i].key.owner;
+	    orphan->image = gradient_cache[i].image;
+	    orphan->next = gradient_orphans;
+	    gradient_orphans = orphan;
+	}
+	free (gradient_cache[i].stops);
+    }
+    gradient_cache[i].key = key;
+    gradient_cache[i].stops = pixman_stops;
+    gradient_cache[i].image = pixman_image_ref (pixman_image);
+    CAIRO_MUTEX_UNLOCK (_cairo_image_gradient_cache_mutex);
+
+    return pixman_image;
+
+FREE_STOPS:
+    free (pixman_stops);
+
     return pixman_image;
 }
 
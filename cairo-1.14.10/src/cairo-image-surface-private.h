@@ -74,12 +74,24 @@ struct _cairo_image_surface {
     int stride;
     int depth;
 
+    /* Worker threads used to rasterise large fills and strokes in
+     * horizontal bands; 0 or 1 renders on the calling thread only. */
+    int render_threads;
+
+    /* Drawing recorded by cairo_image_surface_set_deferred(), replayed
+     * onto the pixels when they are next needed. */
+    cairo_surface_t *deferred;
+
     unsigned owns_data : 1;
     unsigned transparency : 2;
     unsigned color : 2;
+    unsigned defer : 1;
+    unsigned replaying : 1;
 };
 #define to_image_surface(S) ((cairo_image_surface_t *)(S))
 
+#define CAIRO_IMAGE_MAX_RENDER_THREADS 32
+
 /* A wrapper for holding pixman images returned by create_for_pattern */
 typedef struct _cairo_image_source {
     cairo_surface_t base;
@@ -165,6 +177,12 @@ cairo_private cairo_int_status_t
 _cairo_image_surface_unmap_image (void *abstract_surface,
 				  cairo_image_surface_t *image);
 
+cairo_private cairo_status_t
+_cairo_image_surface_flush_deferred (cairo_image_surface_t *surface);
+
+cairo_private cairo_status_t
+_cairo_image_surface_flush_deferred_source (cairo_surface_t *surface);
+
 cairo_private cairo_surface_t *
 _cairo_image_surface_source (void			*abstract_surface,
 			     cairo_rectangle_int_t	*extents);
@@ -39,6 +39,8 @@
 
 #include "cairoint.h"
 
+#include "cairo-array-private.h"
+#include "cairo-box-inline.h"
 #include "cairo-boxes-private.h"
 #include "cairo-clip-private.h"
 #include "cairo-composite-rectangles-private.h"
@@ -46,14 +48,15 @@
 #include "cairo-default-context-private.h"
 #include "cairo-error-private.h"
 #include "cairo-image-surface-inline.h"
+#include "cairo-list-inline.h"
 #include "cairo-paginated-private.h"
 #include "cairo-pattern-private.h"
 #include "cairo-pixman-private.h"
 #include "cairo-recording-surface-private.h"
 #include "cairo-region-private.h"
 #include "cairo-scaled-font-private.h"
-#include "cairo-surface-snapshot-private.h"
-#include "cairo-surface-subsurface-private.h"
+#include "cairo-surface-snapshot-inline.h"
+#include "cairo-surface-subsurface-inline.h"
 
 /* Limit on the width / height of an image surface in pixels.  This is
  * mainly determined by coordinates of things sent to pixman at the
@@ -170,6 +173,11 @@ _cairo_image_surface_init (cairo_image_surface_t *surface,
     surface->stride = pixman_image_get_stride (pixman_image);
     surface->depth = pixman_image_get_depth (pixman_image);
 
+    surface->render_threads = 0;
+    surface->deferred = NULL;
+    surface->defer = FALSE;
+    surface->replaying = FALSE;
+
     surface->base.is_clear = surface->width == 0 || surface->height == 0;
 
     surface->compositor = _cairo_image_spans_compositor_get ();
@@ -567,6 +575,14 @@ cairo_image_surface_get_data (cairo_surface_t *surface)
 	return NULL;
     }
 
+    if (unlikely (image_surface->deferred != NULL)) {
+	cairo_status_t status;
+
+	status = _cairo_image_surface_flush_deferred (image_surface);
+	if (unlikely (status))
+	    _cairo_surface_set_error (surface, status);
+    }
+
     return image_surface->data;
 }
 slim_hidden_def (cairo_image_surface_get_data);
@@ -671,6 +687,150 @@ cairo_image_surface_get_stride (cairo_surface_t *surface)
 }
 slim_hidden_def (cairo_image_surface_get_stride);
 
+/**
+ * cairo_image_surface_set_render_threads:
+ * @surface: a #cairo_image_surface_t
+ * @num_threads: the number of threads to rasterise with
+ *
+ * Allows large fills and strokes on @surface to be rasterised in
+ * parallel. When @num_threads is greater than 1, an operation
+ * covering a sufficiently large area is split into horizontal bands
+ * which are scan converted and composited by up to @num_threads
+ * threads, the calling thread included. All bands are complete
+ * before the drawing function returns, so the result is the same as
+ * rendering on a single thread.
+ *
+ * The default of 0 renders everything on the calling thread. Values
+ * are clamped to the range 0 to 32. Where cairo was built without
+ * thread support this setting has no effect.
+ *
+ * Since: 1.14.12
+ **/
+void
+cairo_image_surface_set_render_threads (cairo_surface_t *surface,
+					int		 num_threads)
+{
+    cairo_image_surface_t *image_surface = (cairo_image_surface_t *) surface;
+
+    if (unlikely (surface->status))
+	return;
+
+    if (unlikely (surface->finished)) {
+	_cairo_surface_set_error (surface, _cairo_error (CAIRO_STATUS_SURFACE_FINISHED));
+	return;
+    }
+
+    if (! _cairo_surface_is_image (surface)) {
+	_cairo_error_throw (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+	return;
+    }
+
+    if (num_threads < 0)
+	num_threads = 0;
+    if (num_threads > CAIRO_IMAGE_MAX_RENDER_THREADS)
+	num_threads = CAIRO_IMAGE_MAX_RENDER_THREADS;
+
+    image_surface->render_threads = num_threads;
+}
+
+/**
+ * cairo_image_surface_get_render_threads:
+ * @surface: a #cairo_image_surface_t
+ *
+ * Get the number of threads set with
+ * cairo_image_surface_set_render_threads().
+ *
+ * Return value: the number of render threads of the image surface
+ * (or 0 if @surface is not an image surface).
+ *
+ * Since: 1.14.12
+ **/
+int
+cairo_image_surface_get_render_threads (cairo_surface_t *surface)
+{
+    cairo_image_surface_t *image_surface = (cairo_image_surface_t *) surface;
+
+    if (! _cairo_surface_is_image (surface)) {
+	_cairo_error_throw (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+	return 0;
+    }
+
+    return image_surface->render_threads;
+}
+
+/**
+ * cairo_image_surface_set_deferred:
+ * @surface: a #cairo_image_surface_t
+ * @deferred: whether to defer drawing
+ *
+ * Sets whether drawing on @surface is composited immediately or
+ * deferred. While deferred, operations with solid or gradient sources
+ * are recorded and only replayed when the contents of @surface are
+ * needed: by cairo_surface_flush(), when @surface is used as a source,
+ * or before drawing that cannot be recorded. Replaying merges runs of
+ * small pixel-aligned rectangles of the same colour into a single
+ * operation, which greatly reduces the cost of drawing many tiny
+ * shapes.
+ *
+ * As with any drawing, cairo_surface_flush() must be called before
+ * accessing the image data directly. Disabling deferred drawing
+ * replays anything pending.
+ *
+ * Since: 1.14.12
+ **/
+void
+cairo_image_surface_set_deferred (cairo_surface_t *surface,
+				  cairo_bool_t	   deferred)
+{
+    cairo_image_surface_t *image_surface = (cairo_image_surface_t *) surface;
+    cairo_status_t status;
+
+    if (unlikely (surface->status))
+	return;
+
+    if (unlikely (surface->finished)) {
+	_cairo_surface_set_error (surface, _cairo_error (CAIRO_STATUS_SURFACE_FINISHED));
+	return;
+    }
+
+    if (! _cairo_surface_is_image (surface)) {
+	_cairo_error_throw (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+	return;
+    }
+
+    image_surface->defer = deferred != FALSE;
+    if (! deferred) {
+	status = _cairo_image_surface_flush_deferred (image_surface);
+	if (unlikely (status))
+	    _cairo_surface_set_error (surface, status);
+    }
+}
+
+/**
+ * cairo_image_surface_get_deferred:
+ * @surface: a #cairo_image_surface_t
+ *
+ * Get whether drawing on @surface is deferred, see
+ * cairo_image_surface_set_deferred().
+ *
+ * Return value: %TRUE if drawing on the image surface is deferred
+ * (or %FALSE if @surface is not an image surface).
+ *
+ * Since: 1.14.12
+ **/
+cairo_bool_t
+cairo_image_surface_get_deferred (cairo_surface_t *surface)
+{
+    cairo_image_surface_t *image_surface = (cairo_image_surface_t *) surface;
+
+    if (! _cairo_surface_is_image (surface)) {
+	_cairo_error_throw (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+	return FALSE;
+    }
+
+    return image_surface->defer;
+}
+
     cairo_format_t
 _cairo_format_from_content (cairo_content_t content)
 {
@@ -760,9 +920,15 @@ _cairo_image_surface_snapshot (void *abstract_surface)
 {
     cairo_image_surface_t *image = abstract_surface;
     cairo_image_surface_t *clone;
+    cairo_status_t status;
+
+    status = _cairo_image_surface_flush_deferred (image);
+    if (unlikely (status))
+	return _cairo_surface_create_in_error (status);
 
-    /* If we own the image, we can simply steal the memory for the snapshot */
-    if (image->owns_data && image->base._finishing) {
+    /* If we own the image, we can simply steal the memory for the snapshot,
+     * unless it is still being drawn into by a replay of deferred drawing */
+    if (image->owns_data && image->base._finishing && ! image->replaying) {
 	clone = (cairo_image_surface_t *)
 	    _cairo_image_surface_create_for_pixman_image (image->pixman_image,
 							  image->pixman_format);
@@ -808,8 +974,13 @@ _cairo_image_surface_map_to_image (void *abstract_other,
 {
     cairo_image_surface_t *other = abstract_other;
     cairo_surface_t *surface;
+    cairo_status_t status;
     uint8_t *data;
 
+    status = _cairo_image_surface_flush_deferred (other);
+    if (unlikely (status))
+	return _cairo_image_surface_create_in_error (status);
+
     data = other->data;
     data += extents->y * other->stride;
     data += extents->x * PIXMAN_FORMAT_BPP (other->pixman_format)/ 8;
@@ -840,6 +1011,9 @@ _cairo_image_surface_finish (void *abstract_surface)
 {
     cairo_image_surface_t *surface = abstract_surface;
 
+    cairo_surface_destroy (surface->deferred);
+    surface->deferred = NULL;
+
     if (surface->pixman_image) {
 	pixman_image_unref (surface->pixman_image);
 	surface->pixman_image = NULL;
@@ -885,6 +1059,12 @@ _cairo_image_surface_acquire_source_image (void                    *abstract_sur
 					   cairo_image_surface_t  **image_out,
 					   void                   **image_extra)
 {
+    cairo_status_t status;
+
+    status = _cairo_image_surface_flush_deferred (abstract_surface);
+    if (unlikely (status))
+	return status;
+
     *image_out = abstract_surface;
     *image_extra = NULL;
 
@@ -913,6 +1093,387 @@ _cairo_image_surface_get_extents (void			  *abstract_surface,
     return TRUE;
 }
 
+/* Deferred drawing
+ *
+ * With cairo_image_surface_set_deferred() enabled, drawing with solid
+ * and gradient sources is not composited straight away but appended to
+ * a private recording surface. Anything that needs the pixels, be it a
+ * flush, reading the surface as a source or drawing that cannot be
+ * recorded, first replays the pending commands in order.
+ *
+ * Replay looks ahead from each pixel-aligned solid box for others of
+ * the same colour, operator and clip and issues them as a single fill,
+ * so that the compositor sees one set of boxes rather than hundreds of
+ * tiny operations. A later box may only be hoisted past the commands in
+ * between if it does not touch their extents, and the operators allowed
+ * give the same result however the boxes overlap.
+ */
+
+#define DEFERRED_LOOKAHEAD 64
+
+static cairo_bool_t
+_pattern_is_deferrable (const cairo_pattern_t *pattern)
+{
+    if (pattern == NULL)
+	return TRUE;
+
+    switch (pattern->type) {
+    case CAIRO_PATTERN_TYPE_SOLID:
+    case CAIRO_PATTERN_TYPE_LINEAR:
+    case CAIRO_PATTERN_TYPE_RADIAL:
+	return TRUE;
+    default:
+	return FALSE;
+    }
+}
+
+/* Returns the recording surface to append to, or NULL if the operation
+ * must be composited now, in which case all pending drawing has
+ * already been replayed. */
+static cairo_status_t
+_cairo_image_surface_get_deferred (cairo_image_surface_t	 *surface,
+				   const cairo_pattern_t	 *source,
+				   const cairo_pattern_t	 *mask,
+				   cairo_surface_t		**deferred)
+{
+    *deferred = NULL;
+
+    if (surface->replaying)
+	return CAIRO_STATUS_SUCCESS;
+
+    if (! _pattern_is_deferrable (source) || ! _pattern_is_deferrable (mask))
+	return _cairo_image_surface_flush_deferred (surface);
+
+    if (surface->deferred == NULL) {
+	cairo_rectangle_t extents;
+	cairo_surface_t *recording;
+
+	extents.x = extents.y = 0;
+	extents.width = surface->width;
+	extents.height = surface->height;
+	recording = cairo_recording_surface_create (surface->base.content,
+						    &extents);
+	if (unlikely (recording->status))
+	    return recording->status;
+
+	/* Every command must reach the pixels, clears included */
+	((cairo_recording_surface_t *) recording)->optimize_clears = FALSE;
+	surface->deferred = recording;
+    }
+
+    *deferred = surface->deferred;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_bool_t
+_command_is_solid_box (const cairo_command_t *command, cairo_box_t *box)
+{
+    const cairo_command_fill_t *fill = &command->fill;
+
+    if (command->header.type != CAIRO_COMMAND_FILL)
+	return FALSE;
+
+    if (fill->source.base.type != CAIRO_PATTERN_TYPE_SOLID)
+	return FALSE;
+
+    /* Compositing a pixel twice must not change the result */
+    switch (command->header.op) {
+    case CAIRO_OPERATOR_CLEAR:
+    case CAIRO_OPERATOR_SOURCE:
+	break;
+    case CAIRO_OPERATOR_OVER:
+	if (! CAIRO_COLOR_IS_OPAQUE (&fill->source.solid.color))
+	    return FALSE;
+	break;
+    default:
+	return FALSE;
+    }
+
+    if (command->header.clip && ! _cairo_clip_is_region (command->header.clip))
+	return FALSE;
+
+    return _cairo_path_fixed_is_box (&fill->path, box) &&
+	   _cairo_box_is_pixel_aligned (box);
+}
+
+static cairo_bool_t
+_commands_can_merge (const cairo_command_t *a, const cairo_command_t *b)
+{
+    return a->header.op == b->header.op &&
+	   _cairo_color_equal (&a->fill.source.solid.color,
+			       &b->fill.source.solid.color) &&
+	   _cairo_clip_equal (a->header.clip, b->header.clip);
+}
+
+static cairo_status_t
+_cairo_image_surface_replay_command (cairo_image_surface_t *surface,
+				     const cairo_command_t *command)
+{
+    switch (command->header.type) {
+    case CAIRO_COMMAND_PAINT:
+	return _cairo_surface_paint (&surface->base,
+				     command->header.op,
+				     &command->paint.source.base,
+				     command->header.clip);
+
+    case CAIRO_COMMAND_MASK:
+	return _cairo_surface_mask (&surface->base,
+				    command->header.op,
+				    &command->mask.source.base,
+				    &command->mask.mask.base,
+				    command->header.clip);
+
+    case CAIRO_COMMAND_STROKE:
+	return _cairo_surface_stroke (&surface->base,
+				      command->header.op,
+				      &command->stroke.source.base,
+				      &command->stroke.path,
+				      &command->stroke.style,
+				      &command->stroke.ctm,
+				      &command->stroke.ctm_inverse,
+				      command->stroke.tolerance,
+				      command->stroke.antialias,
+				      command->header.clip);
+
+    case CAIRO_COMMAND_FILL:
+	return _cairo_surface_fill (&surface->base,
+				    command->header.op,
+				    &command->fill.source.base,
+				    &command->fill.path,
+				    command->fill.fill_rule,
+				    command->fill.tolerance,
+				    command->fill.antialias,
+				    command->header.clip);
+
+    case CAIRO_COMMAND_SHOW_TEXT_GLYPHS:
+	return _cairo_surface_show_text_glyphs (&surface->base,
+						command->header.op,
+						&command->show_text_glyphs.source.base,
+						NULL, 0,
+						command->show_text_glyphs.glyphs,
+						command->show_text_glyphs.num_glyphs,
+						NULL, 0, 0,
+						command->show_text_glyphs.scaled_font,
+						command->header.clip);
+    }
+
+    ASSERT_NOT_REACHED;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_path_add_box (cairo_path_fixed_t *path, const cairo_box_t *box)
+{
+    cairo_status_t status;
+
+    status = _cairo_path_fixed_move_to (path, box->p1.x, box->p1.y);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = _cairo_path_fixed_line_to (path, box->p2.x, box->p1.y);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = _cairo_path_fixed_line_to (path, box->p2.x, box->p2.y);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = _cairo_path_fixed_line_to (path, box->p1.x, box->p2.y);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = _cairo_path_fixed_close_path (path);
+
+    return status;
+}
+
+/* Gather the boxes that can be composited together with the solid box
+ * at @first into @path, marking them as done. */
+static cairo_status_t
+_cairo_image_surface_merge_boxes (cairo_command_t	**elements,
+				  unsigned int		  first,
+				  unsigned int		  num_elements,
+				  uint8_t		 *done,
+				  cairo_path_fixed_t	 *path,
+				  int			 *num_boxes)
+{
+    cairo_rectangle_int_t skipped[DEFERRED_LOOKAHEAD];
+    unsigned int num_skipped = 0;
+    unsigned int i, k, last;
+    cairo_status_t status;
+
+    last = MIN (num_elements, first + 1 + DEFERRED_LOOKAHEAD);
+    for (i = first + 1; i < last; i++) {
+	cairo_command_t *command = elements[i];
+	cairo_rectangle_int_t rect;
+	cairo_box_t box;
+
+	if (done[i])
+	    continue;
+
+	if (_command_is_solid_box (command, &box) &&
+	    _commands_can_merge (elements[first], command))
+	{
+	    _cairo_box_round_to_rectangle (&box, &rect);
+	    for (k = 0; k < num_skipped; k++) {
+		if (_cairo_rectangle_intersects (&skipped[k], &rect))
+		    break;
+	    }
+	    if (k == num_skipped) {
+		status = _path_add_box (path, &box);
+		if (unlikely (status))
+		    return status;
+
+		done[i] = TRUE;
+		++*num_boxes;
+		continue;
+	    }
+	}
+
+	/* Anything merged from here on is hoisted over this command */
+	skipped[num_skipped++] = command->header.extents;
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_cairo_image_surface_replay_deferred (cairo_image_surface_t	*surface,
+				      cairo_recording_surface_t	*recording)
+{
+    cairo_command_t **elements;
+    unsigned int i, num_elements;
+    uint8_t *done;
+    cairo_status_t status;
+
+    if (unlikely (recording->base.status))
+	return recording->base.status;
+
+    num_elements = recording->commands.num_elements;
+    if (num_elements == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    done = calloc (num_elements, 1);
+    if (unlikely (done == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    elements = _cairo_array_index (&recording->commands, 0);
+    status = CAIRO_STATUS_SUCCESS;
+    for (i = 0; i < num_elements && status == CAIRO_STATUS_SUCCESS; i++) {
+	cairo_command_t *command = elements[i];
+	cairo_path_fixed_t path;
+	cairo_box_t box;
+	int num_boxes;
+
+	if (done[i])
+	    continue;
+
+	if (! _command_is_solid_box (command, &box)) {
+	    status = _cairo_image_surface_replay_command (surface, command);
+	    continue;
+	}
+
+	_cairo_path_fixed_init (&path);
+	num_boxes = 1;
+	status = _path_add_box (&path, &box);
+	if (likely (status == CAIRO_STATUS_SUCCESS))
+	    status = _cairo_image_surface_merge_boxes (elements, i,
+						       num_elements, done,
+						       &path, &num_boxes);
+	if (likely (status == CAIRO_STATUS_SUCCESS)) {
+	    if (num_boxes == 1) {
+		status = _cairo_image_surface_replay_command (surface, command);
+	    } else {
+		status = _cairo_surface_fill (&surface->base,
+					      command->header.op,
+					      &command->fill.source.base,
+					      &path,
+					      CAIRO_FILL_RULE_WINDING,
+					      command->fill.tolerance,
+					      command->fill.antialias,
+					      command->header.clip);
+	    }
+	}
+	_cairo_path_fixed_fini (&path);
+    }
+
+    free (done);
+    return status;
+}
+
+cairo_status_t
+_cairo_image_surface_flush_deferred (cairo_image_surface_t *surface)
+{
+    cairo_surface_t *recording;
+    cairo_list_t snapshots;
+    cairo_status_t status;
+
+    if (surface->deferred == NULL || surface->replaying)
+	return CAIRO_STATUS_SUCCESS;
+
+    /* Take the list first: replaying may need to flush again, e.g. to
+     * copy-on-write snapshots of this surface. */
+    recording = surface->deferred;
+    surface->deferred = NULL;
+
+    /* Drawing anything detaches the snapshots, so any still attached
+     * were taken after all the pending drawing and must see it. Keep
+     * them out of the way of the replay, which would otherwise copy
+     * them when the first command is drawn. */
+    cairo_list_init (&snapshots);
+    while (! cairo_list_is_empty (&surface->base.snapshots))
+	cairo_list_move_tail (surface->base.snapshots.next, &snapshots);
+
+    /* The surface was marked clear or not as each command was recorded,
+     * which says nothing of the pixels underneath until the replay is
+     * done. */
+    surface->base.is_clear = FALSE;
+
+    surface->replaying = TRUE;
+    status = _cairo_image_surface_replay_deferred (surface,
+						   (cairo_recording_surface_t *) recording);
+    surface->replaying = FALSE;
+
+    while (! cairo_list_is_empty (&snapshots))
+	cairo_list_move_tail (snapshots.next, &surface->base.snapshots);
+
+    cairo_surface_destroy (recording);
+    return status;
+}
+
+/* Replays pending drawing on the image surface, if any, behind a
+ * source about to be read. */
+cairo_status_t
+_cairo_image_surface_flush_deferred_source (cairo_surface_t *surface)
+{
+    cairo_surface_t *target;
+    cairo_status_t status;
+
+    if (surface->type != CAIRO_SURFACE_TYPE_IMAGE)
+	return CAIRO_STATUS_SUCCESS;
+
+    if (_cairo_surface_is_image (surface))
+	return _cairo_image_surface_flush_deferred ((cairo_image_surface_t *) surface);
+
+    if (_cairo_surface_is_subsurface (surface))
+	return _cairo_image_surface_flush_deferred_source (_cairo_surface_subsurface_get_target (surface));
+
+    if (! _cairo_surface_is_snapshot (surface))
+	return CAIRO_STATUS_SUCCESS;
+
+    target = _cairo_surface_snapshot_get_target (surface);
+    status = CAIRO_STATUS_SUCCESS;
+    if (_cairo_surface_is_image (target))
+	status = _cairo_image_surface_flush_deferred ((cairo_image_surface_t *) target);
+    cairo_surface_destroy (target);
+
+    return status;
+}
+
+static cairo_status_t
+_cairo_image_surface_flush (void *abstract_surface, unsigned flags)
+{
+    cairo_image_surface_t *surface = abstract_surface;
+
+    /* Nothing to do when merely preparing for further drawing */
+    if (flags)
+	return CAIRO_STATUS_SUCCESS;
+
+    return _cairo_image_surface_flush_deferred (surface);
+}
+
 cairo_int_status_t
 _cairo_image_surface_paint (void			*abstract_surface,
 			    cairo_operator_t		 op,
@@ -920,10 +1481,29 @@ _cairo_image_surface_paint (void			*abstract_surface,
 			    const cairo_clip_t		*clip)
 {
     cairo_image_surface_t *surface = abstract_surface;
+    cairo_surface_t *deferred;
+    cairo_status_t status;
 
     TRACE ((stderr, "%s (surface=%d)\n",
 	    __FUNCTION__, surface->base.unique_id));
 
+    if (surface->defer) {
+	/* Whatever is pending would be wiped out anyway */
+	if (op == CAIRO_OPERATOR_CLEAR && clip == NULL &&
+	    surface->deferred != NULL && ! surface->replaying)
+	{
+	    cairo_surface_destroy (surface->deferred);
+	    surface->deferred = NULL;
+	}
+
+	status = _cairo_image_surface_get_deferred (surface, source, NULL,
+						    &deferred);
+	if (unlikely (status))
+	    return status;
+	if (deferred)
+	    return _cairo_surface_paint (deferred, op, source, clip);
+    }
+
     return _cairo_compositor_paint (surface->compositor,
 				    &surface->base, op, source, clip);
 }
@@ -936,10 +1516,21 @@ _cairo_image_surface_mask (void				*abstract_surface,
 			   const cairo_clip_t		*clip)
 {
     cairo_image_surface_t *surface = abstract_surface;
+    cairo_surface_t *deferred;
+    cairo_status_t status;
 
     TRACE ((stderr, "%s (surface=%d)\n",
 	    __FUNCTION__, surface->base.unique_id));
 
+    if (surface->defer) {
+	status = _cairo_image_surface_get_deferred (surface, source, mask,
+						    &deferred);
+	if (unlikely (status))
+	    return status;
+	if (deferred)
+	    return _cairo_surface_mask (deferred, op, source, mask, clip);
+    }
+
     return _cairo_compositor_mask (surface->compositor,
 				   &surface->base, op, source, mask, clip);
 }
@@ -957,10 +1548,23 @@ _cairo_image_surface_stroke (void			*abstract_surface,
 			     const cairo_clip_t		*clip)
 {
     cairo_image_surface_t *surface = abstract_surface;
+    cairo_surface_t *deferred;
+    cairo_status_t status;
 
     TRACE ((stderr, "%s (surface=%d)\n",
 	    __FUNCTION__, surface->base.unique_id));
 
+    if (surface->defer) {
+	status = _cairo_image_surface_get_deferred (surface, source, NULL,
+						    &deferred);
+	if (unlikely (status))
+	    return status;
+	if (deferred)
+	    return _cairo_surface_stroke (deferred, op, source, path,
+					  style, ctm, ctm_inverse,
+					  tolerance, antialias, clip);
+    }
+
     return _cairo_compositor_stroke (surface->compositor, &surface->base,
 				     op, source, path,
 				     style, ctm, ctm_inverse,
@@ -978,10 +1582,23 @@ _cairo_image_surface_fill (void				*abstract_surface,
 			   const cairo_clip_t		*clip)
 {
     cairo_image_surface_t *surface = abstract_surface;
+    cairo_surface_t *deferred;
+    cairo_status_t status;
 
     TRACE ((stderr, "%s (surface=%d)\n",
 	    __FUNCTION__, surface->base.unique_id));
 
+    if (surface->defer) {
+	status = _cairo_image_surface_get_deferred (surface, source, NULL,
+						    &deferred);
+	if (unlikely (status))
+	    return status;
+	if (deferred)
+	    return _cairo_surface_fill (deferred, op, source, path,
+					fill_rule, tolerance, antialias,
+					clip);
+    }
+
     return _cairo_compositor_fill (surface->compositor, &surface->base,
 				   op, source, path,
 				   fill_rule, tolerance, antialias,
@@ -998,10 +1615,25 @@ _cairo_image_surface_glyphs (void			*abstract_surface,
 			     const cairo_clip_t		*clip)
 {
     cairo_image_surface_t *surface = abstract_surface;
+    cairo_surface_t *deferred;
+    cairo_status_t status;
 
     TRACE ((stderr, "%s (surface=%d)\n",
 	    __FUNCTION__, surface->base.unique_id));
 
+    if (surface->defer) {
+	status = _cairo_image_surface_get_deferred (surface, source, NULL,
+						    &deferred);
+	if (unlikely (status))
+	    return status;
+	if (deferred)
+	    return _cairo_surface_show_text_glyphs (deferred, op, source,
+						    NULL, 0,
+						    glyphs, num_glyphs,
+						    NULL, 0, 0,
+						    scaled_font, clip);
+    }
+
     return _cairo_compositor_glyphs (surface->compositor, &surface->base,
 				     op, source,
 				     glyphs, num_glyphs, scaled_font,
@@ -1040,8 +1672,8 @@ const cairo_surface_backend_t _cairo_image_surface_backend = {
     _cairo_image_surface_get_extents,
     _cairo_image_surface_get_font_options,
 
-    NULL, /* flush */
-    NULL,
+    _cairo_image_surface_flush,
+    NULL, /* mark_dirty_rectangle */
 
     _cairo_image_surface_paint,
     _cairo_image_surface_mask,
@@ -62,6 +62,22 @@ cairo_private void _cairo_mutex_finalize (void);
 #include "cairo-mutex-list-private.h"
 #undef CAIRO_MUTEX_DECLARE
 
+/* Identifies the calling thread, for keeping per-thread state in tables
+ * that all threads share. */
+static inline uintptr_t
+_cairo_thread_self (void)
+{
+#if CAIRO_MUTEX_IMPL_AMIGAOS4
+    return (uintptr_t) IExec->FindTask (NULL);
+#elif CAIRO_MUTEX_IMPL_WIN32
+    return GetCurrentThreadId ();
+#elif CAIRO_MUTEX_IMPL_PTHREAD
+    return (uintptr_t) pthread_self ();
+#else
+    return 0;
+#endif
+}
+
 CAIRO_END_DECLS
 
 #endif
@@ -113,6 +113,8 @@ struct _cairo_scaled_font {
     cairo_list_t glyph_pages;
     cairo_bool_t cache_frozen;
     cairo_bool_t global_cache_frozen;
+    unsigned int glyph_cache_hits;	/* not yet reported to the */
+    unsigned int glyph_cache_misses;	/* global glyph cache */
 
     cairo_list_t dev_privates;
 
@@ -145,6 +147,8 @@ struct _cairo_scaled_glyph {
     const void		   *dev_private_key;
     void		   *dev_private;
     cairo_list_t            dev_privates;
+
+    cairo_scaled_glyph_page_t *page;		/* owner in the glyph cache */
 };
 
 struct _cairo_scaled_glyph_private {
@@ -155,6 +159,11 @@ struct _cairo_scaled_glyph_private {
 		     cairo_scaled_font_t *);
 };
 
+cairo_private unsigned long
+_cairo_scaled_font_glyph_phase_index (const cairo_scaled_font_t *scaled_font,
+				      unsigned long              index,
+				      double                    *x);
+
 cairo_private cairo_scaled_font_private_t *
 _cairo_scaled_font_find_private (cairo_scaled_font_t *scaled_font,
 				 const void *key);
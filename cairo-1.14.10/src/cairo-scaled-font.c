@@ -76,22 +76,51 @@ _cairo_scaled_font_compute_hash (cairo_scaled_font_t *scaled_font);
  * The glyphs are allocated in pages, which are capped in the global pool.
  * Using pages means we can reduce the frequency at which we have to probe the
  * global pool and ameliorates the memory allocation pressure.
+ *
+ * The pool is capped by the number of bytes held by its pages (the glyph
+ * records plus their images and outlines), see cairo_glyph_cache_set_max_size().
+ * Pages are evicted using the clock algorithm: every page sits on a ring in
+ * the order it was allocated, and a glyph lookup that hits a page marks it
+ * as referenced. When the pool is over budget the hand sweeps the ring,
+ * giving referenced pages a second chance and evicting the first one that
+ * has not been touched since the hand last passed it.
  */
 
-/* XXX: This number is arbitrary---we've never done any measurement of this. */
-#define MAX_GLYPH_PAGES_CACHED 512
-static cairo_cache_t cairo_scaled_glyph_page_cache;
+/* Roughly what the old cap of 512 pages of small glyphs used to hold. */
+#define CAIRO_SCALED_GLYPH_CACHE_DEFAULT_SIZE (8 << 20)
 
 #define CAIRO_SCALED_GLYPH_PAGE_SIZE 32
 struct _cairo_scaled_glyph_page {
-    cairo_cache_entry_t cache_entry;
+    cairo_scaled_font_t *scaled_font;
+
+    cairo_list_t link;	/* in scaled_font->glyph_pages */
+    cairo_list_t clock;	/* in the global page cache */
 
-    cairo_list_t link;
+    unsigned long size;
+    cairo_bool_t referenced;
 
     unsigned int num_glyphs;
     cairo_scaled_glyph_t glyphs[CAIRO_SCALED_GLYPH_PAGE_SIZE];
 };
 
+/* Protected by _cairo_scaled_glyph_page_cache_mutex. */
+static struct _cairo_scaled_glyph_page_cache {
+    cairo_list_t pages;		/* the clock hand is at the head */
+    unsigned long num_pages;
+    unsigned long size;
+    unsigned long max_size;
+    int freeze_count;
+
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} cairo_scaled_glyph_page_cache = {
+    { &cairo_scaled_glyph_page_cache.pages,
+      &cairo_scaled_glyph_page_cache.pages },
+    0, 0,
+    CAIRO_SCALED_GLYPH_CACHE_DEFAULT_SIZE,
+};
+
 /*
  *  Notes:
  *
@@ -253,6 +282,8 @@ static const cairo_scaled_font_t _cairo_scaled_font_nil = {
     { NULL, NULL },		/* pages */
     FALSE,			/* cache_frozen */
     FALSE,			/* global_cache_frozen */
+    0,				/* glyph_cache_hits */
+    0,				/* glyph_cache_misses */
     { NULL, NULL },		/* privates */
     NULL			/* backend */
 };
@@ -477,13 +508,124 @@ _cairo_scaled_glyph_page_pluck (void *closure)
 
     assert (! cairo_list_is_empty (&page->link));
 
-    scaled_font = (cairo_scaled_font_t *) page->cache_entry.hash;
+    scaled_font = page->scaled_font;
 
     CAIRO_MUTEX_LOCK (scaled_font->mutex);
     _cairo_scaled_glyph_page_destroy (scaled_font, page);
     CAIRO_MUTEX_UNLOCK (scaled_font->mutex);
 }
 
+static void
+_cairo_scaled_glyph_page_cache_remove (cairo_scaled_glyph_page_t *page)
+{
+    cairo_scaled_glyph_page_cache.size -= page->size;
+    cairo_scaled_glyph_page_cache.num_pages--;
+    cairo_list_del (&page->clock);
+}
+
+static void
+_cairo_scaled_glyph_page_cache_shrink (void)
+{
+    struct _cairo_scaled_glyph_page_cache *cache = &cairo_scaled_glyph_page_cache;
+    unsigned long sweep;
+
+    assert (CAIRO_MUTEX_IS_LOCKED (_cairo_scaled_glyph_page_cache_mutex));
+
+    /* Two turns of the hand clear every reference bit, so anything still
+     * left after that belongs to a font that is currently frozen. */
+    sweep = 2 * cache->num_pages;
+    while (cache->size > cache->max_size && sweep--) {
+	cairo_scaled_glyph_page_t *page;
+
+	page = cairo_list_first_entry (&cache->pages,
+				       cairo_scaled_glyph_page_t,
+				       clock);
+	if (page->referenced || page->scaled_font->cache_frozen) {
+	    page->referenced = FALSE;
+	    cairo_list_move_tail (&page->clock, &cache->pages);
+	    continue;
+	}
+
+	_cairo_scaled_glyph_page_cache_remove (page);
+	_cairo_scaled_glyph_page_pluck (page);
+	cache->evictions++;
+    }
+}
+
+/* Fold the lookups counted by @scaled_font since it last reported into the
+ * global statistics. */
+static void
+_cairo_scaled_glyph_page_cache_account (cairo_scaled_font_t *scaled_font)
+{
+    assert (CAIRO_MUTEX_IS_LOCKED (_cairo_scaled_glyph_page_cache_mutex));
+
+    cairo_scaled_glyph_page_cache.hits += scaled_font->glyph_cache_hits;
+    cairo_scaled_glyph_page_cache.misses += scaled_font->glyph_cache_misses;
+    scaled_font->glyph_cache_hits = 0;
+    scaled_font->glyph_cache_misses = 0;
+}
+
+static unsigned long
+_cairo_scaled_glyph_footprint (const cairo_scaled_glyph_t *scaled_glyph)
+{
+    unsigned long size = 0;
+
+    if (scaled_glyph->surface != NULL) {
+	const cairo_image_surface_t *image = scaled_glyph->surface;
+
+	size += sizeof (cairo_image_surface_t);
+	size += (unsigned long) image->stride * image->height;
+    }
+
+    if (scaled_glyph->path != NULL) {
+	const cairo_path_buf_t *buf;
+
+	size += sizeof (cairo_path_fixed_t);
+	for (buf = cairo_path_buf_next (cairo_path_head (scaled_glyph->path));
+	     buf != cairo_path_head (scaled_glyph->path);
+	     buf = cairo_path_buf_next (buf))
+	{
+	    size += sizeof (cairo_path_buf_t);
+	    size += buf->size_ops * sizeof (cairo_path_op_t);
+	    size += buf->size_points * sizeof (cairo_point_t);
+	}
+    }
+
+    /* The recording is opaque to us; charge a nominal page for it. */
+    if (scaled_glyph->recording_surface != NULL)
+	size += 4096;
+
+    return size;
+}
+
+/* Recharges @page for a glyph whose footprint changed from @old_size to
+ * @new_size.  The font is frozen, so its own pages cannot be evicted yet;
+ * if the cache is now over budget it joins the global freeze like a new
+ * page does, and the cache is shrunk once the font is thawed. */
+static void
+_cairo_scaled_glyph_page_resize (cairo_scaled_glyph_page_t *page,
+				 unsigned long old_size,
+				 unsigned long new_size)
+{
+    cairo_scaled_font_t *scaled_font = page->scaled_font;
+
+    assert (scaled_font->cache_frozen);
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    page->size -= old_size;
+    page->size += new_size;
+    cairo_scaled_glyph_page_cache.size -= old_size;
+    cairo_scaled_glyph_page_cache.size += new_size;
+
+    if (cairo_scaled_glyph_page_cache.size > cairo_scaled_glyph_page_cache.max_size &&
+	scaled_font->global_cache_frozen == FALSE)
+    {
+	cairo_scaled_glyph_page_cache.freeze_count++;
+	scaled_font->global_cache_frozen = TRUE;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+}
+
 /* If a scaled font wants to unlock the font map while still being
  * created (needed for user-fonts), we need to take extra care not
  * ending up with multiple identical scaled fonts being created.
@@ -768,6 +910,8 @@ _cairo_scaled_font_init (cairo_scaled_font_t               *scaled_font,
     cairo_list_init (&scaled_font->glyph_pages);
     scaled_font->cache_frozen = FALSE;
     scaled_font->global_cache_frozen = FALSE;
+    scaled_font->glyph_cache_hits = 0;
+    scaled_font->glyph_cache_misses = 0;
 
     scaled_font->holdover = FALSE;
     scaled_font->finished = FALSE;
@@ -804,11 +948,21 @@ _cairo_scaled_font_thaw_cache (cairo_scaled_font_t *scaled_font)
 {
     assert (scaled_font->cache_frozen);
 
-    if (scaled_font->global_cache_frozen) {
+    /* Only report the lookup counts when we have to take the global lock
+     * anyway, or once enough have built up. */
+    if (scaled_font->global_cache_frozen ||
+	scaled_font->glyph_cache_hits + scaled_font->glyph_cache_misses >=
+	CAIRO_SCALED_GLYPH_PAGE_SIZE)
+    {
 	CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-	_cairo_cache_thaw (&cairo_scaled_glyph_page_cache);
+	_cairo_scaled_glyph_page_cache_account (scaled_font);
+	if (scaled_font->global_cache_frozen) {
+	    assert (cairo_scaled_glyph_page_cache.freeze_count > 0);
+	    if (--cairo_scaled_glyph_page_cache.freeze_count == 0)
+		_cairo_scaled_glyph_page_cache_shrink ();
+	    scaled_font->global_cache_frozen = FALSE;
+	}
 	CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
-	scaled_font->global_cache_frozen = FALSE;
     }
 
     scaled_font->cache_frozen = FALSE;
@@ -825,13 +979,12 @@ _cairo_scaled_font_reset_cache (cairo_scaled_font_t *scaled_font)
     assert (! scaled_font->global_cache_frozen);
     CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
 
+    _cairo_scaled_glyph_page_cache_account (scaled_font);
     cairo_list_foreach_entry (page,
 			      cairo_scaled_glyph_page_t,
 			      &scaled_font->glyph_pages,
 			      link) {
-	cairo_scaled_glyph_page_cache.size -= page->cache_entry.size;
-	_cairo_hash_table_remove (cairo_scaled_glyph_page_cache.hash_table,
-				  (cairo_hash_entry_t *) &page->cache_entry);
+	_cairo_scaled_glyph_page_cache_remove (page);
     }
 
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
@@ -1261,10 +1414,19 @@ _cairo_scaled_font_reset_static_data (void)
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_font_error_mutex);
 
     CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-    if (cairo_scaled_glyph_page_cache.hash_table != NULL) {
-	_cairo_cache_fini (&cairo_scaled_glyph_page_cache);
-	cairo_scaled_glyph_page_cache.hash_table = NULL;
-    }
+    while (! cairo_list_is_empty (&cairo_scaled_glyph_page_cache.pages)) {
+	cairo_scaled_glyph_page_t *page;
+
+	page = cairo_list_first_entry (&cairo_scaled_glyph_page_cache.pages,
+				       cairo_scaled_glyph_page_t,
+				       clock);
+	_cairo_scaled_glyph_page_cache_remove (page);
+	_cairo_scaled_glyph_page_pluck (page);
+    }
+    assert (cairo_scaled_glyph_page_cache.size == 0);
+    cairo_scaled_glyph_page_cache.hits = 0;
+    cairo_scaled_glyph_page_cache.misses = 0;
+    cairo_scaled_glyph_page_cache.evictions = 0;
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
 }
 
@@ -2167,6 +2329,34 @@ _range_contains_glyph (const cairo_box_t *extents,
 	   top < extents->p2.y;
 }
 
+/* Returns the device x the image of a glyph is placed relative to.  With
+ * subpixel positioning that is the whole pixel its variant is drawn from
+ * (see _cairo_scaled_font_glyph_phase_index()), and *pad is set to the
+ * extra column a shifted variant may cover to the right of the bbox.
+ * The variant for phase 0 is not shifted and needs no padding.
+ */
+static cairo_fixed_t
+_cairo_scaled_font_glyph_device_x (cairo_scaled_font_t	*scaled_font,
+				   const cairo_glyph_t	*glyph,
+				   cairo_bool_t		 round_x,
+				   cairo_fixed_t	*pad)
+{
+    *pad = 0;
+
+    if (scaled_font->options.subpixel_positions > 1) {
+	double x = glyph->x;
+
+	if (_cairo_scaled_font_glyph_phase_index (scaled_font, glyph->index, &x) != glyph->index)
+	    *pad = CAIRO_FIXED_ONE;
+	return _cairo_fixed_from_int ((int) x);
+    }
+
+    if (round_x)
+	return _cairo_fixed_from_int (_cairo_lround (glyph->x));
+    else
+	return _cairo_fixed_from_double (glyph->x);
+}
+
 static cairo_status_t
 _cairo_scaled_font_single_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 						const cairo_glyph_t	 *glyph,
@@ -2183,14 +2373,11 @@ _cairo_scaled_font_single_glyph_device_extents (cairo_scaled_font_t	 *scaled_fon
     if (likely (status == CAIRO_STATUS_SUCCESS)) {
 	cairo_bool_t round_xy = _cairo_font_options_get_round_glyph_positions (&scaled_font->options) == CAIRO_ROUND_GLYPH_POS_ON;
 	cairo_box_t box;
-	cairo_fixed_t v;
+	cairo_fixed_t v, pad;
 
-	if (round_xy)
-	    v = _cairo_fixed_from_int (_cairo_lround (glyph->x));
-	else
-	    v = _cairo_fixed_from_double (glyph->x);
+	v = _cairo_scaled_font_glyph_device_x (scaled_font, glyph, round_xy, &pad);
 	box.p1.x = v + scaled_glyph->bbox.p1.x;
-	box.p2.x = v + scaled_glyph->bbox.p2.x;
+	box.p2.x = v + scaled_glyph->bbox.p2.x + pad;
 
 	if (round_xy)
 	    v = _cairo_fixed_from_int (_cairo_lround (glyph->y));
@@ -2239,7 +2426,7 @@ _cairo_scaled_font_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 
     for (i = 0; i < num_glyphs; i++) {
 	cairo_scaled_glyph_t	*scaled_glyph;
-	cairo_fixed_t x, y, x1, y1, x2, y2;
+	cairo_fixed_t x, y, x1, y1, x2, y2, pad;
 	int cache_index = glyphs[i].index % ARRAY_LENGTH (glyph_cache);
 
 	scaled_glyph = glyph_cache[cache_index];
@@ -2256,12 +2443,11 @@ _cairo_scaled_font_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 	    glyph_cache[cache_index] = scaled_glyph;
 	}
 
-	if (round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON)
-	    x = _cairo_fixed_from_int (_cairo_lround (glyphs[i].x));
-	else
-	    x = _cairo_fixed_from_double (glyphs[i].x);
+	x = _cairo_scaled_font_glyph_device_x (scaled_font, &glyphs[i],
+					       round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON,
+					       &pad);
 	x1 = x + scaled_glyph->bbox.p1.x;
-	x2 = x + scaled_glyph->bbox.p2.x;
+	x2 = x + scaled_glyph->bbox.p2.x + pad;
 
 	if (round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON)
 	    y = _cairo_fixed_from_int (_cairo_lround (glyphs[i].y));
@@ -2778,6 +2964,99 @@ _cairo_scaled_glyph_set_metrics (cairo_scaled_glyph_t *scaled_glyph,
     scaled_glyph->has_info |= CAIRO_SCALED_GLYPH_INFO_METRICS;
 }
 
+/**
+ * _cairo_scaled_font_glyph_phase_index:
+ * @scaled_font: a #cairo_scaled_font_t
+ * @index: the glyph index
+ * @x: the device space x position of the glyph
+ *
+ * With subpixel positioning the glyph cache holds a variant of each
+ * glyph for every position within a pixel it is drawn at.  This returns
+ * the cache key of the variant for a glyph at @x and replaces @x by the
+ * whole pixel that variant is drawn relative to.  Without subpixel
+ * positioning the index and @x are left alone.
+ *
+ * Return value: the key to look the glyph surface up with
+ **/
+unsigned long
+_cairo_scaled_font_glyph_phase_index (const cairo_scaled_font_t *scaled_font,
+				      unsigned long              index,
+				      double                    *x)
+{
+    int positions = scaled_font->options.subpixel_positions;
+    double pos, pixel;
+
+    if (positions <= 1)
+	return index;
+
+    pos = floor (*x * positions + .5);
+    pixel = floor (pos / positions);
+    *x = pixel;
+
+    return index | ((unsigned long) (pos - pixel * positions) << CAIRO_SCALED_GLYPH_PHASE_SHIFT);
+}
+
+/* Moves a glyph image right by the subpixel position of the glyph.
+ * Alpha and colour glyphs have their coverage split between neighbouring
+ * pixels, anything else moves by the nearest whole pixel.
+ */
+static cairo_image_surface_t *
+_cairo_scaled_glyph_shift_surface (cairo_scaled_font_t   *scaled_font,
+				   cairo_image_surface_t *surface,
+				   int                    phase)
+{
+    int positions = scaled_font->options.subpixel_positions;
+    cairo_image_surface_t *shifted;
+    int x, y, c, bpp, a, b;
+
+    if (surface->width == 0 || surface->height == 0)
+	return surface;
+
+    if (surface->format != CAIRO_FORMAT_A8 &&
+	surface->format != CAIRO_FORMAT_ARGB32)
+    {
+	if (2 * phase >= positions) {
+	    cairo_surface_set_device_offset (&surface->base,
+					     surface->base.device_transform.x0 - 1,
+					     surface->base.device_transform.y0);
+	}
+	return surface;
+    }
+
+    shifted = (cairo_image_surface_t *)
+	cairo_image_surface_create (surface->format,
+				    surface->width + 1,
+				    surface->height);
+    if (unlikely (shifted->base.status)) {
+	/* Unshifted is still better than no glyph at all */
+	cairo_surface_destroy (&shifted->base);
+	return surface;
+    }
+
+    bpp = surface->format == CAIRO_FORMAT_A8 ? 1 : 4;
+    for (y = 0; y < surface->height; y++) {
+	const uint8_t *src = surface->data + y * surface->stride;
+	uint8_t *dst = shifted->data + y * shifted->stride;
+
+	for (x = 0; x <= surface->width; x++) {
+	    for (c = 0; c < bpp; c++) {
+		a = x < surface->width ? src[x * bpp + c] : 0;
+		b = x > 0 ? src[(x - 1) * bpp + c] : 0;
+		dst[x * bpp + c] = (a * (positions - phase) + b * phase + positions / 2) / positions;
+	    }
+	}
+    }
+
+    pixman_image_set_component_alpha (shifted->pixman_image,
+				      pixman_image_get_component_alpha (surface->pixman_image));
+    cairo_surface_set_device_offset (&shifted->base,
+				     surface->base.device_transform.x0,
+				     surface->base.device_transform.y0);
+
+    cairo_surface_destroy (&surface->base);
+    return shifted;
+}
+
 void
 _cairo_scaled_glyph_set_surface (cairo_scaled_glyph_t *scaled_glyph,
 				 cairo_scaled_font_t *scaled_font,
@@ -2786,6 +3065,11 @@ _cairo_scaled_glyph_set_surface (cairo_scaled_glyph_t *scaled_glyph,
     if (scaled_glyph->surface != NULL)
 	cairo_surface_destroy (&scaled_glyph->surface->base);
 
+    if (surface != NULL && _cairo_scaled_glyph_phase (scaled_glyph) != 0) {
+	surface = _cairo_scaled_glyph_shift_surface (scaled_font, surface,
+						     _cairo_scaled_glyph_phase (scaled_glyph));
+    }
+
     /* sanity check the backend glyph contents */
     _cairo_debug_check_image_surface_is_defined (&surface->base);
     scaled_glyph->surface = surface;
@@ -2830,22 +3114,11 @@ _cairo_scaled_glyph_set_recording_surface (cairo_scaled_glyph_t *scaled_glyph,
 	scaled_glyph->has_info &= ~CAIRO_SCALED_GLYPH_INFO_RECORDING_SURFACE;
 }
 
-static cairo_bool_t
-_cairo_scaled_glyph_page_can_remove (const void *closure)
-{
-    const cairo_scaled_glyph_page_t *page = closure;
-    const cairo_scaled_font_t *scaled_font;
-
-    scaled_font = (cairo_scaled_font_t *) page->cache_entry.hash;
-    return scaled_font->cache_frozen == 0;
-}
-
 static cairo_status_t
 _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
 				   cairo_scaled_glyph_t **scaled_glyph)
 {
     cairo_scaled_glyph_page_t *page;
-    cairo_status_t status;
 
     assert (scaled_font->cache_frozen);
 
@@ -2864,36 +3137,23 @@ _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
     if (unlikely (page == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    page->cache_entry.hash = (unsigned long) scaled_font;
-    page->cache_entry.size = 1; /* XXX occupancy weighting? */
+    page->scaled_font = scaled_font;
+    page->size = sizeof (cairo_scaled_glyph_page_t);
+    page->referenced = FALSE;
     page->num_glyphs = 0;
 
+    /* New pages go in just behind the hand, and nothing is evicted until
+     * the cache is thawed. */
     CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
     if (scaled_font->global_cache_frozen == FALSE) {
-	if (unlikely (cairo_scaled_glyph_page_cache.hash_table == NULL)) {
-	    status = _cairo_cache_init (&cairo_scaled_glyph_page_cache,
-					NULL,
-					_cairo_scaled_glyph_page_can_remove,
-					_cairo_scaled_glyph_page_pluck,
-					MAX_GLYPH_PAGES_CACHED);
-	    if (unlikely (status)) {
-		CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
-		free (page);
-		return status;
-	    }
-	}
-
-	_cairo_cache_freeze (&cairo_scaled_glyph_page_cache);
+	cairo_scaled_glyph_page_cache.freeze_count++;
 	scaled_font->global_cache_frozen = TRUE;
     }
 
-    status = _cairo_cache_insert (&cairo_scaled_glyph_page_cache,
-				  &page->cache_entry);
+    cairo_list_add_tail (&page->clock, &cairo_scaled_glyph_page_cache.pages);
+    cairo_scaled_glyph_page_cache.num_pages++;
+    cairo_scaled_glyph_page_cache.size += page->size;
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
-    if (unlikely (status)) {
-	free (page);
-	return status;
-    }
 
     cairo_list_add_tail (&page->link, &scaled_font->glyph_pages);
 
@@ -2917,12 +3177,8 @@ _cairo_scaled_font_free_last_glyph (cairo_scaled_font_t *scaled_font,
 
     if (--page->num_glyphs == 0) {
 	CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-	/* Temporarily disconnect callback to avoid recursive locking */
-	cairo_scaled_glyph_page_cache.entry_destroy = NULL;
-	_cairo_cache_remove (&cairo_scaled_glyph_page_cache,
-		             &page->cache_entry);
+	_cairo_scaled_glyph_page_cache_remove (page);
 	_cairo_scaled_glyph_page_destroy (scaled_font, page);
-	cairo_scaled_glyph_page_cache.entry_destroy = _cairo_scaled_glyph_page_pluck;
 	CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
     }
 }
@@ -2963,6 +3219,7 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
     cairo_int_status_t		 status = CAIRO_INT_STATUS_SUCCESS;
     cairo_scaled_glyph_t	*scaled_glyph;
     cairo_scaled_glyph_info_t	 need_info;
+    unsigned long		 footprint, new_footprint;
 
     *scaled_glyph_ret = NULL;
 
@@ -2988,6 +3245,9 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 	memset (scaled_glyph, 0, sizeof (cairo_scaled_glyph_t));
 	_cairo_scaled_glyph_set_index (scaled_glyph, index);
 	cairo_list_init (&scaled_glyph->dev_privates);
+	scaled_glyph->page = cairo_list_last_entry (&scaled_font->glyph_pages,
+						    cairo_scaled_glyph_page_t,
+						    link);
 
 	/* ask backend to initialize metrics and shape fields */
 	status =
@@ -3005,6 +3265,14 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 	    _cairo_scaled_font_free_last_glyph (scaled_font, scaled_glyph);
 	    goto err;
 	}
+
+	scaled_font->glyph_cache_misses++;
+	footprint = _cairo_scaled_glyph_footprint (scaled_glyph);
+	if (footprint)
+	    _cairo_scaled_glyph_page_resize (scaled_glyph->page, 0, footprint);
+    } else {
+	scaled_font->glyph_cache_hits++;
+	scaled_glyph->page->referenced = TRUE;
     }
 
     /*
@@ -3013,12 +3281,18 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
      */
     need_info = info & ~scaled_glyph->has_info;
     if (need_info) {
+	footprint = _cairo_scaled_glyph_footprint (scaled_glyph);
 	status = scaled_font->backend->scaled_glyph_init (scaled_font,
 							  scaled_glyph,
 							  need_info);
 	if (unlikely (status))
 	    goto err;
 
+	/* Replacing an image or outline can also shrink the footprint */
+	new_footprint = _cairo_scaled_glyph_footprint (scaled_glyph);
+	if (new_footprint != footprint)
+	    _cairo_scaled_glyph_page_resize (scaled_glyph->page, footprint, new_footprint);
+
 	/* Don't trust the scaled_glyph_init() return value, the font
 	 * backend may not even know about some of the info.  For example,
 	 * no backend other than the user-fonts knows about recording-surface
@@ -3168,3 +3442,92 @@ cairo_scaled_font_get_font_options (cairo_scaled_font_t		*scaled_font,
     _cairo_font_options_init_copy (options, &scaled_font->options);
 }
 slim_hidden_def (cairo_scaled_font_get_font_options);
+
+/**
+ * cairo_glyph_cache_set_max_size:
+ * @max_size: the maximum number of bytes to keep in the glyph cache
+ *
+ * Sets the budget of the glyph cache shared by all scaled fonts. The
+ * cache is charged for each glyph's metrics record plus any image or
+ * outline that has been rendered for it. Once the cache holds more than
+ * @max_size bytes the least recently used glyphs are discarded, and
+ * rendered again should they be needed later.
+ *
+ * Glyphs belonging to a font that is in the middle of being drawn are
+ * never discarded, so the cache may briefly exceed a very small budget.
+ *
+ * Since: 1.14.12
+ **/
+void
+cairo_glyph_cache_set_max_size (unsigned long max_size)
+{
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    cairo_scaled_glyph_page_cache.max_size = max_size;
+    if (cairo_scaled_glyph_page_cache.freeze_count == 0)
+	_cairo_scaled_glyph_page_cache_shrink ();
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+}
+
+/**
+ * cairo_glyph_cache_get_max_size:
+ *
+ * Gets the budget of the glyph cache shared by all scaled fonts. See
+ * cairo_glyph_cache_set_max_size().
+ *
+ * Return value: the maximum number of bytes kept in the glyph cache.
+ *
+ * Since: 1.14.12
+ **/
+unsigned long
+cairo_glyph_cache_get_max_size (void)
+{
+    unsigned long max_size;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    max_size = cairo_scaled_glyph_page_cache.max_size;
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+
+    return max_size;
+}
+
+/**
+ * cairo_glyph_cache_get_statistics:
+ * @size: return value for the number of bytes currently cached, or %NULL
+ * @hits: return value for the number of glyph lookups found in the cache, or %NULL
+ * @misses: return value for the number of glyph lookups that had to be rendered, or %NULL
+ * @evictions: return value for the number of times glyphs were discarded to
+ * stay within budget, or %NULL
+ *
+ * Reports how well the glyph cache shared by all scaled fonts is
+ * doing, for tuning cairo_glyph_cache_set_max_size(). Each eviction
+ * discards a page of glyphs belonging to one font.
+ *
+ * Lookups are counted by each scaled font and reported in batches, so
+ * the most recent few lookups of a font may not be included yet. The
+ * counters are reset by cairo_debug_reset_static_data().
+ *
+ * Since: 1.14.12
+ **/
+void
+cairo_glyph_cache_get_statistics (unsigned long *size,
+				  unsigned long *hits,
+				  unsigned long *misses,
+				  unsigned long *evictions)
+{
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    if (size)
+	*size = cairo_scaled_glyph_page_cache.size;
+    if (hits)
+	*hits = cairo_scaled_glyph_page_cache.hits;
+    if (misses)
+	*misses = cairo_scaled_glyph_page_cache.misses;
+    if (evictions)
+	*evictions = cairo_scaled_glyph_page_cache.evictions;
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+}
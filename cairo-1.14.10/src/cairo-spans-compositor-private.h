@@ -54,6 +54,7 @@ struct cairo_spans_compositor {
 
     unsigned int flags;
 #define CAIRO_SPANS_COMPOSITOR_HAS_LERP 0x1
+#define CAIRO_SPANS_COMPOSITOR_HAS_BANDS 0x2
 
     /* pixel-aligned fast paths */
     cairo_int_status_t (*fill_boxes)	(void			*surface,
@@ -100,6 +101,11 @@ struct cairo_spans_compositor {
 
     void (*renderer_fini) (cairo_abstract_span_renderer_t *renderer,
 			   cairo_int_status_t status);
+
+    /* Called on the calling thread for each band renderer once all are
+     * initialised, before any band is rendered on a worker thread;
+     * required with CAIRO_SPANS_COMPOSITOR_HAS_BANDS. */
+    cairo_int_status_t (*renderer_band_init) (cairo_abstract_span_renderer_t *renderer);
 };
 
 cairo_private void
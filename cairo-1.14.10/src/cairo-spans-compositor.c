@@ -44,6 +44,7 @@
 #include "cairo-compositor-private.h"
 #include "cairo-clip-inline.h"
 #include "cairo-clip-private.h"
+#include "cairo-image-surface-inline.h"
 #include "cairo-image-surface-private.h"
 #include "cairo-paginated-private.h"
 #include "cairo-pattern-inline.h"
@@ -54,6 +55,10 @@
 #include "cairo-surface-snapshot-private.h"
 #include "cairo-surface-observer-private.h"
 
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 typedef struct {
     cairo_polygon_t	*polygon;
     cairo_fill_rule_t	 fill_rule;
@@ -746,6 +751,224 @@ cleanup_converter:
     return status;
 }
 
+static cairo_scan_converter_t *
+create_polygon_converter (const cairo_rectangle_int_t	*r,
+			  cairo_polygon_t		*polygon,
+			  cairo_fill_rule_t		 fill_rule,
+			  cairo_antialias_t		 antialias,
+			  cairo_int_status_t		*status)
+{
+    cairo_scan_converter_t *converter;
+
+    if (antialias == CAIRO_ANTIALIAS_FAST) {
+	converter = _cairo_tor22_scan_converter_create (r->x, r->y,
+							r->x + r->width,
+							r->y + r->height,
+							fill_rule, antialias);
+	*status = _cairo_tor22_scan_converter_add_polygon (converter, polygon);
+    } else if (antialias == CAIRO_ANTIALIAS_NONE) {
+	converter = _cairo_mono_scan_converter_create (r->x, r->y,
+						       r->x + r->width,
+						       r->y + r->height,
+						       fill_rule);
+	*status = _cairo_mono_scan_converter_add_polygon (converter, polygon);
+    } else if (antialias == CAIRO_ANTIALIAS_BEST) {
+	converter = _cairo_analytic_scan_converter_create (r->x, r->y,
+							   r->x + r->width,
+							   r->y + r->height,
+							   fill_rule);
+	*status = _cairo_analytic_scan_converter_add_polygon (converter, polygon);
+    } else {
+	converter = _cairo_tor_scan_converter_create (r->x, r->y,
+						      r->x + r->width,
+						      r->y + r->height,
+						      fill_rule, antialias);
+	*status = _cairo_tor_scan_converter_add_polygon (converter, polygon);
+    }
+
+    return converter;
+}
+
+#if CAIRO_HAS_REAL_PTHREAD
+/* Banded rasterisation: a large polygon is cut into horizontal bands,
+ * each with its own scan converter and span renderer. The renderers are
+ * set up and finished on the calling thread, as that is where sources
+ * are acquired and released; only scan conversion and span rendering
+ * run on the workers. Before they start, renderer_band_init() gives
+ * each renderer whatever it needs so that rendering its band touches
+ * nothing outside its own rows and writes to no state shared with the
+ * other bands.
+ */
+#define BAND_MIN_HEIGHT 64
+#define BAND_MIN_AREA (512 * 512)
+
+typedef struct _cairo_spans_band {
+    cairo_composite_rectangles_t extents;
+    cairo_abstract_span_renderer_t renderer;
+    cairo_int_status_t status;
+} cairo_spans_band_t;
+
+typedef struct _cairo_spans_bands {
+    cairo_mutex_t mutex;
+    int next;
+
+    cairo_polygon_t *polygon;
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+
+    cairo_spans_band_t *band;
+    int num_bands;
+} cairo_spans_bands_t;
+
+static int
+polygon_num_bands (const cairo_spans_compositor_t	*compositor,
+		   const cairo_composite_rectangles_t	*extents)
+{
+    const cairo_rectangle_int_t *r = &extents->unbounded;
+    int num_threads, num_bands;
+
+    if ((compositor->flags & CAIRO_SPANS_COMPOSITOR_HAS_BANDS) == 0)
+	return 0;
+
+    if (! _cairo_surface_is_image (extents->surface))
+	return 0;
+
+    num_threads = to_image_surface (extents->surface)->render_threads;
+    if (num_threads < 2)
+	return 0;
+
+    if ((int64_t) r->width * r->height < BAND_MIN_AREA)
+	return 0;
+
+    /* A couple of bands per thread evens out uneven edge density */
+    num_bands = MIN (2 * num_threads, r->height / BAND_MIN_HEIGHT);
+    return num_bands > 1 ? num_bands : 0;
+}
+
+static void *
+band_worker (void *closure)
+{
+    cairo_spans_bands_t *bands = closure;
+
+    for (;;) {
+	cairo_spans_band_t *band;
+	cairo_scan_converter_t *converter;
+	cairo_int_status_t status;
+	int i;
+
+	CAIRO_MUTEX_LOCK (bands->mutex);
+	i = bands->next++;
+	CAIRO_MUTEX_UNLOCK (bands->mutex);
+	if (i >= bands->num_bands)
+	    break;
+
+	band = &bands->band[i];
+	converter = create_polygon_converter (&band->extents.unbounded,
+					      bands->polygon,
+					      bands->fill_rule,
+					      bands->antialias,
+					      &status);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	    status = converter->generate (converter, &band->renderer.base);
+	converter->destroy (converter);
+
+	band->status = status;
+    }
+
+    return NULL;
+}
+
+static cairo_int_status_t
+composite_polygon_bands (const cairo_spans_compositor_t	*compositor,
+			 cairo_composite_rectangles_t		*extents,
+			 cairo_polygon_t			*polygon,
+			 cairo_fill_rule_t			 fill_rule,
+			 cairo_antialias_t			 antialias,
+			 int					 num_bands)
+{
+    const cairo_rectangle_int_t *r = &extents->unbounded;
+    pthread_t threads[CAIRO_IMAGE_MAX_RENDER_THREADS];
+    cairo_spans_bands_t bands;
+    cairo_int_status_t status;
+    int band_height, num_threads, i, n;
+
+    TRACE ((stderr, "%s - num_bands=%d\n", __FUNCTION__, num_bands));
+
+    band_height = (r->height + num_bands - 1) / num_bands;
+    num_bands = (r->height + band_height - 1) / band_height;
+
+    bands.band = _cairo_malloc_ab (num_bands, sizeof (cairo_spans_band_t));
+    if (unlikely (bands.band == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    bands.polygon = polygon;
+    bands.fill_rule = fill_rule;
+    bands.antialias = antialias;
+    bands.num_bands = num_bands;
+    bands.next = 0;
+
+    status = CAIRO_INT_STATUS_SUCCESS;
+    for (n = 0; n < num_bands; n++) {
+	cairo_spans_band_t *band = &bands.band[n];
+	cairo_rectangle_int_t rows;
+
+	rows.x = r->x;
+	rows.width = r->width;
+	rows.y = r->y + n * band_height;
+	rows.height = MIN (band_height, r->y + r->height - rows.y);
+
+	band->extents = *extents;
+	_cairo_rectangle_intersect (&band->extents.unbounded, &rows);
+	_cairo_rectangle_intersect (&band->extents.bounded, &rows);
+
+	status = compositor->renderer_init (&band->renderer, &band->extents,
+					    antialias, FALSE);
+	if (unlikely (status)) {
+	    n++;
+	    goto cleanup_renderers;
+	}
+    }
+
+    for (i = 0; i < num_bands; i++) {
+	status = compositor->renderer_band_init (&bands.band[i].renderer);
+	if (unlikely (status))
+	    goto cleanup_renderers;
+    }
+
+    CAIRO_MUTEX_INIT (bands.mutex);
+
+    num_threads = to_image_surface (extents->surface)->render_threads;
+    num_threads = MIN (num_threads, num_bands) - 1;
+    for (i = 0; i < num_threads; i++) {
+	if (pthread_create (&threads[i], NULL, band_worker, &bands))
+	    break;
+    }
+
+    /* Whatever is left over, including everything should no thread
+     * start, is rendered here. */
+    band_worker (&bands);
+
+    while (i--)
+	pthread_join (threads[i], NULL);
+
+    CAIRO_MUTEX_FINI (bands.mutex);
+
+    for (i = 0; i < num_bands; i++) {
+	if (unlikely (bands.band[i].status)) {
+	    status = bands.band[i].status;
+	    break;
+	}
+    }
+
+cleanup_renderers:
+    for (i = 0; i < n; i++)
+	compositor->renderer_fini (&bands.band[i].renderer, status);
+
+    free (bands.band);
+    return status;
+}
+#endif
+
 static cairo_int_status_t
 composite_polygon (const cairo_spans_compositor_t	*compositor,
 		   cairo_composite_rectangles_t		 *extents,
@@ -770,27 +993,15 @@ composite_polygon (const cairo_spans_compositor_t	*compositor,
 							   polygon,
 							   fill_rule, antialias);
     } else {
-	const cairo_rectangle_int_t *r = &extents->unbounded;
-
-	if (antialias == CAIRO_ANTIALIAS_FAST) {
-	    converter = _cairo_tor22_scan_converter_create (r->x, r->y,
-							    r->x + r->width,
-							    r->y + r->height,
-							    fill_rule, antialias);
-	    status = _cairo_tor22_scan_converter_add_polygon (converter, polygon);
-	} else if (antialias == CAIRO_ANTIALIAS_NONE) {
-	    converter = _cairo_mono_scan_converter_create (r->x, r->y,
-							   r->x + r->width,
-							   r->y + r->height,
-							   fill_rule);
-	    status = _cairo_mono_scan_converter_add_polygon (converter, polygon);
-	} else {
-	    converter = _cairo_tor_scan_converter_create (r->x, r->y,
-							  r->x + r->width,
-							  r->y + r->height,
-							  fill_rule, antialias);
-	    status = _cairo_tor_scan_converter_add_polygon (converter, polygon);
-	}
+#if CAIRO_HAS_REAL_PTHREAD
+	int num_bands = polygon_num_bands (compositor, extents);
+	if (num_bands)
+	    return composite_polygon_bands (compositor, extents, polygon,
+					    fill_rule, antialias, num_bands);
+#endif
+
+	converter = create_polygon_converter (&extents->unbounded, polygon,
+					      fill_rule, antialias, &status);
     }
     if (unlikely (status))
 	goto cleanup_converter;
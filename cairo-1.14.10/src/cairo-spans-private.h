@@ -115,6 +115,16 @@ cairo_private cairo_status_t
 _cairo_mono_scan_converter_add_polygon (void		*converter,
 					const cairo_polygon_t *polygon);
 
+cairo_private cairo_scan_converter_t *
+_cairo_analytic_scan_converter_create (int			xmin,
+				       int			ymin,
+				       int			xmax,
+				       int			ymax,
+				       cairo_fill_rule_t	fill_rule);
+cairo_private cairo_status_t
+_cairo_analytic_scan_converter_add_polygon (void		*converter,
+					    const cairo_polygon_t *polygon);
+
 cairo_private cairo_scan_converter_t *
 _cairo_clip_tor_scan_converter_create (cairo_clip_t *clip,
 				       cairo_polygon_t *polygon,
@@ -2067,6 +2067,17 @@ _pattern_has_error (const cairo_pattern_t *pattern)
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Image sources may still have drawing pending, see
+ * cairo_image_surface_set_deferred() */
+static cairo_status_t
+_pattern_flush_deferred (const cairo_pattern_t *pattern)
+{
+    if (pattern->type != CAIRO_PATTERN_TYPE_SURFACE)
+	return CAIRO_STATUS_SUCCESS;
+
+    return _cairo_image_surface_flush_deferred_source (((const cairo_surface_pattern_t *) pattern)->surface);
+}
+
 static cairo_bool_t
 nothing_to_do (cairo_surface_t *surface,
 	       cairo_operator_t op,
@@ -2107,6 +2118,9 @@ _cairo_surface_paint (cairo_surface_t		*surface,
 	return CAIRO_STATUS_SUCCESS;
 
     status = _pattern_has_error (source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (source);
     if (unlikely (status))
 	return status;
 
@@ -2152,10 +2166,16 @@ _cairo_surface_mask (cairo_surface_t		*surface,
     }
 
     status = _pattern_has_error (source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (source);
     if (unlikely (status))
 	return status;
 
     status = _pattern_has_error (mask);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (mask);
     if (unlikely (status))
 	return status;
 
@@ -2211,10 +2231,16 @@ _cairo_surface_fill_stroke (cairo_surface_t	    *surface,
     }
 
     status = _pattern_has_error (fill_source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (fill_source);
     if (unlikely (status))
 	return status;
 
     status = _pattern_has_error (stroke_source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (stroke_source);
     if (unlikely (status))
 	return status;
 
@@ -2286,6 +2312,9 @@ _cairo_surface_stroke (cairo_surface_t			*surface,
 	return CAIRO_STATUS_SUCCESS;
 
     status = _pattern_has_error (source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (source);
     if (unlikely (status))
 	return status;
 
@@ -2331,6 +2360,9 @@ _cairo_surface_fill (cairo_surface_t		*surface,
 	return CAIRO_STATUS_SUCCESS;
 
     status = _pattern_has_error (source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (source);
     if (unlikely (status))
 	return status;
 
@@ -2562,6 +2594,9 @@ _cairo_surface_show_text_glyphs (cairo_surface_t	    *surface,
 	return CAIRO_STATUS_SUCCESS;
 
     status = _pattern_has_error (source);
+    if (unlikely (status))
+	return status;
+    status = _pattern_flush_deferred (source);
     if (unlikely (status))
 	return status;
 
@@ -96,6 +96,7 @@
 #include "cairoint.h"
 #include "cairo-spans-private.h"
 #include "cairo-error-private.h"
+#include "test-tor-scan-converter.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -260,6 +261,339 @@ typedef int grid_scaled_y_t;
 
 #define UNROLL3(x) x x x
 
+/*-------------------------------------------------------------------------
+ * Dense coverage kernels
+ *
+ * Rows crossed by many edges accumulate their cells into one
+ * height/area pair per pixel instead of the sparse cell list.  A
+ * kernel then turns such a row into alpha values: a running sum of the
+ * covered heights, less the uncovered area, scaled by
+ * GRID_AREA_TO_ALPHA().  The kernels also clear the row for reuse.
+ * They work on multiples of 16 pixels from 16 byte aligned arrays.
+ *
+ * The C version is the reference; the vector versions must produce
+ * identical results and are only built for the default grid.
+ */
+typedef void
+(*coverage_to_alpha_func_t) (int16_t *covered_height,
+			     int16_t *uncovered_area,
+			     uint8_t *alpha,
+			     int width,
+			     int cover);
+
+static void
+coverage_to_alpha_c (int16_t *covered_height,
+		     int16_t *uncovered_area,
+		     uint8_t *alpha,
+		     int width,
+		     int cover)
+{
+    int16_t c = cover;
+    int i;
+
+    for (i = 0; i < width; i++) {
+	int16_t area;
+
+	c += covered_height[i]*GRID_X*2;
+	area = c - uncovered_area[i];
+	alpha[i] = GRID_AREA_TO_ALPHA (area);
+
+	covered_height[i] = 0;
+	uncovered_area[i] = 0;
+    }
+}
+
+#if GRID_XY == 2*256*15
+#  if defined(__SSE2__)
+#    define TOR_HAVE_SSE2 1
+#    define TOR_SSE2_TARGET
+#  elif (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5
+#    define TOR_HAVE_SSE2 1
+#    define TOR_SSE2_TARGET __attribute__((target ("sse2")))
+#    define TOR_SSE2_RUNTIME 1
+#  endif
+#  if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define TOR_HAVE_NEON 1
+#  endif
+#  if defined(__ALTIVEC__)
+#    define TOR_HAVE_ALTIVEC 1
+#  elif defined(__amigaos4__) && __GNUC__ >= 5
+#    define TOR_HAVE_ALTIVEC 1
+#    define TOR_ALTIVEC_RUNTIME 1
+#  endif
+#endif
+
+#if TOR_HAVE_SSE2
+#include <emmintrin.h>
+
+/* alpha = (area*17 + 256) >> 9, computed as ((area*17 >> 8) + 1) >> 1
+ * to stay within 16 bit lanes.  Like the C version only the low byte
+ * is kept, so rounding errors outside [0, GRID_XY] wrap identically. */
+static TOR_SSE2_TARGET void
+coverage_to_alpha_sse2 (int16_t *covered_height,
+			int16_t *uncovered_area,
+			uint8_t *alpha,
+			int width,
+			int cover)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i one = _mm_set1_epi16 (1);
+    const __m128i mask = _mm_set1_epi16 (0xff);
+    const __m128i k = _mm_set1_epi16 (17 << 8);
+    __m128i c = _mm_set1_epi16 (cover);
+    int i, j;
+
+    for (i = 0; i < width; i += 16) {
+	__m128i a[2];
+
+	for (j = 0; j < 2; j++) {
+	    __m128i *h = (__m128i *) (covered_height + i + 8*j);
+	    __m128i *u = (__m128i *) (uncovered_area + i + 8*j);
+	    __m128i v;
+
+	    v = _mm_slli_epi16 (_mm_load_si128 (h), 9);
+	    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 2));
+	    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 4));
+	    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 8));
+	    v = _mm_add_epi16 (v, c);
+
+	    c = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+	    c = _mm_unpackhi_epi64 (c, c);
+
+	    v = _mm_sub_epi16 (v, _mm_load_si128 (u));
+	    v = _mm_srai_epi16 (_mm_add_epi16 (_mm_mulhi_epi16 (v, k), one), 1);
+	    a[j] = _mm_and_si128 (v, mask);
+
+	    _mm_store_si128 (h, zero);
+	    _mm_store_si128 (u, zero);
+	}
+
+	_mm_store_si128 ((__m128i *) (alpha + i), _mm_packus_epi16 (a[0], a[1]));
+    }
+}
+#endif
+
+#if TOR_HAVE_NEON
+#include <arm_neon.h>
+
+static void
+coverage_to_alpha_neon (int16_t *covered_height,
+			int16_t *uncovered_area,
+			uint8_t *alpha,
+			int width,
+			int cover)
+{
+    const int16x8_t zero = vdupq_n_s16 (0);
+    int16x8_t c = vdupq_n_s16 (cover);
+    int i, j;
+
+    for (i = 0; i < width; i += 16) {
+	uint8x8_t a[2];
+
+	for (j = 0; j < 2; j++) {
+	    int16_t *h = covered_height + i + 8*j;
+	    int16_t *u = uncovered_area + i + 8*j;
+	    int16x8_t v;
+
+	    v = vshlq_n_s16 (vld1q_s16 (h), 9);
+	    v = vaddq_s16 (v, vextq_s16 (zero, v, 7));
+	    v = vaddq_s16 (v, vextq_s16 (zero, v, 6));
+	    v = vaddq_s16 (v, vextq_s16 (zero, v, 4));
+	    v = vaddq_s16 (v, c);
+
+	    c = vdupq_lane_s16 (vget_high_s16 (v), 3);
+
+	    v = vsubq_s16 (v, vld1q_s16 (u));
+	    v = vcombine_s16 (vrshrn_n_s32 (vmull_n_s16 (vget_low_s16 (v), 17), 9),
+			      vrshrn_n_s32 (vmull_n_s16 (vget_high_s16 (v), 17), 9));
+	    a[j] = vmovn_u16 (vreinterpretq_u16_s16 (v));
+
+	    vst1q_s16 (h, zero);
+	    vst1q_s16 (u, zero);
+	}
+
+	vst1q_u8 (alpha + i, vcombine_u8 (a[0], a[1]));
+    }
+}
+#endif
+
+#if TOR_HAVE_ALTIVEC
+#if TOR_ALTIVEC_RUNTIME
+#include <proto/exec.h>
+#pragma GCC push_options
+#pragma GCC target ("altivec")
+#endif
+#include <altivec.h>
+#undef vector
+#undef pixel
+#undef bool
+
+/* vec_madds() gives area*17 >> 8 directly as (area*2176) >> 15; the
+ * low byte is masked off before packing to wrap like the C version. */
+static void
+coverage_to_alpha_altivec (int16_t *covered_height,
+			   int16_t *uncovered_area,
+			   uint8_t *alpha,
+			   int width,
+			   int cover)
+{
+    const __vector signed short zero = vec_splat_s16 (0);
+    const __vector signed short k = vec_splats ((signed short) (17 << 7));
+    const __vector unsigned short shift = vec_splat_u16 (9);
+    const __vector signed short mask = vec_splats ((signed short) 0xff);
+    __vector signed short c = vec_splats ((signed short) cover);
+    int i, j;
+
+    for (i = 0; i < width; i += 16) {
+	__vector signed short a[2];
+
+	for (j = 0; j < 2; j++) {
+	    int offset = 2 * (i + 8*j);
+	    __vector signed short v;
+
+	    v = vec_sl (vec_ld (offset, covered_height), shift);
+	    v = vec_add (v, vec_sld (zero, v, 14));
+	    v = vec_add (v, vec_sld (zero, v, 12));
+	    v = vec_add (v, vec_sld (zero, v, 8));
+	    v = vec_add (v, c);
+
+	    c = vec_splat (v, 7);
+
+	    v = vec_sub (v, vec_ld (offset, uncovered_area));
+	    v = vec_avg (vec_madds (v, k, zero), zero);
+	    a[j] = vec_and (v, mask);
+
+	    vec_st (zero, offset, covered_height);
+	    vec_st (zero, offset, uncovered_area);
+	}
+
+	vec_st (vec_packsu (a[0], a[1]), i, alpha);
+    }
+}
+
+#if TOR_ALTIVEC_RUNTIME
+#pragma GCC pop_options
+#endif
+#endif
+
+/* Picks the best kernel this CPU can run, or NULL if there is none. */
+static coverage_to_alpha_func_t
+coverage_to_alpha_detect (void)
+{
+#if TOR_HAVE_SSE2
+#if TOR_SSE2_RUNTIME
+    if (__builtin_cpu_supports ("sse2"))
+#endif
+	return coverage_to_alpha_sse2;
+#endif
+#if TOR_HAVE_NEON
+    return coverage_to_alpha_neon;
+#endif
+#if TOR_HAVE_ALTIVEC
+#if TOR_ALTIVEC_RUNTIME
+    {
+	uint32 vector_unit = VECTORTYPE_NONE;
+
+	IExec->GetCPUInfoTags (GCIT_VectorUnit, &vector_unit, TAG_DONE);
+	if (vector_unit == VECTORTYPE_ALTIVEC)
+	    return coverage_to_alpha_altivec;
+    }
+#else
+    return coverage_to_alpha_altivec;
+#endif
+#endif
+    return NULL;
+}
+
+/* CAIRO_TOR_COVERAGE may be set to "sparse", "scalar" or "simd" to
+ * force the cell list, the reference kernel or the vector kernel.  It
+ * is read once, along with the CPU detection, on the first converter
+ * created.  Without a vector kernel only the cell list is used unless
+ * asked for otherwise.  The test suite and the benchmarks switch
+ * between the strategies within a process through
+ * _cairo_test_tor_scan_converter_set_coverage(). */
+enum {
+    COVERAGE_UNRESOLVED,
+    COVERAGE_SPARSE,
+    COVERAGE_SCALAR,
+    COVERAGE_SIMD
+};
+
+static cairo_atomic_int_t coverage_to_alpha_mode;
+static int coverage_to_alpha_default;
+static coverage_to_alpha_func_t coverage_to_alpha_simd;
+
+static int
+coverage_to_alpha_resolve (void)
+{
+    const char *env;
+    int mode;
+
+    /* Any thread racing us here detects the same kernel */
+    coverage_to_alpha_simd = coverage_to_alpha_detect ();
+    mode = coverage_to_alpha_simd ? COVERAGE_SIMD : COVERAGE_SPARSE;
+
+    env = getenv ("CAIRO_TOR_COVERAGE");
+    if (env != NULL) {
+	if (strcmp (env, "sparse") == 0)
+	    mode = COVERAGE_SPARSE;
+	else if (strcmp (env, "scalar") == 0)
+	    mode = COVERAGE_SCALAR;
+    }
+    coverage_to_alpha_default = mode;
+
+    _cairo_atomic_int_cmpxchg (&coverage_to_alpha_mode,
+			       COVERAGE_UNRESOLVED, mode);
+    return _cairo_atomic_int_get (&coverage_to_alpha_mode);
+}
+
+static coverage_to_alpha_func_t
+coverage_to_alpha_get (void)
+{
+    int mode = _cairo_atomic_int_get (&coverage_to_alpha_mode);
+
+    if (unlikely (mode == COVERAGE_UNRESOLVED))
+	mode = coverage_to_alpha_resolve ();
+
+    switch (mode) {
+    case COVERAGE_SCALAR:
+	return coverage_to_alpha_c;
+    case COVERAGE_SIMD:
+	return coverage_to_alpha_simd;
+    default:
+	return NULL;
+    }
+}
+
+/* Converters created after this use @coverage, one of "sparse",
+ * "scalar" or "simd", or the default strategy again if it is NULL.
+ * Returns FALSE, changing nothing, for a strategy this CPU can not run. */
+cairo_bool_t
+_cairo_test_tor_scan_converter_set_coverage (const char *coverage)
+{
+    int old, mode;
+
+    old = _cairo_atomic_int_get (&coverage_to_alpha_mode);
+    if (old == COVERAGE_UNRESOLVED)
+	old = coverage_to_alpha_resolve ();
+
+    if (coverage == NULL)
+	mode = coverage_to_alpha_default;
+    else if (strcmp (coverage, "sparse") == 0)
+	mode = COVERAGE_SPARSE;
+    else if (strcmp (coverage, "scalar") == 0)
+	mode = COVERAGE_SCALAR;
+    else if (strcmp (coverage, "simd") == 0 && coverage_to_alpha_simd != NULL)
+	mode = COVERAGE_SIMD;
+    else
+	return FALSE;
+
+    while (! _cairo_atomic_int_cmpxchg (&coverage_to_alpha_mode, old, mode))
+	old = _cairo_atomic_int_get (&coverage_to_alpha_mode);
+
+    return TRUE;
+}
+
 struct quorem {
     int32_t quo;
     int64_t rem;
@@ -432,6 +766,24 @@ struct cell_list {
 	struct pool base[1];
 	struct cell embedded[32];
     } cell_pool;
+
+    /* Cells allocated in the current row, or spans emitted if it was
+     * dense; decides whether the next row is dense. */
+    int num_cells;
+
+    /* Per pixel accumulation for dense rows.  Cells left of the clip
+     * only count towards @left, those right of it are dropped into
+     * the spare slot at @stride. */
+    struct {
+	int enabled;
+	int xmin, width, stride;
+	int left;
+	int16_t *covered_height;
+	int16_t *uncovered_area;
+	uint8_t *alpha;
+	void *base;
+	coverage_to_alpha_func_t to_alpha;
+    } dense;
 };
 
 struct cell_pair {
@@ -628,14 +980,54 @@ cell_list_init(struct cell_list *cells, jmp_buf *jmp)
     cells->head.x = INT_MIN;
     cells->head.next = &cells->tail;
     cell_list_rewind (cells);
+    cells->num_cells = 0;
+    memset (&cells->dense, 0, sizeof (cells->dense));
 }
 
 static void
 cell_list_fini(struct cell_list *cells)
 {
+    free (cells->dense.base);
     pool_fini (cells->cell_pool.base);
 }
 
+/* Prepares the dense arrays for rows of pixels [xmin, xmax).  Returns
+ * FALSE if dense rows are not to be used. */
+static int
+cell_list_init_dense (struct cell_list *cells, int xmin, int xmax)
+{
+    int width = xmax - xmin;
+    int stride = (width + 15) & -16;
+    char *base;
+
+    cells->dense.enabled = FALSE;
+    if (cells->dense.to_alpha == NULL || width < 32)
+	return FALSE;
+
+    if (cells->dense.base == NULL || stride > cells->dense.stride) {
+	free (cells->dense.base);
+	cells->dense.base = NULL;
+
+	/* Two arrays of int16_t with a spare slot each, plus alpha */
+	base = _cairo_malloc_ab (stride + 16, 5);
+	if (unlikely (base == NULL))
+	    return FALSE;
+
+	cells->dense.base = base;
+	base = (char *) (((uintptr_t) base + 15) & -16);
+	cells->dense.covered_height = (int16_t *) base;
+	cells->dense.uncovered_area = (int16_t *) (base + 2*stride + 16);
+	cells->dense.alpha = (uint8_t *) (base + 4*stride + 32);
+	memset (base, 0, 4*stride + 32);
+    }
+
+    cells->dense.xmin = xmin;
+    cells->dense.width = width;
+    cells->dense.stride = stride;
+    cells->dense.left = 0;
+    return TRUE;
+}
+
 /* Empty the cell list.  This is called at the start of every pixel
  * row. */
 inline static void
@@ -644,6 +1036,23 @@ cell_list_reset (struct cell_list *cells)
     cell_list_rewind (cells);
     cells->head.next = &cells->tail;
     pool_reset (cells->cell_pool.base);
+    cells->num_cells = 0;
+}
+
+/* Adds to the pixel at x of a dense row. */
+inline static void
+dense_add (struct cell_list *cells, int x, int area, int height)
+{
+    x -= cells->dense.xmin;
+    if (x < 0) {
+	cells->dense.left += height;
+	return;
+    }
+    if (x >= cells->dense.width)
+	x = cells->dense.stride;
+
+    cells->dense.uncovered_area[x] += area;
+    cells->dense.covered_height[x] += height;
 }
 
 inline static struct cell *
@@ -658,6 +1067,7 @@ cell_list_alloc (struct cell_list *cells,
     tail->next = cell;
     cell->x = x;
     *(uint32_t *)&cell->uncovered_area = 0;
+    cells->num_cells++;
 
     return cell;
 }
@@ -742,6 +1152,15 @@ cell_list_add_subspan(struct cell_list *cells,
     GRID_X_TO_INT_FRAC(x1, ix1, fx1);
     GRID_X_TO_INT_FRAC(x2, ix2, fx2);
 
+    if (cells->dense.enabled) {
+	if (ix1 != ix2) {
+	    dense_add (cells, ix1, 2*fx1, 1);
+	    dense_add (cells, ix2, -2*fx2, -1);
+	} else
+	    dense_add (cells, ix1, 2*(fx1-fx2), 0);
+	return;
+    }
+
     if (ix1 != ix2) {
 	struct cell_pair p;
 	p = cell_list_find_pair(cells, ix1, ix2);
@@ -834,6 +1253,11 @@ cell_list_render_edge(struct cell_list *cells,
 
     /* Edge is entirely within a column? */
     if (ix1 == ix2) {
+	if (cells->dense.enabled) {
+	    dense_add (cells, ix1, sign*(fx1 + fx2)*GRID_Y, sign*GRID_Y);
+	    return;
+	}
+
 	/* We always know that ix1 is >= the cell list cursor in this
 	 * case due to the no-intersections precondition.  */
 	struct cell *cell = cell_list_find(cells, ix1);
@@ -877,6 +1301,37 @@ cell_list_render_edge(struct cell_list *cells,
 	y.quo = tmp / dx;
 	y.rem = tmp % dx;
 
+	if (cells->dense.enabled) {
+	    dense_add (cells, ix1, sign*y.quo*(GRID_X + fx1), sign*y.quo);
+	    y_last = y.quo;
+
+	    if (ix1+1 < ix2) {
+		struct quorem dydx_full;
+
+		dydx_full.quo = GRID_Y * GRID_X * edge->dy / dx;
+		dydx_full.rem = GRID_Y * GRID_X * edge->dy % dx;
+
+		while (++ix1 != ix2) {
+		    y.quo += dydx_full.quo;
+		    y.rem += dydx_full.rem;
+		    if (y.rem >= dx) {
+			y.quo++;
+			y.rem -= dx;
+		    }
+
+		    dense_add (cells, ix1,
+			       sign*(y.quo - y_last)*GRID_X,
+			       sign*(y.quo - y_last));
+		    y_last = y.quo;
+		}
+	    }
+
+	    dense_add (cells, ix2,
+		       sign*(GRID_Y - y_last)*fx2,
+		       sign*(GRID_Y - y_last));
+	    return;
+	}
+
 	/* When rendering a previous edge on the active list we may
 	 * advance the cell list cursor past the leftmost pixel of the
 	 * current edge even though the two edges don't intersect.
@@ -1357,6 +1812,7 @@ _glitter_scan_converter_init(glitter_scan_converter_t *converter, jmp_buf *jmp)
     polygon_init(converter->polygon, jmp);
     active_list_init(converter->active);
     cell_list_init(converter->coverages, jmp);
+    converter->coverages->dense.to_alpha = coverage_to_alpha_get ();
     converter->xmin=0;
     converter->ymin=0;
     converter->xmax=0;
@@ -1712,6 +2168,61 @@ blit_a1 (struct cell_list *cells,
     return renderer->render_rows (renderer, y, height, spans, num_spans);
 }
 
+static glitter_status_t
+blit_dense (struct cell_list *cells,
+	    cairo_span_renderer_t *renderer,
+	    cairo_half_open_span_t *spans,
+	    int y, int height,
+	    int xmin, int xmax)
+{
+    uint8_t *alpha = cells->dense.alpha;
+    int width = cells->dense.width;
+    uint8_t last = 0;
+    unsigned num_spans;
+    int x;
+
+    cells->dense.to_alpha (cells->dense.covered_height,
+			   cells->dense.uncovered_area,
+			   alpha, cells->dense.stride,
+			   cells->dense.left*GRID_X*2);
+    cells->dense.left = 0;
+    cells->dense.covered_height[cells->dense.stride] = 0;
+    cells->dense.uncovered_area[cells->dense.stride] = 0;
+
+    /* Form the spans from the changes in coverage, stepping over runs
+     * of equal coverage a word at a time. */
+    num_spans = 0;
+    for (x = 0; x < width; ) {
+	if (alpha[x] != last) {
+	    spans[num_spans].x = xmin + x;
+	    spans[num_spans].coverage = last = alpha[x];
+	    ++num_spans;
+	}
+	x++;
+
+	while (x + 4 <= width) {
+	    uint32_t v;
+
+	    memcpy (&v, alpha + x, sizeof (v));
+	    if (v != last * 0x01010101u)
+		break;
+	    x += 4;
+	}
+    }
+
+    if (last) {
+	spans[num_spans].x = xmax;
+	spans[num_spans].coverage = 0;
+	++num_spans;
+    }
+
+    cells->num_cells = num_spans;
+    if (num_spans == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    /* Dump them into the renderer. */
+    return renderer->render_rows (renderer, y, height, spans, num_spans);
+}
 
 I void
 glitter_scan_converter_render(glitter_scan_converter_t *converter,
@@ -1728,12 +2239,17 @@ glitter_scan_converter_render(glitter_scan_converter_t *converter,
     struct cell_list *coverages = converter->coverages;
     struct active_list *active = converter->active;
     struct edge *buckets[GRID_Y] = { 0 };
+    int use_dense;
 
     xmin_i = converter->xmin / GRID_X;
     xmax_i = converter->xmax / GRID_X;
     if (xmin_i >= xmax_i)
 	return;
 
+    /* blit_a1() thresholds coverage before it is wrapped into a byte,
+     * so only antialiased rows may go through the dense kernels. */
+    use_dense = antialias && cell_list_init_dense (coverages, xmin_i, xmax_i);
+
     /* Render each pixel row. */
     for (i = 0; i < h; i = j) {
 	int do_full_row = 0;
@@ -1790,12 +2306,19 @@ glitter_scan_converter_render(glitter_scan_converter_t *converter,
 	    }
 	}
 
-	if (antialias)
+	if (coverages->dense.enabled)
+	    blit_dense (coverages, renderer, converter->spans,
+			i+ymin_i, j-i, xmin_i, xmax_i);
+	else if (antialias)
 	    blit_a8 (coverages, renderer, converter->spans,
 		     i+ymin_i, j-i, xmin_i, xmax_i);
 	else
 	    blit_a1 (coverages, renderer, converter->spans,
 		     i+ymin_i, j-i, xmin_i, xmax_i);
+
+	/* Accumulate the next row densely if this one was busy. */
+	if (use_dense)
+	    coverages->dense.enabled = coverages->num_cells * 16 >= xmax_i - xmin_i;
 	cell_list_reset (coverages);
 
 	active->min_height -= GRID_Y;
@@ -2315,7 +2315,8 @@ _cairo_traps_compositor_glyphs (const cairo_compositor_t	*_compositor,
     if (unlikely (status))
 	return status;
 
-    _cairo_scaled_font_freeze_cache (scaled_font);
+    if ((compositor->flags & CAIRO_TRAPS_COMPOSITOR_GLYPHS_UNFROZEN) == 0)
+	_cairo_scaled_font_freeze_cache (scaled_font);
     status = compositor->check_composite_glyphs (extents,
 						 scaled_font, glyphs,
 						 &num_glyphs);
@@ -2332,7 +2333,8 @@ _cairo_traps_compositor_glyphs (const cairo_compositor_t	*_compositor,
 				     composite_glyphs, NULL, &info,
 				     need_bounded_clip (extents) | FORCE_CLIP_REGION);
     }
-    _cairo_scaled_font_thaw_cache (scaled_font);
+    if ((compositor->flags & CAIRO_TRAPS_COMPOSITOR_GLYPHS_UNFROZEN) == 0)
+	_cairo_scaled_font_thaw_cache (scaled_font);
 
     return status;
 }
@@ -2343,6 +2345,8 @@ _cairo_traps_compositor_init (cairo_traps_compositor_t *compositor,
 {
     compositor->base.delegate = delegate;
 
+    compositor->flags = 0;
+
     compositor->base.paint = _cairo_traps_compositor_paint;
     compositor->base.mask = _cairo_traps_compositor_mask;
     compositor->base.fill = _cairo_traps_compositor_fill;
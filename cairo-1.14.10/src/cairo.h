@@ -1411,6 +1411,12 @@ cairo_font_options_set_hint_metrics (cairo_font_options_t *options,
 cairo_public cairo_hint_metrics_t
 cairo_font_options_get_hint_metrics (const cairo_font_options_t *options);
 
+cairo_public void
+cairo_font_options_set_subpixel_positions (cairo_font_options_t *options,
+					   int                   positions);
+cairo_public int
+cairo_font_options_get_subpixel_positions (const cairo_font_options_t *options);
+
 /* This interface is for dealing with text as text, not caring about the
    font object inside the the cairo_t. */
 
@@ -1644,6 +1650,18 @@ cairo_public void
 cairo_scaled_font_get_font_options (cairo_scaled_font_t		*scaled_font,
 				    cairo_font_options_t	*options);
 
+cairo_public void
+cairo_glyph_cache_set_max_size (unsigned long max_size);
+
+cairo_public unsigned long
+cairo_glyph_cache_get_max_size (void);
+
+cairo_public void
+cairo_glyph_cache_get_statistics (unsigned long *size,
+				  unsigned long *hits,
+				  unsigned long *misses,
+				  unsigned long *evictions);
+
 
 /* Toy fonts */
 
@@ -2545,6 +2563,20 @@ cairo_image_surface_get_height (cairo_surface_t *surface);
 cairo_public int
 cairo_image_surface_get_stride (cairo_surface_t *surface);
 
+cairo_public void
+cairo_image_surface_set_render_threads (cairo_surface_t *surface,
+					int		 num_threads);
+
+cairo_public int
+cairo_image_surface_get_render_threads (cairo_surface_t *surface);
+
+cairo_public void
+cairo_image_surface_set_deferred (cairo_surface_t *surface,
+				  cairo_bool_t	   deferred);
+
+cairo_public cairo_bool_t
+cairo_image_surface_get_deferred (cairo_surface_t *surface);
+
 #if CAIRO_HAS_PNG_FUNCTIONS
 
 cairo_public cairo_surface_t *
@@ -416,7 +416,14 @@ _cairo_hash_bytes (unsigned long hash,
 		   const void *bytes,
 		   unsigned int length);
 
-#define _cairo_scaled_glyph_index(g) ((g)->hash_entry.hash)
+/* The top bits of a scaled glyph's key hold its subpixel position */
+#define CAIRO_SCALED_GLYPH_PHASE_BITS 2
+#define CAIRO_SCALED_GLYPH_PHASE_SHIFT (sizeof (unsigned long) * CHAR_BIT - CAIRO_SCALED_GLYPH_PHASE_BITS)
+#define CAIRO_SCALED_GLYPH_INDEX_MASK ((1UL << CAIRO_SCALED_GLYPH_PHASE_SHIFT) - 1)
+
+#define _cairo_scaled_glyph_index(g) ((g)->hash_entry.hash & CAIRO_SCALED_GLYPH_INDEX_MASK)
+#define _cairo_scaled_glyph_phase(g) ((int) ((g)->hash_entry.hash >> CAIRO_SCALED_GLYPH_PHASE_SHIFT))
+#define _cairo_scaled_glyph_key(g) ((g)->hash_entry.hash)
 #define _cairo_scaled_glyph_set_index(g, i)  ((g)->hash_entry.hash = (i))
 
 #include "cairo-scaled-font-private.h"
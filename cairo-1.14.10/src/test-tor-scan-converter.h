@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEST_TOR_SCAN_CONVERTER_H
+#define TEST_TOR_SCAN_CONVERTER_H
+
+#include "cairo.h"
+
+CAIRO_BEGIN_DECLS
+
+/* Selects the coverage strategy of the tor scan converter, see
+ * CAIRO_TOR_COVERAGE, for the test suite and the benchmarks. */
+cairo_bool_t
+_cairo_test_tor_scan_converter_set_coverage (const char *coverage);
+
+CAIRO_END_DECLS
+
+#endif /* TEST_TOR_SCAN_CONVERTER_H */
@@ -0,0 +1,275 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Fills drawn with CAIRO_ANTIALIAS_BEST, which uses the analytic
+ * coverage scan converter, in the cases where an exact converter is
+ * easiest to get wrong: paths that cross themselves, the two fill rules
+ * on the same path, slivers thinner than a pixel, edges that are nearly
+ * horizontal, and edges that cross each other or several pixel
+ * boundaries within a single pixel row. Everything is built from
+ * straight lines so that the reference images do not depend on how
+ * curves are flattened.
+ */
+
+#include "cairo-test.h"
+
+typedef struct _point {
+    double x, y;
+} point_t;
+
+static void
+polygon (cairo_t *cr, const point_t *points, int num_points)
+{
+    int n;
+
+    cairo_move_to (cr, points[0].x, points[0].y);
+    for (n = 1; n < num_points; n++)
+	cairo_line_to (cr, points[n].x, points[n].y);
+    cairo_close_path (cr);
+}
+
+static void
+quad (cairo_t *cr,
+      double x0, double y0, double x1, double y1,
+      double x2, double y2, double x3, double y3)
+{
+    cairo_move_to (cr, x0, y0);
+    cairo_line_to (cr, x1, y1);
+    cairo_line_to (cr, x2, y2);
+    cairo_line_to (cr, x3, y3);
+    cairo_close_path (cr);
+}
+
+static void
+setup (cairo_t *cr)
+{
+    cairo_set_source_rgb (cr, 1.0, 1.0, 1.0);
+    cairo_paint (cr);
+
+    cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
+    cairo_set_antialias (cr, CAIRO_ANTIALIAS_BEST);
+}
+
+static const point_t pentagram[] = {
+    { 16.0, 3.0 }, { 23.625, 26.5 }, { 3.625, 12.0 },
+    { 28.375, 12.0 }, { 8.375, 26.5 },
+};
+
+static const point_t heptagram[] = {
+    { 80.0, 3.0 }, { 85.625, 27.6875 }, { 69.8125, 7.875 },
+    { 92.6875, 18.875 }, { 67.3125, 18.875 }, { 90.1875, 7.875 },
+    { 74.375, 27.6875 },
+};
+
+static const point_t enneagram[] = {
+    { 80.0, 35.0 }, { 84.4375, 60.1875 }, { 71.625, 38.0625 },
+    { 91.25, 54.5 }, { 67.1875, 45.75 }, { 92.8125, 45.75 },
+    { 68.75, 54.5 }, { 88.375, 38.0625 }, { 75.5625, 60.1875 },
+};
+
+/* A triangle traced twice over, slightly out of step the second time,
+ * so that most of it is wound twice with thin once-wound slivers. */
+static const point_t double_triangle[] = {
+    { 36.0, 36.0 }, { 62.0, 44.25 }, { 38.5, 61.0 },
+    { 36.75, 37.5 }, { 61.25, 45.5 }, { 37.25, 60.25 },
+};
+
+static cairo_test_status_t
+self_intersecting (cairo_t *cr, int width, int height)
+{
+    setup (cr);
+
+    /* a bow-tie crossing in the middle of a pixel */
+    quad (cr, 4.5, 4.25, 27.75, 27.5, 27.5, 4.5, 4.25, 27.75);
+
+    cairo_save (cr);
+    cairo_translate (cr, 32, 0);
+    polygon (cr, pentagram, ARRAY_LENGTH (pentagram));
+    cairo_restore (cr);
+
+    polygon (cr, heptagram, ARRAY_LENGTH (heptagram));
+
+    /* a bow-tie whose lobes overlap the crossing row */
+    quad (cr, 4.25, 36.5, 27.5, 59.75, 4.75, 59.5, 27.25, 36.25);
+
+    polygon (cr, double_triangle, ARRAY_LENGTH (double_triangle));
+    polygon (cr, enneagram, ARRAY_LENGTH (enneagram));
+
+    cairo_fill (cr);
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+/* Overlapping and nested contours that wind 0, 1 and 2 times. */
+static void
+fill_rule_path (cairo_t *cr)
+{
+    polygon (cr, pentagram, ARRAY_LENGTH (pentagram));
+
+    /* two overlapping quads running the same way */
+    quad (cr, 30.25, 4.0, 44.0, 5.5, 43.0, 20.0, 29.5, 18.75);
+    quad (cr, 34.5, 10.25, 46.0, 11.0, 45.25, 26.5, 33.75, 25.0);
+
+    /* a frame holding one hole running against it and one with it */
+    quad (cr, 3.5, 31.5, 44.25, 30.75, 45.0, 45.25, 4.75, 46.0);
+    quad (cr, 9.25, 34.75, 10.0, 42.5, 22.5, 42.0, 21.75, 34.5);
+    quad (cr, 26.5, 34.25, 39.75, 35.0, 39.25, 42.75, 27.0, 41.5);
+}
+
+static cairo_test_status_t
+fill_rule (cairo_t *cr, int width, int height)
+{
+    setup (cr);
+
+    fill_rule_path (cr);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_WINDING);
+    cairo_fill (cr);
+
+    cairo_translate (cr, 48, 0);
+    fill_rule_path (cr);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+    cairo_fill (cr);
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+static cairo_test_status_t
+slivers (cairo_t *cr, int width, int height)
+{
+    static const double widths[] = {
+	1 / 256., 1 / 64., 1 / 16., 1 / 4., 1 / 2., 3 / 4.
+    };
+    unsigned int n;
+
+    setup (cr);
+
+    /* steep slivers from one fixed-point unit up to most of a pixel */
+    for (n = 0; n < ARRAY_LENGTH (widths); n++) {
+	double x = 4.375 + 8 * n;
+
+	quad (cr, x, 2, x + 4, 30, x + 4 + widths[n], 30, x + widths[n], 2);
+    }
+
+    /* wedges whose long edges are nearly horizontal */
+    cairo_move_to (cr, 52, 4.25);
+    cairo_line_to (cr, 94, 5);
+    cairo_line_to (cr, 52, 12.5);
+    cairo_close_path (cr);
+
+    cairo_move_to (cr, 94, 16);
+    cairo_line_to (cr, 52, 17.125);
+    cairo_line_to (cr, 94, 27.875);
+    cairo_close_path (cr);
+
+    /* long, nearly horizontal slivers, the last two inside a single row */
+    quad (cr, 2, 34.5, 94, 35.25, 94, 35.5, 2, 34.75);
+    quad (cr, 2, 38.1, 94, 38.2, 94, 38.3, 2, 38.2);
+    quad (cr, 2, 42, 94, 44.5, 94, 44.5625, 2, 42.0625);
+    quad (cr, 2, 48.25, 94, 49.75, 94, 49.75 + 1 / 256., 2, 48.25 + 1 / 256.);
+    quad (cr, 2, 54.125, 94, 54.625, 94, 54.875, 2, 54.375);
+    quad (cr, 2, 60.5, 94, 57.25, 94, 57.75, 2, 61);
+
+    cairo_fill (cr);
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+static cairo_test_status_t
+crossings (cairo_t *cr, int width, int height)
+{
+    double x;
+    int n;
+
+    setup (cr);
+
+    /* shallow edges crossing each other inside a pixel */
+    quad (cr, 10.3, 4.1, 40.9, 11.7, 40.9, 4.3, 10.3, 11.9);
+    quad (cr, 50.2, 8.6, 92.7, 7.9, 92.7, 8.4, 50.2, 8.1);
+
+    /* a zig-zag whose edges start and end within one row, each
+     * crossing a pixel boundary on the way */
+    cairo_move_to (cr, 4, 22);
+    cairo_line_to (cr, 4, 17.5);
+    for (x = 5.5, n = 0; x < 92; x += 2.5, n++)
+	cairo_line_to (cr, x, n & 1 ? 17.75 : 17.25);
+    cairo_line_to (cr, 92, 17.5);
+    cairo_line_to (cr, 92, 22);
+    cairo_close_path (cr);
+
+    /* thin wedges meeting at a point inside a pixel */
+    cairo_move_to (cr, 48.4, 32.6);
+    cairo_line_to (cr, 4, 28.2);
+    cairo_line_to (cr, 4, 29.1);
+    cairo_close_path (cr);
+
+    cairo_move_to (cr, 48.4, 32.6);
+    cairo_line_to (cr, 92, 30.3);
+    cairo_line_to (cr, 92, 31.4);
+    cairo_close_path (cr);
+
+    cairo_move_to (cr, 48.4, 32.6);
+    cairo_line_to (cr, 4, 35.9);
+    cairo_line_to (cr, 4, 37.2);
+    cairo_close_path (cr);
+
+    cairo_move_to (cr, 48.4, 32.6);
+    cairo_line_to (cr, 92, 34.05);
+    cairo_line_to (cr, 92, 35.6);
+    cairo_close_path (cr);
+
+    /* a long thin bow-tie crossing over within one row */
+    quad (cr, 4, 42.2, 92, 43.1, 92, 42.3, 4, 43.0);
+
+    cairo_fill (cr);
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+CAIRO_TEST (antialias_best_self_intersecting,
+	    "Check CAIRO_ANTIALIAS_BEST on self-intersecting paths",
+	    "fill, antialias", /* keywords */
+	    "target=raster", /* requirements */
+	    96, 64,
+	    NULL, self_intersecting)
+
+CAIRO_TEST (antialias_best_fill_rule,
+	    "Check CAIRO_ANTIALIAS_BEST with both fill rules on the same path",
+	    "fill, antialias", /* keywords */
+	    "target=raster", /* requirements */
+	    96, 48,
+	    NULL, fill_rule)
+
+CAIRO_TEST (antialias_best_slivers,
+	    "Check CAIRO_ANTIALIAS_BEST on sub-pixel slivers and nearly horizontal edges",
+	    "fill, antialias", /* keywords */
+	    "target=raster", /* requirements */
+	    96, 64,
+	    NULL, slivers)
+
+CAIRO_TEST (antialias_best_crossings,
+	    "Check CAIRO_ANTIALIAS_BEST with edges crossing pixels within a row",
+	    "fill, antialias", /* keywords */
+	    "target=raster", /* requirements */
+	    96, 48,
+	    NULL, crossings)
@@ -21,6 +21,10 @@ extern void _register_a8_clear (void);
 extern void _register_a8_mask (void);
 extern void _register_aliasing (void);
 extern void _register_alpha_similar (void);
+extern void _register_antialias_best_self_intersecting (void);
+extern void _register_antialias_best_fill_rule (void);
+extern void _register_antialias_best_slivers (void);
+extern void _register_antialias_best_crossings (void);
 extern void _register_arc_direction (void);
 extern void _register_arc_infinite_loop (void);
 extern void _register_arc_looping_dash (void);
@@ -176,6 +180,7 @@ extern void _register_finer_grained_fallbacks (void);
 extern void _register_font_face_get_type (void);
 extern void _register_font_matrix_translation (void);
 extern void _register_font_options (void);
+extern void _register_glyph_cache_budget (void);
 extern void _register_glyph_cache_pressure (void);
 extern void _register_get_and_set (void);
 extern void _register_get_clip (void);
@@ -200,6 +205,8 @@ extern void _register_huge_radial (void);
 extern void _register_image_surface_source (void);
 extern void _register_image_bug_710072_aligned (void);
 extern void _register_image_bug_710072_unaligned (void);
+extern void _register_image_deferred (void);
+extern void _register_image_render_bands (void);
 extern void _register_implicit_close (void);
 extern void _register_infinite_join (void);
 extern void _register_in_fill_empty_trapezoid (void);
@@ -508,10 +515,12 @@ extern void _register_text_cache_crash (void);
 extern void _register_text_glyph_range (void);
 extern void _register_text_pattern (void);
 extern void _register_text_rotate (void);
+extern void _register_text_subpixel_positions (void);
 extern void _register_text_transform (void);
 extern void _register_text_zero_len (void);
 extern void _register_tighten_bounds (void);
 extern void _register_tiger (void);
+extern void _register_tor_coverage (void);
 extern void _register_a1_tiger (void);
 extern void _register_toy_font_face (void);
 extern void _register_transforms (void);
@@ -582,6 +591,10 @@ _cairo_test_runner_register_tests (void)
     _register_a8_mask ();
     _register_aliasing ();
     _register_alpha_similar ();
+    _register_antialias_best_self_intersecting ();
+    _register_antialias_best_fill_rule ();
+    _register_antialias_best_slivers ();
+    _register_antialias_best_crossings ();
     _register_arc_direction ();
     _register_arc_infinite_loop ();
     _register_arc_looping_dash ();
@@ -737,6 +750,7 @@ _cairo_test_runner_register_tests (void)
     _register_font_face_get_type ();
     _register_font_matrix_translation ();
     _register_font_options ();
+    _register_glyph_cache_budget ();
     _register_glyph_cache_pressure ();
     _register_get_and_set ();
     _register_get_clip ();
@@ -761,6 +775,8 @@ _cairo_test_runner_register_tests (void)
     _register_image_surface_source ();
     _register_image_bug_710072_aligned ();
     _register_image_bug_710072_unaligned ();
+    _register_image_deferred ();
+    _register_image_render_bands ();
     _register_implicit_close ();
     _register_infinite_join ();
     _register_in_fill_empty_trapezoid ();
@@ -1069,10 +1085,12 @@ _cairo_test_runner_register_tests (void)
     _register_text_glyph_range ();
     _register_text_pattern ();
     _register_text_rotate ();
+    _register_text_subpixel_positions ();
     _register_text_transform ();
     _register_text_zero_len ();
     _register_tighten_bounds ();
     _register_tiger ();
+    _register_tor_coverage ();
     _register_a1_tiger ();
     _register_toy_font_face ();
     _register_transforms ();
@@ -74,6 +74,10 @@ preamble (cairo_test_context_t *ctx)
     cairo_font_options_get_hint_metrics (NULL);
     assert (cairo_font_options_get_hint_metrics (default_options) == CAIRO_HINT_METRICS_DEFAULT);
 
+    cairo_font_options_set_subpixel_positions (NULL, 0);
+    cairo_font_options_get_subpixel_positions (NULL);
+    assert (cairo_font_options_get_subpixel_positions (default_options) == 0);
+
     cairo_font_options_destroy (NULL);
     cairo_font_options_destroy (default_options);
     cairo_font_options_destroy (nil_options);
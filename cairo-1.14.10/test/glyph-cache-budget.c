@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks the byte budget of the global glyph cache and the statistics
+ * it reports: lookups of new glyphs count as misses and lookups of
+ * cached ones as hits, rendering more than the budget holds evicts
+ * glyphs and keeps the cache within it, and a zero budget empties it.
+ */
+
+#include "cairo-test.h"
+
+#define TEXT "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"
+#define ROUNDS 4
+#define BUDGET (64 << 10)
+
+static cairo_scaled_font_t *
+create_scaled_font (cairo_t *cr, double size)
+{
+    cairo_font_options_t *options;
+    cairo_scaled_font_t *scaled_font;
+    cairo_matrix_t font_matrix, ctm;
+
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
+
+    cairo_matrix_init_scale (&font_matrix, size, size);
+    cairo_matrix_init_identity (&ctm);
+    scaled_font = cairo_scaled_font_create (cairo_get_font_face (cr),
+					    &font_matrix, &ctm, options);
+    cairo_font_options_destroy (options);
+
+    return scaled_font;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_scaled_font_t *scaled_font;
+    cairo_surface_t *surface;
+    cairo_glyph_t *glyphs = NULL;
+    cairo_text_extents_t extents;
+    cairo_status_t status;
+    cairo_t *cr;
+    unsigned long max_size, size, size0;
+    unsigned long hits, hits0, misses, misses0, evictions, evictions0;
+    int num_glyphs = 0;
+    int i;
+
+    max_size = cairo_glyph_cache_get_max_size ();
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 128, 128);
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+
+    status = cairo_scaled_font_text_to_glyphs (cairo_get_scaled_font (cr),
+					       0, 0, TEXT, -1,
+					       &glyphs, &num_glyphs,
+					       NULL, NULL, NULL);
+    if (status) {
+	result = cairo_test_status_from_status (ctx, status);
+	goto CLEANUP;
+    }
+
+    /* Metrics lookups on a fresh font: one miss per glyph on the first
+     * round, then only hits. */
+    cairo_glyph_cache_set_max_size (max_size > (8 << 20) ? max_size : (8 << 20));
+    scaled_font = create_scaled_font (cr, 37.5);
+    cairo_glyph_cache_get_statistics (NULL, &hits0, &misses0, &evictions0);
+    for (i = 0; i < ROUNDS; i++)
+	cairo_scaled_font_glyph_extents (scaled_font, glyphs, num_glyphs, &extents);
+    cairo_glyph_cache_get_statistics (NULL, &hits, &misses, &evictions);
+    cairo_scaled_font_destroy (scaled_font);
+
+    if (misses - misses0 != (unsigned long) num_glyphs ||
+	hits - hits0 != (unsigned long) (ROUNDS - 1) * num_glyphs ||
+	evictions != evictions0)
+    {
+	cairo_test_log (ctx,
+			"Error: %d lookups of %d glyphs counted %lu hits, %lu misses and %lu evictions\n",
+			ROUNDS * num_glyphs, num_glyphs,
+			hits - hits0, misses - misses0, evictions - evictions0);
+	result = CAIRO_TEST_FAILURE;
+	goto CLEANUP;
+    }
+
+    /* Glyph images at this size take several times the budget */
+    cairo_glyph_cache_set_max_size (BUDGET);
+    cairo_glyph_cache_get_statistics (&size0, NULL, NULL, &evictions0);
+    if (size0 > BUDGET) {
+	cairo_test_log (ctx,
+			"Error: glyph cache holds %lu bytes after setting a budget of %d\n",
+			size0, BUDGET);
+	result = CAIRO_TEST_FAILURE;
+	goto CLEANUP;
+    }
+
+    scaled_font = create_scaled_font (cr, 96);
+    cairo_set_scaled_font (cr, scaled_font);
+    cairo_scaled_font_destroy (scaled_font);
+    for (i = 0; i < num_glyphs; i++) {
+	cairo_glyph_t glyph = glyphs[i];
+
+	glyph.x = 16;
+	glyph.y = 96;
+	cairo_show_glyphs (cr, &glyph, 1);
+
+	cairo_glyph_cache_get_statistics (&size, NULL, NULL, NULL);
+	if (size > BUDGET) {
+	    cairo_test_log (ctx,
+			    "Error: glyph cache holds %lu bytes with a budget of %d\n",
+			    size, BUDGET);
+	    result = CAIRO_TEST_FAILURE;
+	    goto CLEANUP;
+	}
+    }
+
+    cairo_glyph_cache_get_statistics (NULL, NULL, NULL, &evictions);
+    if (evictions == evictions0) {
+	cairo_test_log (ctx, "Error: no glyphs evicted over the budget\n");
+	result = CAIRO_TEST_FAILURE;
+	goto CLEANUP;
+    }
+
+    /* The size must account for every byte it was charged */
+    cairo_glyph_cache_set_max_size (0);
+    cairo_glyph_cache_get_statistics (&size, NULL, NULL, NULL);
+    if (size != 0) {
+	cairo_test_log (ctx,
+			"Error: glyph cache holds %lu bytes with a budget of 0\n",
+			size);
+	result = CAIRO_TEST_FAILURE;
+    }
+
+CLEANUP:
+    cairo_glyph_free (glyphs);
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+
+    cairo_glyph_cache_set_max_size (max_size);
+
+    return result;
+}
+
+CAIRO_TEST (glyph_cache_budget,
+	    "Test the glyph cache budget, eviction and statistics",
+	    "text, font", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "image-compare.h"
+
+#include <string.h>
+
+static int
+bytes_per_row (cairo_format_t format, int width)
+{
+    switch (format) {
+    case CAIRO_FORMAT_ARGB32:
+    case CAIRO_FORMAT_RGB24:
+    case CAIRO_FORMAT_RGB30:
+	return 4 * width;
+    case CAIRO_FORMAT_RGB16_565:
+	return 2 * width;
+    case CAIRO_FORMAT_A8:
+	return width;
+    case CAIRO_FORMAT_A1:
+	return (width + 7) / 8;
+    case CAIRO_FORMAT_INVALID:
+    default:
+	return -1;
+    }
+}
+
+cairo_test_status_t
+image_compare_exact (const cairo_test_context_t *ctx,
+		     cairo_surface_t *expected,
+		     cairo_surface_t *actual,
+		     const char *what)
+{
+    const unsigned char *a, *b;
+    int width, height, stride_a, stride_b, len, y;
+    cairo_status_t status;
+
+    status = cairo_surface_status (expected);
+    if (status == CAIRO_STATUS_SUCCESS)
+	status = cairo_surface_status (actual);
+    if (status)
+	return cairo_test_status_from_status (ctx, status);
+
+    cairo_surface_flush (expected);
+    cairo_surface_flush (actual);
+
+    width = cairo_image_surface_get_width (expected);
+    height = cairo_image_surface_get_height (expected);
+    len = bytes_per_row (cairo_image_surface_get_format (expected), width);
+    if (len < 0 ||
+	cairo_image_surface_get_format (actual) != cairo_image_surface_get_format (expected) ||
+	cairo_image_surface_get_width (actual) != width ||
+	cairo_image_surface_get_height (actual) != height)
+    {
+	cairo_test_log (ctx, "Error: %s has a different size or format\n", what);
+	return CAIRO_TEST_FAILURE;
+    }
+
+    a = cairo_image_surface_get_data (expected);
+    b = cairo_image_surface_get_data (actual);
+    stride_a = cairo_image_surface_get_stride (expected);
+    stride_b = cairo_image_surface_get_stride (actual);
+    for (y = 0; y < height; y++) {
+	if (memcmp (a + y * stride_a, b + y * stride_b, len)) {
+	    cairo_test_log (ctx, "Error: %s differs at row %d\n", what, y);
+	    return CAIRO_TEST_FAILURE;
+	}
+    }
+
+    return CAIRO_TEST_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Draws the same sequence on an image surface with deferred drawing
+ * and on one without, and checks they end up identical. Along the way
+ * a snapshot is taken while drawing is pending and the surface is read
+ * as a source, both before and after an unclipped clear; each of these
+ * must match as well.
+ */
+
+#include "cairo-test.h"
+#include "image-compare.h"
+
+#define SIZE 128
+
+enum {
+    SNAPSHOT,
+    COPY,
+    CLEARED,
+    FINAL,
+    NUM_IMAGES
+};
+
+static const char *image_names[NUM_IMAGES] = {
+    "snapshot",
+    "copy",
+    "copy after clear",
+    "final surface",
+};
+
+static void
+draw_boxes (cairo_t *cr, int pass)
+{
+    cairo_pattern_t *pattern;
+    int i;
+
+    /* Many small pixel-aligned boxes in a few colours, which the replay
+     * merges into larger fills */
+    for (i = 0; i < 96; i++) {
+	switch (i % 3) {
+	case 0: cairo_set_source_rgb (cr, 1, 0, 0); break;
+	case 1: cairo_set_source_rgba (cr, 0, 1, 0, .5); break;
+	case 2: cairo_set_source_rgba (cr, 0, 0, 1, .75); break;
+	}
+	cairo_rectangle (cr,
+			 (i * 37 + pass * 11) % (SIZE - 8),
+			 (i * 13 + pass * 5) % (SIZE - 8),
+			 8, 8);
+	cairo_fill (cr);
+    }
+
+    pattern = cairo_pattern_create_radial (SIZE/2., SIZE/2., 0,
+					   SIZE/2., SIZE/2., SIZE/3.);
+    cairo_pattern_add_color_stop_rgba (pattern, 0, 1, 1, 0, 1);
+    cairo_pattern_add_color_stop_rgba (pattern, 1, 0, 1, 1, .25);
+    cairo_set_source (cr, pattern);
+    cairo_pattern_destroy (pattern);
+    cairo_arc (cr, SIZE/2. + pass * 4, SIZE/2., SIZE/4., 0, 2 * M_PI);
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+copy_surface (cairo_surface_t *source)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cr = cairo_create (image);
+    cairo_set_source_surface (cr, source, 0, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+
+    cairo_surface_flush (image);
+    return image;
+}
+
+static void
+draw_sequence (cairo_surface_t *surface, cairo_surface_t *images[NUM_IMAGES])
+{
+    cairo_surface_t *recording;
+    cairo_t *cr, *cr2;
+
+    cr = cairo_create (surface);
+    cairo_set_source_rgb (cr, .5, .5, .5);
+    cairo_paint (cr);
+    draw_boxes (cr, 0);
+
+    /* The recording surface takes a snapshot of the surface as it
+     * stands, pending drawing included */
+    recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+						NULL);
+    cr2 = cairo_create (recording);
+    cairo_set_source_surface (cr2, surface, 0, 0);
+    cairo_paint (cr2);
+    cairo_destroy (cr2);
+
+    /* Reading the surface replays the pending drawing with the
+     * snapshot still attached */
+    images[COPY] = copy_surface (surface);
+    draw_boxes (cr, 1);
+    cairo_surface_flush (surface);
+
+    cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint (cr);
+    cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+    images[CLEARED] = copy_surface (surface);
+
+    draw_boxes (cr, 2);
+    cairo_destroy (cr);
+
+    images[SNAPSHOT] = copy_surface (recording);
+    cairo_surface_destroy (recording);
+
+    cairo_surface_flush (surface);
+    images[FINAL] = cairo_surface_reference (surface);
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *immediate, *deferred;
+    cairo_surface_t *expected[NUM_IMAGES], *images[NUM_IMAGES];
+    int i;
+
+    immediate = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    deferred = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+
+    cairo_image_surface_set_deferred (deferred, TRUE);
+    if (! cairo_image_surface_get_deferred (deferred) ||
+	cairo_image_surface_get_deferred (immediate))
+    {
+	cairo_test_log (ctx, "Error: deferred drawing not reported as set\n");
+	cairo_surface_destroy (immediate);
+	cairo_surface_destroy (deferred);
+	return CAIRO_TEST_FAILURE;
+    }
+
+    draw_sequence (immediate, expected);
+    draw_sequence (deferred, images);
+
+    for (i = 0; i < NUM_IMAGES; i++) {
+	cairo_test_status_t status;
+	char what[80];
+
+	snprintf (what, sizeof (what), "%s with deferred drawing",
+		  image_names[i]);
+	status = image_compare_exact (ctx, expected[i], images[i], what);
+	if (status != CAIRO_TEST_SUCCESS)
+	    result = status;
+
+	cairo_surface_destroy (images[i]);
+	cairo_surface_destroy (expected[i]);
+    }
+
+    cairo_surface_destroy (immediate);
+    cairo_surface_destroy (deferred);
+
+    return result;
+}
+
+CAIRO_TEST (image_deferred,
+	    "Check deferred drawing on image surfaces matches immediate drawing",
+	    "image", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
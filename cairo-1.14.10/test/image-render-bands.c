@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Renders large fills once on the calling thread and once split into
+ * bands over several threads, and checks the results are identical.
+ * The cases cover the spans renderers that composite with pixman as
+ * each band is rendered as well as those that write the pixels
+ * directly, with a gradient source that all the bands share.
+ */
+
+#include "cairo-test.h"
+#include "image-compare.h"
+
+#define SIZE 768
+#define THREADS 4
+#define REPEAT 4
+
+static void
+draw (cairo_t *cr, cairo_antialias_t antialias, cairo_operator_t op,
+      cairo_bool_t gradient)
+{
+    cairo_pattern_t *pattern;
+    int i;
+
+    cairo_set_source_rgb (cr, .5, .5, 1);
+    cairo_paint (cr);
+
+    if (gradient) {
+	pattern = cairo_pattern_create_linear (0, 0, SIZE, SIZE);
+	cairo_pattern_add_color_stop_rgba (pattern, 0, 1, 0, 0, .75);
+	cairo_pattern_add_color_stop_rgba (pattern, .5, 0, 1, 0, 1);
+	cairo_pattern_add_color_stop_rgba (pattern, 1, 0, 0, 1, .5);
+	cairo_set_source (cr, pattern);
+	cairo_pattern_destroy (pattern);
+    } else {
+	cairo_set_source_rgba (cr, 1, .5, 0, .75);
+    }
+
+    cairo_set_antialias (cr, antialias);
+    cairo_set_operator (cr, op);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+
+    /* A star whose edges cross every band */
+    for (i = 0; i < 23; i++) {
+	double a = i * 10 * M_PI / 23;
+
+	cairo_line_to (cr,
+		       SIZE/2. + SIZE/2.2 * sin (a),
+		       SIZE/2. - SIZE/2.2 * cos (a));
+    }
+    cairo_close_path (cr);
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+render (int num_threads, cairo_antialias_t antialias, cairo_operator_t op,
+	cairo_bool_t gradient)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cairo_image_surface_set_render_threads (surface, num_threads);
+
+    cr = cairo_create (surface);
+    draw (cr, antialias, op, gradient);
+    cairo_destroy (cr);
+
+    return surface;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    static const cairo_antialias_t antialias[] = {
+	CAIRO_ANTIALIAS_NONE,
+	CAIRO_ANTIALIAS_DEFAULT,
+    };
+    static const cairo_operator_t op[] = {
+	CAIRO_OPERATOR_OVER,
+	CAIRO_OPERATOR_SOURCE,
+    };
+    unsigned int i, j, gradient, n;
+
+    for (i = 0; i < ARRAY_LENGTH (antialias); i++)
+    for (j = 0; j < ARRAY_LENGTH (op); j++)
+    for (gradient = 0; gradient <= 1; gradient++) {
+	cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+	cairo_surface_t *reference;
+	char what[80];
+
+	snprintf (what, sizeof (what),
+		  "banded fill (antialias %d, operator %d, %s source)",
+		  antialias[i], op[j], gradient ? "gradient" : "solid");
+
+	reference = render (0, antialias[i], op[j], gradient);
+	for (n = 0; n < REPEAT && result == CAIRO_TEST_SUCCESS; n++) {
+	    cairo_surface_t *banded;
+
+	    banded = render (THREADS, antialias[i], op[j], gradient);
+	    result = image_compare_exact (ctx, reference, banded, what);
+	    cairo_surface_destroy (banded);
+	}
+	cairo_surface_destroy (reference);
+
+	if (result != CAIRO_TEST_SUCCESS)
+	    return result;
+    }
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+CAIRO_TEST (image_render_bands,
+	    "Check fills rendered in parallel bands match single-threaded rendering",
+	    "fill, image", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Draws glyphs at every quarter pixel with four subpixel positions and
+ * checks each against the glyph drawn on the whole pixel, resampled by
+ * the same fraction.  Catches variants that are clipped to the extents
+ * of an unshifted glyph and so lose the column they spill into.
+ */
+
+#include "cairo-test.h"
+
+#include <stdlib.h>
+
+#define POSITIONS 4
+#define WIDTH 200
+#define HEIGHT 48
+#define ORIGIN_X 10
+#define ORIGIN_Y 34
+#define SPACING 40
+#define NUM_GLYPHS 4
+
+static cairo_surface_t *
+draw_glyphs (const cairo_font_options_t *options,
+	     cairo_glyph_t *glyphs,
+	     int num_glyphs,
+	     int phase)
+{
+    cairo_glyph_t shifted[NUM_GLYPHS];
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    int i;
+
+    for (i = 0; i < num_glyphs; i++) {
+	shifted[i] = glyphs[i];
+	shifted[i].x += phase / (double) POSITIONS;
+    }
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, WIDTH, HEIGHT);
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 24);
+    cairo_set_font_options (cr, options);
+    cairo_show_glyphs (cr, shifted, num_glyphs);
+    cairo_destroy (cr);
+
+    cairo_surface_flush (surface);
+    return surface;
+}
+
+static cairo_test_status_t
+compare (const cairo_test_context_t *ctx,
+	 cairo_surface_t *reference,
+	 cairo_surface_t *image,
+	 int phase,
+	 int num_glyphs)
+{
+    const unsigned char *ref = cairo_image_surface_get_data (reference);
+    const unsigned char *data = cairo_image_surface_get_data (image);
+    int stride = cairo_image_surface_get_stride (image);
+    int x, y;
+
+    for (y = 0; y < HEIGHT; y++) {
+	for (x = 0; x < WIDTH; x++) {
+	    int a = ref[y * stride + x];
+	    int b = x > 0 ? ref[y * stride + x - 1] : 0;
+	    int expected = (a * (POSITIONS - phase) + b * phase + POSITIONS / 2) / POSITIONS;
+	    int actual = data[y * stride + x];
+
+	    if (abs (actual - expected) > 1) {
+		cairo_test_log (ctx,
+				"Error: %d glyphs at phase %d/%d: pixel (%d, %d) is %d, expected %d\n",
+				num_glyphs, phase, POSITIONS, x, y, actual, expected);
+		return CAIRO_TEST_FAILURE;
+	    }
+	}
+    }
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_font_options_t *options;
+    cairo_glyph_t glyphs[NUM_GLYPHS];
+    cairo_scaled_font_t *scaled_font;
+    cairo_glyph_t *text_glyphs = NULL;
+    cairo_surface_t *surface;
+    cairo_status_t status;
+    cairo_t *cr;
+    int num_text_glyphs = 0;
+    int counts[] = { 1, NUM_GLYPHS };
+    int i, j, phase;
+
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
+    cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
+    cairo_font_options_set_subpixel_positions (options, POSITIONS);
+
+    /* Look the glyph indices up with the same font as the drawing */
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 1, 1);
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 24);
+    cairo_set_font_options (cr, options);
+    scaled_font = cairo_get_scaled_font (cr);
+    status = cairo_scaled_font_text_to_glyphs (scaled_font, 0, 0,
+					       "Wm|k", -1,
+					       &text_glyphs, &num_text_glyphs,
+					       NULL, NULL, NULL);
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+
+    if (status || num_text_glyphs != NUM_GLYPHS) {
+	cairo_glyph_free (text_glyphs);
+	cairo_font_options_destroy (options);
+	return status ? cairo_test_status_from_status (ctx, status) : CAIRO_TEST_UNTESTED;
+    }
+
+    /* Whole pixels, far enough apart not to overlap */
+    for (i = 0; i < NUM_GLYPHS; i++) {
+	glyphs[i].index = text_glyphs[i].index;
+	glyphs[i].x = ORIGIN_X + i * SPACING;
+	glyphs[i].y = ORIGIN_Y;
+    }
+    cairo_glyph_free (text_glyphs);
+
+    /* A single glyph and a run take different paths through the compositor */
+    for (j = 0; j < ARRAY_LENGTH (counts) && result == CAIRO_TEST_SUCCESS; j++) {
+	cairo_surface_t *reference;
+	int n = counts[j];
+
+	reference = draw_glyphs (options, glyphs, n, 0);
+
+	for (phase = 1; phase < POSITIONS && result == CAIRO_TEST_SUCCESS; phase++) {
+	    cairo_surface_t *image;
+
+	    image = draw_glyphs (options, glyphs, n, phase);
+	    result = compare (ctx, reference, image, phase, n);
+	    cairo_surface_destroy (image);
+	}
+
+	cairo_surface_destroy (reference);
+    }
+
+    cairo_font_options_destroy (options);
+
+    return result;
+}
+
+CAIRO_TEST (text_subpixel_positions,
+	    "Test glyphs drawn at subpixel positions are shifted and not clipped",
+	    "text, font", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2026 The cairo AmigaOS port contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Renders the same fills with each of the tor scan converter's coverage
+ * strategies, see CAIRO_TOR_COVERAGE, and checks that the cell list,
+ * the reference kernel and the vector kernel give identical pixels.
+ * The fills have enough edges per row for the dense rows to be used,
+ * and are repeated under a clip so that some edges lie outside the
+ * rows being accumulated.
+ */
+
+#include "cairo-test.h"
+#include "image-compare.h"
+#include "test-tor-scan-converter.h"
+
+#define SIZE 256
+
+static void
+draw (cairo_t *cr)
+{
+    int i;
+
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+
+    cairo_set_antialias (cr, CAIRO_ANTIALIAS_DEFAULT);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+
+    /* a star with many points, crossing itself on every row */
+    for (i = 0; i < 61; i++) {
+	double a = i * 30 * M_PI / 61;
+
+	cairo_line_to (cr,
+		       SIZE/2. + SIZE/2.1 * sin (a),
+		       SIZE/2. - SIZE/2.1 * cos (a));
+    }
+    cairo_close_path (cr);
+
+    /* thin slanted stripes, a few cells each per row */
+    for (i = 0; i < 40; i++) {
+	double x = i * SIZE / 40. + .3;
+
+	cairo_move_to (cr, x, 0);
+	cairo_line_to (cr, x + 1.7, 0);
+	cairo_line_to (cr, x + 24.2, SIZE);
+	cairo_line_to (cr, x + 23.6, SIZE);
+	cairo_close_path (cr);
+    }
+
+    cairo_set_source_rgba (cr, 0, 0, .5, .8);
+    cairo_fill_preserve (cr);
+
+    cairo_rectangle (cr, 37, 19, 150, 200);
+    cairo_clip (cr);
+    cairo_set_source_rgba (cr, .8, .3, 0, .6);
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+render (void)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cr = cairo_create (surface);
+    draw (cr);
+    cairo_destroy (cr);
+
+    return surface;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    static const char *coverage[] = { "scalar", "simd" };
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *reference;
+    unsigned int i;
+
+    _cairo_test_tor_scan_converter_set_coverage ("sparse");
+    reference = render ();
+
+    for (i = 0; i < ARRAY_LENGTH (coverage); i++) {
+	cairo_surface_t *image;
+	char what[80];
+
+	if (! _cairo_test_tor_scan_converter_set_coverage (coverage[i])) {
+	    cairo_test_log (ctx, "No %s coverage kernel, skipping\n",
+			    coverage[i]);
+	    continue;
+	}
+
+	snprintf (what, sizeof (what), "fill with %s coverage", coverage[i]);
+	image = render ();
+	result = image_compare_exact (ctx, reference, image, what);
+	cairo_surface_destroy (image);
+
+	if (result != CAIRO_TEST_SUCCESS)
+	    break;
+    }
+
+    _cairo_test_tor_scan_converter_set_coverage (NULL);
+    cairo_surface_destroy (reference);
+
+    return result;
+}
+
+CAIRO_TEST (tor_coverage,
+	    "Check the tor scan converter's coverage kernels agree exactly",
+	    "fill, image", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,651 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hostemu-private.h"
+
+#include <diskfont/diskfonttag.h>
+#include <diskfont/oterrors.h>
+#include <proto/diskfont.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+#include FT_ADVANCES_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_FONTPATH "/usr/share/fonts/truetype/dejavu:/usr/share/fonts/TTF:" \
+                         "/usr/share/fonts/truetype:/usr/share/fonts"
+
+/* Every OutlineFont handed out by OpenOutlineFont() is one of these, with
+ * the engine state that ESetInfo() changes and EObtainInfo() renders with.
+ */
+struct HostOutlineFont {
+	struct OutlineFont olf;
+	struct GlyphEngine engine;
+	struct TagItem     otags[4];
+	FT_Face            face;
+	uint32             xdpi, ydpi;
+	FIXED              point_height;
+	FIXED              set_factor;
+	FIXED              shear_sin, shear_cos;
+	FIXED              rotate_sin, rotate_cos;
+	FIXED              embolden_x, embolden_y;
+	uint32             code, code2;
+	BOOL               size_changed;
+};
+
+/* The library object is shared, so only creating and destroying faces
+ * needs the lock.
+ */
+static FT_Library      library;
+static pthread_mutex_t library_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline struct HostOutlineFont *
+_engine_to_font (struct EGlyphEngine *engine)
+{
+	return (struct HostOutlineFont *)((char *)engine - offsetof(struct HostOutlineFont, olf.olf_EEngine));
+}
+
+static BOOL
+_has_suffix (const char *name, const char *suffix)
+{
+	size_t name_len   = strlen(name);
+	size_t suffix_len = strlen(suffix);
+
+	return name_len >= suffix_len && strcasecmp(name + name_len - suffix_len, suffix) == 0;
+}
+
+/* AmigaOS opens "FONTS:<name>.font", so the directory part and the suffix
+ * are dropped and the font file is searched for in HOSTEMU_FONTPATH,
+ * both as named and with the spaces removed ("DejaVu Sans" is shipped as
+ * DejaVuSans.ttf on Linux).
+ */
+static char *
+_find_font_file (const char *name)
+{
+	static const char * const suffixes[] = { ".ttf", ".otf", ".pfb", ".pfa" };
+	const char *fontpath, *dir, *end, *base;
+	char        stems[2][256], path[1024];
+	int         i, j, k;
+	size_t      len;
+
+	if (! _has_suffix(name, ".font") && access(name, R_OK) == 0)
+		return strdup(name);
+
+	base = name;
+	for (i = 0; name[i] != '\0'; i++) {
+		if (name[i] == '/' || name[i] == ':')
+			base = name + i + 1;
+	}
+
+	len = strlen(base);
+	if (_has_suffix(base, ".font"))
+		len -= 5;
+	if (len >= sizeof(stems[0]))
+		return NULL;
+
+	memcpy(stems[0], base, len);
+	stems[0][len] = '\0';
+
+	for (i = j = 0; stems[0][i] != '\0'; i++) {
+		if (stems[0][i] != ' ')
+			stems[1][j++] = stems[0][i];
+	}
+	stems[1][j] = '\0';
+
+	fontpath = getenv("HOSTEMU_FONTPATH");
+	if (fontpath == NULL || *fontpath == '\0')
+		fontpath = DEFAULT_FONTPATH;
+
+	for (i = 0; i < 2; i++) {
+		for (dir = fontpath; *dir != '\0'; dir = *end != '\0' ? end + 1 : end) {
+			end = strchr(dir, ':');
+			if (end == NULL)
+				end = dir + strlen(dir);
+
+			for (k = 0; k < sizeof(suffixes) / sizeof(suffixes[0]); k++) {
+				snprintf(path, sizeof(path), "%.*s/%s%s", (int)(end - dir), dir, stems[i], suffixes[k]);
+				if (access(path, R_OK) == 0)
+					return strdup(path);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static FIXED
+_units_to_em (struct HostOutlineFont *hof, FT_Long units)
+{
+	if (hof->face->units_per_EM == 0)
+		return 0;
+
+	return FT_MulDiv(units, 0x10000, hof->face->units_per_EM);
+}
+
+static struct OutlineFont *
+OpenOutlineFont (CONST_STRPTR name, struct List *list, uint32 flags)
+{
+	struct HostOutlineFont *hof;
+	char                   *path;
+	FT_Fixed                space;
+	FT_UInt                 index;
+	FT_Error                error;
+	int                     i = 0;
+
+	_hostemu_count(HOSTEMU_OpenOutlineFont);
+
+	path = _find_font_file(name);
+	if (path == NULL)
+		return NULL;
+
+	hof = calloc(1, sizeof(struct HostOutlineFont));
+	if (hof == NULL) {
+		free(path);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&library_mutex);
+	error = library == NULL ? FT_Init_FreeType(&library) : 0;
+	if (error == 0)
+		error = FT_New_Face(library, path, 0, &hof->face);
+	pthread_mutex_unlock(&library_mutex);
+
+	if (error != 0) {
+		free(path);
+		free(hof);
+		return NULL;
+	}
+
+	FT_Select_Charmap(hof->face, FT_ENCODING_UNICODE);
+
+	hof->otags[i].ti_Tag  = OT_Family;
+	hof->otags[i].ti_Data = (uintptr_t)hof->face->family_name;
+	i++;
+
+	hof->otags[i].ti_Tag  = OT_IsFixed;
+	hof->otags[i].ti_Data = FT_IS_FIXED_WIDTH(hof->face) ? TRUE : FALSE;
+	i++;
+
+	index = FT_Get_Char_Index(hof->face, ' ');
+	if (index != 0 && FT_Get_Advance(hof->face, index, FT_LOAD_NO_SCALE, &space) == 0) {
+		hof->otags[i].ti_Tag  = OT_SpaceFactor;
+		hof->otags[i].ti_Data = (uint32)_units_to_em(hof, space);
+		i++;
+	}
+
+	hof->otags[i].ti_Tag = TAG_END;
+
+	hof->engine.gle_Name = (STRPTR)"freetype";
+
+	hof->olf.olf_OTagPath               = path;
+	hof->olf.olf_OTagList               = hof->otags;
+	hof->olf.olf_EngineName             = hof->engine.gle_Name;
+	hof->olf.olf_EEngine.ege_GlyphEngine = &hof->engine;
+
+	hof->xdpi         = 72;
+	hof->ydpi         = 72;
+	hof->point_height = 12 << 16;
+	hof->set_factor   = 0x10000;
+	hof->shear_cos    = 0x10000;
+	hof->rotate_cos   = 0x10000;
+	hof->size_changed = TRUE;
+
+	return &hof->olf;
+}
+
+static void
+CloseOutlineFont (struct OutlineFont *olf, struct List *list)
+{
+	struct HostOutlineFont *hof = (struct HostOutlineFont *)olf;
+
+	_hostemu_count(HOSTEMU_CloseOutlineFont);
+
+	if (hof == NULL)
+		return;
+
+	pthread_mutex_lock(&library_mutex);
+	FT_Done_Face(hof->face);
+	pthread_mutex_unlock(&library_mutex);
+
+	free(hof->olf.olf_OTagPath);
+	free(hof);
+}
+
+static uint32
+ESetInfoA (struct EGlyphEngine *engine, const struct TagItem *tags)
+{
+	struct HostOutlineFont *hof = _engine_to_font(engine);
+	struct TagItem         *state = (struct TagItem *)tags;
+	struct TagItem         *tag;
+	uint32                  error = OTERR_Success;
+
+	_hostemu_count(HOSTEMU_ESetInfo);
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case OT_DeviceDPI:
+				hof->xdpi         = tag->ti_Data >> 16;
+				hof->ydpi         = tag->ti_Data & 0xffff;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_PointHeight:
+				hof->point_height = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_SetFactor:
+				hof->set_factor   = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_ShearSin:
+				hof->shear_sin    = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_ShearCos:
+				hof->shear_cos    = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_RotateSin:
+				hof->rotate_sin   = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_RotateCos:
+				hof->rotate_cos   = tag->ti_Data;
+				hof->size_changed = TRUE;
+				break;
+
+			case OT_EmboldenX:
+				hof->embolden_x = tag->ti_Data;
+				break;
+
+			case OT_EmboldenY:
+				hof->embolden_y = tag->ti_Data;
+				break;
+
+			case OT_GlyphCode:
+				hof->code = tag->ti_Data & 0xffff;
+				break;
+
+			case OT_GlyphCode2:
+				hof->code2 = tag->ti_Data & 0xffff;
+				break;
+
+			case OT_GlyphCode_32:
+				hof->code = tag->ti_Data;
+				break;
+
+			case OT_GlyphCode2_32:
+				hof->code2 = tag->ti_Data;
+				break;
+
+			case OT_OTagPath:
+			case OT_OTagList:
+				break;
+
+			default:
+				error = OTERR_UnknownTag;
+				break;
+		}
+	}
+
+	return error;
+}
+
+static uint32
+ESetInfo (struct EGlyphEngine *engine, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, engine);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return ESetInfoA(engine, tags);
+}
+
+static uint32
+_update_size (struct HostOutlineFont *hof)
+{
+	FT_Matrix  matrix;
+	FT_Fixed   shear;
+	FT_F26Dot6 width, height;
+
+	if (! hof->size_changed)
+		return OTERR_Success;
+
+	height = hof->point_height >> 10;
+	width  = FT_MulFix(height, hof->set_factor);
+
+	if (FT_Set_Char_Size(hof->face, width, height, hof->xdpi, hof->ydpi) != 0)
+		return OTERR_BadFace;
+
+	/* Shear first, then rotate, as the bullet engines do */
+	shear = hof->shear_cos != 0 ? FT_DivFix(hof->shear_sin, hof->shear_cos) : 0;
+
+	matrix.xx = hof->rotate_cos;
+	matrix.xy = FT_MulFix(hof->rotate_cos, shear) - hof->rotate_sin;
+	matrix.yx = hof->rotate_sin;
+	matrix.yy = FT_MulFix(hof->rotate_sin, shear) + hof->rotate_cos;
+
+	if (matrix.xx == 0x10000 && matrix.xy == 0 && matrix.yx == 0 && matrix.yy == 0x10000)
+		FT_Set_Transform(hof->face, NULL, NULL);
+	else
+		FT_Set_Transform(hof->face, &matrix, NULL);
+
+	hof->size_changed = FALSE;
+
+	return OTERR_Success;
+}
+
+static const uint8 *
+_bitmap_row (const FT_Bitmap *bm, unsigned int y)
+{
+	if (bm->pitch >= 0)
+		return bm->buffer + y * bm->pitch;
+	else
+		return bm->buffer + (bm->rows - 1 - y) * -bm->pitch;
+}
+
+/* The glyph bitmap is exactly the black box, with the origin given
+ * relative to its top left corner. glm_Width is the advance as a fraction
+ * of the em, like in an OTAG width list.
+ */
+static struct GlyphMap *
+_render_glyph (struct HostOutlineFont *hof, BOOL gray)
+{
+	FT_Face          face = hof->face;
+	FT_GlyphSlot     slot;
+	FT_Bitmap       *bm;
+	FT_UInt          index;
+	FT_Fixed         advance;
+	struct GlyphMap *gm;
+	uint32           modulo, row_bytes, y;
+
+	index = FT_Get_Char_Index(face, hof->code);
+	if (index == 0)
+		return NULL;
+
+	if (FT_Load_Glyph(face, index, gray ? FT_LOAD_DEFAULT : FT_LOAD_TARGET_MONO) != 0)
+		return NULL;
+
+	slot = face->glyph;
+
+	if ((hof->embolden_x != 0 || hof->embolden_y != 0) && slot->format == FT_GLYPH_FORMAT_OUTLINE)
+		FT_Outline_EmboldenXY(&slot->outline, hof->embolden_x >> 10, hof->embolden_y >> 10);
+
+	if (FT_Render_Glyph(slot, gray ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO) != 0)
+		return NULL;
+
+	bm = &slot->bitmap;
+
+	if (gray) {
+		if (bm->pixel_mode != FT_PIXEL_MODE_GRAY && bm->rows != 0)
+			return NULL;
+
+		modulo    = (bm->width + 3) & ~3;
+		row_bytes = bm->width;
+	} else {
+		if (bm->pixel_mode != FT_PIXEL_MODE_MONO && bm->rows != 0)
+			return NULL;
+
+		modulo    = ((bm->width + 15) >> 4) << 1;
+		row_bytes = (bm->width + 7) >> 3;
+	}
+
+	gm = calloc(1, sizeof(struct GlyphMap) + (size_t)modulo * bm->rows);
+	if (gm == NULL)
+		return NULL;
+
+	gm->glm_BitMap = (uint8 *)(gm + 1);
+
+	for (y = 0; y < bm->rows; y++)
+		memcpy(gm->glm_BitMap + y * modulo, _bitmap_row(bm, y), row_bytes);
+
+	if (FT_Get_Advance(face, index, FT_LOAD_NO_SCALE, &advance) == 0 && face->units_per_EM != 0)
+		gm->glm_Width = _units_to_em(hof, advance);
+	else if (face->size->metrics.x_ppem != 0)
+		gm->glm_Width = (slot->advance.x << 10) / face->size->metrics.x_ppem;
+
+	gm->glm_BMModulo    = modulo;
+	gm->glm_BMRows      = bm->rows;
+	gm->glm_BlackLeft   = 0;
+	gm->glm_BlackTop    = 0;
+	gm->glm_BlackWidth  = bm->width;
+	gm->glm_BlackHeight = bm->rows;
+	gm->glm_XOrigin     = -slot->bitmap_left * 0x10000;
+	gm->glm_YOrigin     = slot->bitmap_top * 0x10000;
+	gm->glm_X0          = -slot->bitmap_left;
+	gm->glm_Y0          = slot->bitmap_top;
+	gm->glm_X1          = gm->glm_X0 + ((slot->advance.x + 32) >> 6);
+	gm->glm_Y1          = gm->glm_Y0 - ((slot->advance.y + 32) >> 6);
+
+	_hostemu_count_glyph();
+
+	return gm;
+}
+
+/* Kerning is returned as a fraction of the em, positive values moving the
+ * second glyph closer to the first.
+ */
+static int32
+_kern_pair (struct HostOutlineFont *hof)
+{
+	FT_Vector delta;
+	FT_UInt   left, right;
+
+	if (! FT_HAS_KERNING(hof->face))
+		return 0;
+
+	left  = FT_Get_Char_Index(hof->face, hof->code);
+	right = FT_Get_Char_Index(hof->face, hof->code2);
+	if (left == 0 || right == 0)
+		return 0;
+
+	if (FT_Get_Kerning(hof->face, left, right, FT_KERNING_UNSCALED, &delta) != 0)
+		return 0;
+
+	return -_units_to_em(hof, delta.x);
+}
+
+static struct MinList *
+_width_list (struct HostOutlineFont *hof, BOOL wide)
+{
+	struct MinList           *list;
+	struct MinNode           *node;
+	struct GlyphWidthEntry   *entries;
+	struct GlyphWidthEntry32 *entries32;
+	uint32                    first, last, code, count;
+	FT_UInt                   index;
+	FT_Fixed                  advance;
+	size_t                    entry_size;
+
+	first = hof->code;
+	last  = hof->code2 >= hof->code ? hof->code2 : hof->code;
+	if (last - first >= 0x10000)
+		last = first + 0xffff;
+
+	entry_size = wide ? sizeof(struct GlyphWidthEntry32) : sizeof(struct GlyphWidthEntry);
+
+	list = malloc(sizeof(struct MinList) + (last - first + 1) * entry_size);
+	if (list == NULL)
+		return NULL;
+
+	list->mlh_Head     = (struct MinNode *)&list->mlh_Tail;
+	list->mlh_Tail     = NULL;
+	list->mlh_TailPred = (struct MinNode *)&list->mlh_Head;
+
+	entries   = (struct GlyphWidthEntry *)(list + 1);
+	entries32 = (struct GlyphWidthEntry32 *)(list + 1);
+
+	for (code = first, count = 0; code <= last; code++) {
+		index = FT_Get_Char_Index(hof->face, code);
+		if (index == 0 || FT_Get_Advance(hof->face, index, FT_LOAD_NO_SCALE, &advance) != 0)
+			continue;
+
+		if (wide) {
+			entries32[count].gwe32_Code  = code;
+			entries32[count].gwe32_Width = _units_to_em(hof, advance);
+			node = &entries32[count].gwe32_Node;
+		} else {
+			entries[count].gwe_Code  = code;
+			entries[count].gwe_Width = _units_to_em(hof, advance);
+			node = &entries[count].gwe_Node;
+		}
+
+		node->mln_Succ = (struct MinNode *)&list->mlh_Tail;
+		node->mln_Pred = list->mlh_TailPred;
+		list->mlh_TailPred->mln_Succ = node;
+		list->mlh_TailPred = node;
+
+		count++;
+	}
+
+	return list;
+}
+
+static uint32
+EObtainInfoA (struct EGlyphEngine *engine, const struct TagItem *tags)
+{
+	struct HostOutlineFont *hof = _engine_to_font(engine);
+	struct TagItem         *state = (struct TagItem *)tags;
+	struct TagItem         *tag;
+	uint32                  error;
+
+	_hostemu_count(HOSTEMU_EObtainInfo);
+
+	error = _update_size(hof);
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case OT_GlyphMap:
+			case OT_GlyphMap8Bit:
+				*(struct GlyphMap **)tag->ti_Data = NULL;
+				if (error != OTERR_Success)
+					break;
+
+				*(struct GlyphMap **)tag->ti_Data = _render_glyph(hof, tag->ti_Tag == OT_GlyphMap8Bit);
+				if (*(struct GlyphMap **)tag->ti_Data == NULL)
+					error = OTERR_UnknownGlyph;
+				break;
+
+			case OT_TextKernPair:
+			case OT_DesignKernPair:
+				*(int32 *)tag->ti_Data = _kern_pair(hof);
+				break;
+
+			case OT_WidthList:
+			case OT_WidthList32:
+				*(struct MinList **)tag->ti_Data = _width_list(hof, tag->ti_Tag == OT_WidthList32);
+				if (*(struct MinList **)tag->ti_Data == NULL)
+					error = OTERR_NoMemory;
+				break;
+
+			default:
+				error = OTERR_UnknownTag;
+				break;
+		}
+	}
+
+	return error;
+}
+
+static uint32
+EObtainInfo (struct EGlyphEngine *engine, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, engine);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return EObtainInfoA(engine, tags);
+}
+
+static uint32
+EReleaseInfoA (struct EGlyphEngine *engine, const struct TagItem *tags)
+{
+	struct TagItem *state = (struct TagItem *)tags;
+	struct TagItem *tag;
+	uint32          error = OTERR_Success;
+
+	_hostemu_count(HOSTEMU_EReleaseInfo);
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case OT_GlyphMap:
+			case OT_GlyphMap8Bit:
+			case OT_WidthList:
+			case OT_WidthList32:
+				free((void *)tag->ti_Data);
+				break;
+
+			default:
+				error = OTERR_UnknownTag;
+				break;
+		}
+	}
+
+	return error;
+}
+
+static uint32
+EReleaseInfo (struct EGlyphEngine *engine, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, engine);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return EReleaseInfoA(engine, tags);
+}
+
+static struct DiskfontIFace diskfont_iface = {
+	.OpenOutlineFont  = OpenOutlineFont,
+	.CloseOutlineFont = CloseOutlineFont,
+	.ESetInfo         = ESetInfo,
+	.ESetInfoA        = ESetInfoA,
+	.EObtainInfo      = EObtainInfo,
+	.EObtainInfoA     = EObtainInfoA,
+	.EReleaseInfo     = EReleaseInfo,
+	.EReleaseInfoA    = EReleaseInfoA
+};
+
+struct DiskfontIFace *IDiskfont = &diskfont_iface;
@@ -0,0 +1,1028 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hostemu-private.h"
+
+#include <graphics/composite.h>
+#include <graphics/layers.h>
+#include <proto/graphics.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The PIXF_ names give the byte order on big-endian AmigaOS machines, which
+ * is the word order that cairo and pixman use. The host maps them to the
+ * pixman format with the same name so that cairo image data can be passed
+ * through unchanged, exactly like on the real thing.
+ */
+static const struct {
+	uint32               pixfmt;
+	pixman_format_code_t format;
+	uint32               bpp;
+} pixel_formats[] = {
+	{ PIXF_CLUT,     PIXMAN_a8,       1 },
+	{ PIXF_ALPHA8,   PIXMAN_a8,       1 },
+	{ PIXF_R5G6B5,   PIXMAN_r5g6b5,   2 },
+	{ PIXF_R5G5B5,   PIXMAN_x1r5g5b5, 2 },
+	{ PIXF_R8G8B8,   PIXMAN_r8g8b8,   3 },
+	{ PIXF_B8G8R8,   PIXMAN_b8g8r8,   3 },
+	{ PIXF_A8R8G8B8, PIXMAN_a8r8g8b8, 4 },
+	{ PIXF_A8B8G8R8, PIXMAN_a8b8g8r8, 4 },
+	{ PIXF_R8G8B8A8, PIXMAN_r8g8b8a8, 4 },
+	{ PIXF_B8G8R8A8, PIXMAN_b8g8r8a8, 4 }
+};
+
+pixman_format_code_t
+_hostemu_pixfmt_to_pixman (uint32 pixfmt, uint32 *bpp)
+{
+	int i;
+
+	for (i = 0; i < sizeof(pixel_formats) / sizeof(pixel_formats[0]); i++) {
+		if (pixel_formats[i].pixfmt == pixfmt) {
+			if (bpp != NULL)
+				*bpp = pixel_formats[i].bpp;
+			return pixel_formats[i].format;
+		}
+	}
+
+	return 0;
+}
+
+static uint32
+_pixfmt_for_depth (uint32 depth)
+{
+	if (depth <= 8)
+		return PIXF_CLUT;
+	else if (depth <= 15)
+		return PIXF_R5G5B5;
+	else if (depth <= 16)
+		return PIXF_R5G6B5;
+	else if (depth <= 24)
+		return PIXF_R8G8B8;
+	else if (depth <= 32)
+		return PIXF_A8R8G8B8;
+	else
+		return PIXF_NONE;
+}
+
+/* Coordinates in a rastport with a layer are relative to the layer */
+static void
+_rastport_origin (struct RastPort *rp, int32 *x, int32 *y)
+{
+	*x = 0;
+	*y = 0;
+
+	if (rp->Layer != NULL) {
+		*x = rp->Layer->bounds.MinX;
+		*y = rp->Layer->bounds.MinY;
+	}
+}
+
+static struct BitMap *
+AllocBitMapTagList (uint32                width,
+                    uint32                height,
+                    uint32                depth,
+                    const struct TagItem *tags)
+{
+	struct TagItem       *state = (struct TagItem *)tags;
+	struct TagItem       *tag;
+	struct HostBitMap    *friend = NULL;
+	struct HostBitMap    *bitmap;
+	uint32                pixfmt = PIXF_NONE;
+	BOOL                  displayable = FALSE;
+	pixman_format_code_t  format;
+	uint32                bpp;
+
+	_hostemu_count(HOSTEMU_AllocBitMap);
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case BMATags_Friend:
+				friend = (struct HostBitMap *)tag->ti_Data;
+				break;
+
+			case BMATags_Depth:
+				depth = tag->ti_Data;
+				break;
+
+			case BMATags_PixelFormat:
+				pixfmt = tag->ti_Data;
+				break;
+
+			case BMATags_Displayable:
+				displayable = tag->ti_Data != 0;
+				break;
+		}
+	}
+
+	if (pixfmt == PIXF_NONE && friend != NULL)
+		pixfmt = friend->pixfmt;
+
+	if (pixfmt == PIXF_NONE)
+		pixfmt = _pixfmt_for_depth(depth);
+
+	format = _hostemu_pixfmt_to_pixman(pixfmt, &bpp);
+	if (format == 0)
+		return NULL;
+
+	if (width == 0 || height == 0 || width > 32767 || height > 32767)
+		return NULL;
+
+	bitmap = calloc(1, sizeof(struct HostBitMap));
+	if (bitmap == NULL)
+		return NULL;
+
+	/* pixman clears the pixels it allocates, so BMATags_Clear is implied */
+	bitmap->image = pixman_image_create_bits(format, width, height, NULL, 0);
+	if (bitmap->image == NULL) {
+		free(bitmap);
+		return NULL;
+	}
+
+	bitmap->bm.Rows  = height;
+	bitmap->bm.Depth = bpp * 8;
+
+	bitmap->pixfmt = pixfmt;
+	bitmap->width  = width;
+	bitmap->height = height;
+	bitmap->bpp    = bpp;
+
+	if (friend != NULL)
+		bitmap->onboard = friend->onboard;
+	else
+		bitmap->onboard = displayable || _hostemu_config.onboard;
+
+	return &bitmap->bm;
+}
+
+static struct BitMap *
+AllocBitMapTags (uint32 width, uint32 height, uint32 depth, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, depth);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return AllocBitMapTagList(width, height, depth, tags);
+}
+
+static void
+FreeBitMap (struct BitMap *bm)
+{
+	struct HostBitMap *bitmap = HOSTBM(bm);
+
+	_hostemu_count(HOSTEMU_FreeBitMap);
+
+	if (bitmap == NULL)
+		return;
+
+	if (bitmap->locks != 0)
+		fprintf(stderr, "hostemu: freeing bitmap %p with %d locks held\n", bm, (int)bitmap->locks);
+
+	pixman_image_unref(bitmap->image);
+	free(bitmap);
+}
+
+static uint32
+GetBitMapAttr (struct BitMap *bm, uint32 attr)
+{
+	struct HostBitMap *bitmap = HOSTBM(bm);
+
+	_hostemu_count(HOSTEMU_GetBitMapAttr);
+
+	switch (attr) {
+		case BMA_HEIGHT:
+			return bitmap->height;
+
+		case BMA_DEPTH:
+			return bitmap->bm.Depth;
+
+		case BMA_WIDTH:
+		case BMA_ACTUALWIDTH:
+			return bitmap->width;
+
+		case BMA_FLAGS:
+			return 0;
+
+		case BMA_ISRTG:
+			return TRUE;
+
+		case BMA_BYTESPERPIXEL:
+			return bitmap->bpp;
+
+		case BMA_BITSPERPIXEL:
+			return bitmap->bpp * 8;
+
+		case BMA_PIXELFORMAT:
+			return bitmap->pixfmt;
+
+		case BMA_BYTESPERROW:
+			return pixman_image_get_stride(bitmap->image);
+
+		default:
+			return 0;
+	}
+}
+
+static APTR
+LockBitMapTagList (struct BitMap *bm, const struct TagItem *tags)
+{
+	struct HostBitMap *bitmap = HOSTBM(bm);
+	struct TagItem    *state = (struct TagItem *)tags;
+	struct TagItem    *tag;
+
+	_hostemu_count(HOSTEMU_LockBitMap);
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case LBM_BaseAddress:
+				*(APTR *)tag->ti_Data = pixman_image_get_data(bitmap->image);
+				break;
+
+			case LBM_BytesPerRow:
+				*(uint32 *)tag->ti_Data = pixman_image_get_stride(bitmap->image);
+				break;
+
+			case LBM_PixelFormat:
+				*(uint32 *)tag->ti_Data = bitmap->pixfmt;
+				break;
+
+			case LBM_IsOnBoard:
+				*(BOOL *)tag->ti_Data = bitmap->onboard;
+				break;
+		}
+	}
+
+	__atomic_fetch_add(&bitmap->locks, 1, __ATOMIC_RELAXED);
+
+	return bitmap;
+}
+
+static APTR
+LockBitMapTags (struct BitMap *bm, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, bm);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return LockBitMapTagList(bm, tags);
+}
+
+static void
+UnlockBitMap (APTR lock)
+{
+	struct HostBitMap *bitmap = lock;
+
+	_hostemu_count(HOSTEMU_UnlockBitMap);
+
+	if (bitmap != NULL)
+		__atomic_fetch_sub(&bitmap->locks, 1, __ATOMIC_RELAXED);
+}
+
+static void
+InitRastPort (struct RastPort *rp)
+{
+	_hostemu_count(HOSTEMU_InitRastPort);
+
+	memset(rp, 0, sizeof(struct RastPort));
+	rp->FgPen = 1;
+}
+
+/* pixman needs 32-bit aligned rows, which pixel arrays do not have, so
+ * unaligned arrays are bounced through a temporary copy.
+ */
+struct pixel_array {
+	pixman_image_t *image;
+	uint8          *data;
+	uint8          *bounce;
+	uint32          modulo;
+	uint32          row_bytes;
+	uint32          stride;
+	uint32          height;
+};
+
+static BOOL
+_pixel_array_init (struct pixel_array *pa,
+                   uint8              *base,
+                   uint32              x,
+                   uint32              y,
+                   uint32              modulo,
+                   uint32              pixfmt,
+                   uint32              width,
+                   uint32              height,
+                   BOOL                copy_in)
+{
+	pixman_format_code_t format;
+	uint32               bpp, i;
+	uint8               *bits;
+
+	format = _hostemu_pixfmt_to_pixman(pixfmt, &bpp);
+	if (format == 0)
+		return FALSE;
+
+	pa->data      = base + (size_t)y * modulo + (size_t)x * bpp;
+	pa->bounce    = NULL;
+	pa->modulo    = modulo;
+	pa->row_bytes = width * bpp;
+	pa->height    = height;
+
+	if (((uintptr_t)pa->data & 3) == 0 && (modulo & 3) == 0) {
+		bits       = pa->data;
+		pa->stride = modulo;
+	} else {
+		pa->stride = (pa->row_bytes + 3) & ~3;
+		pa->bounce = malloc((size_t)pa->stride * height);
+		if (pa->bounce == NULL)
+			return FALSE;
+
+		if (copy_in) {
+			for (i = 0; i < height; i++)
+				memcpy(pa->bounce + i * pa->stride, pa->data + i * modulo, pa->row_bytes);
+		}
+
+		bits = pa->bounce;
+	}
+
+	pa->image = pixman_image_create_bits(format, width, height, (uint32_t *)bits, pa->stride);
+	if (pa->image == NULL) {
+		free(pa->bounce);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+_pixel_array_fini (struct pixel_array *pa, BOOL copy_out)
+{
+	uint32 i;
+
+	pixman_image_unref(pa->image);
+
+	if (pa->bounce != NULL) {
+		if (copy_out) {
+			for (i = 0; i < pa->height; i++)
+				memcpy(pa->data + i * pa->modulo, pa->bounce + i * pa->stride, pa->row_bytes);
+		}
+
+		free(pa->bounce);
+	}
+}
+
+static uint32
+ReadPixelArray (struct RastPort *src_rp,
+                uint32           src_x,
+                uint32           src_y,
+                uint8           *dst,
+                uint32           dst_x,
+                uint32           dst_y,
+                uint32           dst_mod,
+                uint32           dst_pixfmt,
+                uint32           width,
+                uint32           height)
+{
+	struct HostBitMap  *bitmap = HOSTBM(src_rp->BitMap);
+	struct pixel_array  pa;
+	int32               x, y;
+
+	_hostemu_count(HOSTEMU_ReadPixelArray);
+
+	if (width == 0 || height == 0)
+		return 0;
+
+	if (! _pixel_array_init(&pa, dst, dst_x, dst_y, dst_mod, dst_pixfmt, width, height, FALSE))
+		return 0;
+
+	_rastport_origin(src_rp, &x, &y);
+
+	pixman_image_composite32(PIXMAN_OP_SRC, bitmap->image, NULL, pa.image,
+	                         x + src_x, y + src_y, 0, 0, 0, 0, width, height);
+
+	_pixel_array_fini(&pa, TRUE);
+
+	if (bitmap->onboard)
+		_hostemu_count_read((uint64)width * height * bitmap->bpp);
+
+	return width * height;
+}
+
+static uint32
+WritePixelArray (uint8           *src,
+                 uint32           src_x,
+                 uint32           src_y,
+                 uint32           src_mod,
+                 uint32           src_pixfmt,
+                 struct RastPort *dst_rp,
+                 uint32           dst_x,
+                 uint32           dst_y,
+                 uint32           width,
+                 uint32           height)
+{
+	struct HostBitMap  *bitmap = HOSTBM(dst_rp->BitMap);
+	struct pixel_array  pa;
+	int32               x, y;
+
+	_hostemu_count(HOSTEMU_WritePixelArray);
+
+	if (width == 0 || height == 0)
+		return 0;
+
+	if (! _pixel_array_init(&pa, src, src_x, src_y, src_mod, src_pixfmt, width, height, TRUE))
+		return 0;
+
+	_rastport_origin(dst_rp, &x, &y);
+
+	pixman_image_composite32(PIXMAN_OP_SRC, pa.image, NULL, bitmap->image,
+	                         0, 0, 0, 0, x + dst_x, y + dst_y, width, height);
+
+	_pixel_array_fini(&pa, FALSE);
+
+	if (bitmap->onboard)
+		_hostemu_count_written((uint64)width * height * bitmap->bpp);
+
+	return width * height;
+}
+
+static uint32
+ReadPixelColor (struct RastPort *rp, uint32 x, uint32 y)
+{
+	struct HostBitMap *bitmap = HOSTBM(rp->BitMap);
+	uint32_t           color = 0;
+	pixman_image_t    *image;
+	int32              ox, oy;
+
+	_hostemu_count(HOSTEMU_ReadPixelColor);
+
+	image = pixman_image_create_bits(PIXMAN_a8r8g8b8, 1, 1, &color, 4);
+	if (image == NULL)
+		return 0;
+
+	_rastport_origin(rp, &ox, &oy);
+
+	pixman_image_composite32(PIXMAN_OP_SRC, bitmap->image, NULL, image,
+	                         ox + x, oy + y, 0, 0, 0, 0, 1, 1);
+
+	pixman_image_unref(image);
+
+	if (bitmap->onboard)
+		_hostemu_count_read(bitmap->bpp);
+
+	return color;
+}
+
+static int32
+WritePixelColor (struct RastPort *rp, uint32 x, uint32 y, uint32 color)
+{
+	struct HostBitMap *bitmap = HOSTBM(rp->BitMap);
+	uint32_t           pixel = color;
+	pixman_image_t    *image;
+	int32              ox, oy;
+
+	_hostemu_count(HOSTEMU_WritePixelColor);
+
+	image = pixman_image_create_bits(PIXMAN_a8r8g8b8, 1, 1, &pixel, 4);
+	if (image == NULL)
+		return -1;
+
+	_rastport_origin(rp, &ox, &oy);
+
+	pixman_image_composite32(PIXMAN_OP_SRC, image, NULL, bitmap->image,
+	                         0, 0, 0, 0, ox + x, oy + y, 1, 1);
+
+	pixman_image_unref(image);
+
+	if (bitmap->onboard)
+		_hostemu_count_written(bitmap->bpp);
+
+	return 0;
+}
+
+static const pixman_op_t composite_ops[COMPOSITE_NumOperators] = {
+	[COMPOSITE_Clear]         = PIXMAN_OP_CLEAR,
+	[COMPOSITE_Src]           = PIXMAN_OP_SRC,
+	[COMPOSITE_Dest]          = PIXMAN_OP_DST,
+	[COMPOSITE_Src_Over_Dest] = PIXMAN_OP_OVER,
+	[COMPOSITE_Dest_Over_Src] = PIXMAN_OP_OVER_REVERSE,
+	[COMPOSITE_Src_In_Dest]   = PIXMAN_OP_IN,
+	[COMPOSITE_Dest_In_Src]   = PIXMAN_OP_IN_REVERSE,
+	[COMPOSITE_Src_Out_Dest]  = PIXMAN_OP_OUT,
+	[COMPOSITE_Dest_Out_Src]  = PIXMAN_OP_OUT_REVERSE,
+	[COMPOSITE_Src_Atop_Dest] = PIXMAN_OP_ATOP,
+	[COMPOSITE_Dest_Atop_Src] = PIXMAN_OP_ATOP_REVERSE,
+	[COMPOSITE_Src_Xor_Dest]  = PIXMAN_OP_XOR,
+	[COMPOSITE_Plus]          = PIXMAN_OP_ADD
+};
+
+struct composite_args {
+	int32              src_x, src_y;
+	int32              src_width, src_height;
+	int32              offset_x, offset_y;
+	uint32             scale_x, scale_y;
+	uint32             src_alpha;
+	struct HostBitMap *src_alpha_mask;
+	int32              src_alpha_x, src_alpha_y;
+	uint32             flags;
+	int32              dest_x, dest_y;
+	int32              dest_width, dest_height;
+	const float       *vertices;
+	uint32             vertex_format;
+	uint32             num_triangles;
+	const uint16      *indices;
+};
+
+/* graphics.library folds COMPTAG_SrcAlpha and COMPTAG_SrcAlphaMask into the
+ * source, but pixman takes only one mask. When both are used they are
+ * combined into a scratch mask covering the area that is about to be drawn.
+ */
+struct composite_ctx {
+	pixman_op_t     op;
+	pixman_image_t *src;
+	pixman_image_t *dst;
+	pixman_image_t *solid;
+	pixman_image_t *alpha_mask;
+	pixman_image_t *scratch;
+	pixman_image_t *mask;
+	int32           src_dx, src_dy;
+	int32           alpha_dx, alpha_dy;
+	int32           mask_dx, mask_dy;
+	int32           x1, y1, x2, y2;
+	uint64          triangles;
+	uint64          pixels;
+};
+
+static BOOL
+_prepare_mask (struct composite_ctx *ctx, int32 x, int32 y, int32 width, int32 height)
+{
+	if (ctx->alpha_mask == NULL) {
+		ctx->mask    = ctx->solid;
+		ctx->mask_dx = 0;
+		ctx->mask_dy = 0;
+		return TRUE;
+	}
+
+	if (ctx->solid == NULL) {
+		ctx->mask    = ctx->alpha_mask;
+		ctx->mask_dx = ctx->alpha_dx;
+		ctx->mask_dy = ctx->alpha_dy;
+		return TRUE;
+	}
+
+	if (ctx->scratch != NULL)
+		pixman_image_unref(ctx->scratch);
+
+	ctx->scratch = pixman_image_create_bits(PIXMAN_a8, width, height, NULL, 0);
+	if (ctx->scratch == NULL)
+		return FALSE;
+
+	pixman_image_composite32(PIXMAN_OP_SRC, ctx->solid, NULL, ctx->scratch,
+	                         0, 0, 0, 0, 0, 0, width, height);
+	pixman_image_composite32(PIXMAN_OP_IN, ctx->alpha_mask, NULL, ctx->scratch,
+	                         x + ctx->alpha_dx, y + ctx->alpha_dy, 0, 0, 0, 0, width, height);
+
+	ctx->mask    = ctx->scratch;
+	ctx->mask_dx = -x;
+	ctx->mask_dy = -y;
+
+	return TRUE;
+}
+
+static void
+_composite_span (struct composite_ctx *ctx, int32 x, int32 y, int32 width, int32 height)
+{
+	pixman_image_composite32(ctx->op, ctx->src, ctx->mask, ctx->dst,
+	                         x + ctx->src_dx, y + ctx->src_dy,
+	                         x + ctx->mask_dx, y + ctx->mask_dy,
+	                         x, y, width, height);
+
+	ctx->pixels += (uint64)width * height;
+}
+
+/* Sets up the affine mapping from destination pixels to the texture
+ * coordinates interpolated across the triangle. Degenerate triangles cover
+ * no pixels and are skipped by the caller.
+ */
+static BOOL
+_set_triangle_transform (pixman_image_t *image, const float *v[3], int offset)
+{
+	struct pixman_f_transform f;
+	struct pixman_transform   t;
+	double                    x0, y0, dx1, dy1, dx2, dy2, det;
+	double                    u[3], w;
+	int                       i, k;
+
+	x0  = v[0][0];
+	y0  = v[0][1];
+	dx1 = v[1][0] - x0;
+	dy1 = v[1][1] - y0;
+	dx2 = v[2][0] - x0;
+	dy2 = v[2][1] - y0;
+
+	det = dx1 * dy2 - dx2 * dy1;
+	if (fabs(det) < 1e-9)
+		return FALSE;
+
+	for (i = 0; i < 2; i++) {
+		for (k = 0; k < 3; k++) {
+			w    = v[k][offset + 2];
+			u[k] = v[k][offset + i] / (w != 0 ? w : 1);
+		}
+
+		f.m[i][0] = ((u[1] - u[0]) * dy2 - (u[2] - u[0]) * dy1) / det;
+		f.m[i][1] = ((u[2] - u[0]) * dx1 - (u[1] - u[0]) * dx2) / det;
+		f.m[i][2] = u[0] - f.m[i][0] * x0 - f.m[i][1] * y0;
+	}
+
+	f.m[2][0] = 0;
+	f.m[2][1] = 0;
+	f.m[2][2] = 1;
+
+	if (! pixman_transform_from_pixman_f_transform(&t, &f))
+		return FALSE;
+
+	pixman_image_set_transform(image, &t);
+
+	return TRUE;
+}
+
+static inline double
+_edge_x (const float *p, const float *q, double y)
+{
+	return p[0] + (q[0] - p[0]) * (y - p[1]) / (q[1] - p[1]);
+}
+
+/* Pixels are drawn when their centre lies inside the triangle, with the
+ * right and bottom edges excluded so that triangles sharing an edge never
+ * draw the same pixel twice.
+ */
+static BOOL
+_rasterize_triangle (struct composite_ctx *ctx, const float *v[3])
+{
+	const float *a = v[0], *b = v[1], *c = v[2], *tmp;
+	double       xa, xb, yc, min_x, max_x;
+	int32        x1, x2, y, y1, y2, bx1, bx2;
+
+#define SWAP(p, q) do { tmp = p; p = q; q = tmp; } while (0)
+	if (b[1] < a[1])
+		SWAP(a, b);
+	if (c[1] < a[1])
+		SWAP(a, c);
+	if (c[1] < b[1])
+		SWAP(b, c);
+#undef SWAP
+
+	y1 = (int32)ceil(a[1] - 0.5);
+	y2 = (int32)ceil(c[1] - 0.5);
+	if (y1 < ctx->y1)
+		y1 = ctx->y1;
+	if (y2 > ctx->y2)
+		y2 = ctx->y2;
+
+	min_x = fmin(a[0], fmin(b[0], c[0]));
+	max_x = fmax(a[0], fmax(b[0], c[0]));
+
+	bx1 = (int32)floor(min_x);
+	bx2 = (int32)ceil(max_x);
+	if (bx1 < ctx->x1)
+		bx1 = ctx->x1;
+	if (bx2 > ctx->x2)
+		bx2 = ctx->x2;
+
+	if (y1 >= y2 || bx1 >= bx2)
+		return TRUE;
+
+	if (! _prepare_mask(ctx, bx1, y1, bx2 - bx1, y2 - y1))
+		return FALSE;
+
+	for (y = y1; y < y2; y++) {
+		yc = y + 0.5;
+
+		xa = _edge_x(a, c, yc);
+		xb = yc < b[1] ? _edge_x(a, b, yc) : _edge_x(b, c, yc);
+		if (xa > xb) {
+			double t = xa;
+			xa = xb;
+			xb = t;
+		}
+
+		x1 = (int32)ceil(xa - 0.5);
+		x2 = (int32)ceil(xb - 0.5);
+		if (x1 < bx1)
+			x1 = bx1;
+		if (x2 > bx2)
+			x2 = bx2;
+
+		if (x1 < x2)
+			_composite_span(ctx, x1, y, x2 - x1, 1);
+	}
+
+	return TRUE;
+}
+
+static uint32
+_composite_vertices (struct composite_ctx        *ctx,
+                     const struct composite_args *args)
+{
+	const float *v[3];
+	uint32       stride = 2, stw0 = 0, stw1 = 0;
+	uint32       i, k, index;
+
+	if (args->vertex_format & COMPVF_STW0_Present) {
+		stw0    = stride;
+		stride += 3;
+	}
+
+	if (args->vertex_format & COMPVF_STW1_Present) {
+		stw1    = stride;
+		stride += 3;
+	}
+
+	if (ctx->alpha_mask != NULL && stw1 == 0)
+		return COMPERR_MissingInput;
+
+	for (i = 0; i < args->num_triangles; i++) {
+		for (k = 0; k < 3; k++) {
+			index = 3 * i + k;
+			if (args->indices != NULL)
+				index = args->indices[index];
+
+			v[k] = args->vertices + index * stride;
+		}
+
+		if (stw0 != 0 && ! _set_triangle_transform(ctx->src, v, stw0))
+			continue;
+
+		if (ctx->alpha_mask != NULL && ! _set_triangle_transform(ctx->alpha_mask, v, stw1))
+			continue;
+
+		if (! _rasterize_triangle(ctx, v))
+			return COMPERR_OutOfMemory;
+
+		ctx->triangles++;
+	}
+
+	return COMPERR_Success;
+}
+
+static uint32
+_composite_rectangle (struct composite_ctx        *ctx,
+                      const struct composite_args *args)
+{
+	struct pixman_f_transform f;
+	struct pixman_transform   t;
+	int32                     x1, y1, x2, y2;
+
+	x1 = args->dest_x + args->offset_x;
+	y1 = args->dest_y + args->offset_y;
+	x2 = x1 + (int32)(((int64)args->src_width * args->scale_x + 0x8000) >> 16);
+	y2 = y1 + (int32)(((int64)args->src_height * args->scale_y + 0x8000) >> 16);
+
+	if (args->scale_x == COMP_FIX_ONE && args->scale_y == COMP_FIX_ONE) {
+		ctx->src_dx = args->src_x - x1;
+		ctx->src_dy = args->src_y - y1;
+	} else {
+		pixman_f_transform_init_identity(&f);
+		f.m[0][0] = (double)COMP_FIX_ONE / args->scale_x;
+		f.m[1][1] = (double)COMP_FIX_ONE / args->scale_y;
+		f.m[0][2] = args->src_x - x1 * f.m[0][0];
+		f.m[1][2] = args->src_y - y1 * f.m[1][1];
+
+		if (! pixman_transform_from_pixman_f_transform(&t, &f))
+			return COMPERR_Value;
+
+		pixman_image_set_transform(ctx->src, &t);
+	}
+
+	ctx->alpha_dx = args->src_alpha_x - x1;
+	ctx->alpha_dy = args->src_alpha_y - y1;
+
+	if (x1 < ctx->x1)
+		x1 = ctx->x1;
+	if (y1 < ctx->y1)
+		y1 = ctx->y1;
+	if (x2 > ctx->x2)
+		x2 = ctx->x2;
+	if (y2 > ctx->y2)
+		y2 = ctx->y2;
+
+	if (x1 >= x2 || y1 >= y2)
+		return COMPERR_Success;
+
+	if (! _prepare_mask(ctx, x1, y1, x2 - x1, y2 - y1))
+		return COMPERR_OutOfMemory;
+
+	_composite_span(ctx, x1, y1, x2 - x1, y2 - y1);
+
+	return COMPERR_Success;
+}
+
+/* Vertex coordinates are relative to the destination bitmap and the
+ * destination rectangle only clips, which is all the cairo backend relies
+ * on. COMPFLAG_HardwareOnly fails unless every bitmap involved is onboard,
+ * so running with HOSTEMU_ONBOARD=0 exercises the software fallbacks.
+ */
+static uint32
+CompositeTagList (uint32                op,
+                  struct BitMap        *src_bm,
+                  struct BitMap        *dst_bm,
+                  const struct TagItem *tags)
+{
+	struct HostBitMap     *src = HOSTBM(src_bm);
+	struct HostBitMap     *dst = HOSTBM(dst_bm);
+	struct TagItem        *state = (struct TagItem *)tags;
+	struct TagItem        *tag;
+	struct composite_args  args;
+	struct composite_ctx   ctx;
+	pixman_filter_t        filter;
+	pixman_color_t         color;
+	uint32                 error;
+
+	_hostemu_count(HOSTEMU_Composite);
+
+	if (op >= COMPOSITE_NumOperators)
+		return COMPERR_UnknownOperator;
+
+	if (dst == NULL || (src == NULL && op != COMPOSITE_Clear))
+		return COMPERR_MissingInput;
+
+	memset(&args, 0, sizeof(args));
+	args.src_width   = src != NULL ? src->width : 0;
+	args.src_height  = src != NULL ? src->height : 0;
+	args.scale_x     = COMP_FIX_ONE;
+	args.scale_y     = COMP_FIX_ONE;
+	args.src_alpha   = COMP_FIX_ONE;
+	args.dest_width  = dst->width;
+	args.dest_height = dst->height;
+
+	while ((tag = _hostemu_next_tag_item(&state)) != NULL) {
+		switch (tag->ti_Tag) {
+			case COMPTAG_SrcX:          args.src_x          = tag->ti_Data; break;
+			case COMPTAG_SrcY:          args.src_y          = tag->ti_Data; break;
+			case COMPTAG_SrcWidth:      args.src_width      = tag->ti_Data; break;
+			case COMPTAG_SrcHeight:     args.src_height     = tag->ti_Data; break;
+			case COMPTAG_OffsetX:       args.offset_x       = tag->ti_Data; break;
+			case COMPTAG_OffsetY:       args.offset_y       = tag->ti_Data; break;
+			case COMPTAG_ScaleX:        args.scale_x        = tag->ti_Data; break;
+			case COMPTAG_ScaleY:        args.scale_y        = tag->ti_Data; break;
+			case COMPTAG_SrcAlpha:      args.src_alpha      = tag->ti_Data; break;
+			case COMPTAG_SrcAlphaMask:  args.src_alpha_mask = (struct HostBitMap *)tag->ti_Data; break;
+			case COMPTAG_SrcAlphaX:     args.src_alpha_x    = tag->ti_Data; break;
+			case COMPTAG_SrcAlphaY:     args.src_alpha_y    = tag->ti_Data; break;
+			case COMPTAG_Flags:         args.flags          = tag->ti_Data; break;
+			case COMPTAG_DestX:         args.dest_x         = tag->ti_Data; break;
+			case COMPTAG_DestY:         args.dest_y         = tag->ti_Data; break;
+			case COMPTAG_DestWidth:     args.dest_width     = tag->ti_Data; break;
+			case COMPTAG_DestHeight:    args.dest_height    = tag->ti_Data; break;
+			case COMPTAG_VertexArray:   args.vertices       = (const float *)tag->ti_Data; break;
+			case COMPTAG_VertexFormat:  args.vertex_format  = tag->ti_Data; break;
+			case COMPTAG_NumTriangles:  args.num_triangles  = tag->ti_Data; break;
+			case COMPTAG_IndexArray:    args.indices        = (const uint16 *)tag->ti_Data; break;
+		}
+	}
+
+	if (args.flags & COMPFLAG_HardwareOnly) {
+		if (! dst->onboard || (src != NULL && ! src->onboard) ||
+		    (args.src_alpha_mask != NULL && ! args.src_alpha_mask->onboard))
+			return COMPERR_SoftwareFallback;
+	}
+
+	if (args.src_alpha_mask != NULL && args.src_alpha_mask->pixfmt != PIXF_ALPHA8)
+		return COMPERR_Incompatible;
+
+	if (args.scale_x == 0 || args.scale_y == 0)
+		return COMPERR_Value;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.op  = composite_ops[op];
+	ctx.dst = dst->image;
+
+	ctx.x1 = args.dest_x > 0 ? args.dest_x : 0;
+	ctx.y1 = args.dest_y > 0 ? args.dest_y : 0;
+	ctx.x2 = args.dest_x + args.dest_width;
+	ctx.y2 = args.dest_y + args.dest_height;
+	if (ctx.x2 > (int32)dst->width)
+		ctx.x2 = dst->width;
+	if (ctx.y2 > (int32)dst->height)
+		ctx.y2 = dst->height;
+
+	if (src != NULL) {
+		ctx.src = pixman_image_ref(src->image);
+	} else {
+		memset(&color, 0, sizeof(color));
+		ctx.src = pixman_image_create_solid_fill(&color);
+	}
+
+	if (args.src_alpha < COMP_FIX_ONE) {
+		memset(&color, 0, sizeof(color));
+		color.alpha = (args.src_alpha * 0xffff) >> 16;
+		ctx.solid = pixman_image_create_solid_fill(&color);
+	}
+
+	if (args.src_alpha_mask != NULL)
+		ctx.alpha_mask = pixman_image_ref(args.src_alpha_mask->image);
+
+	filter = (args.flags & COMPFLAG_SrcFilter) ? PIXMAN_FILTER_BILINEAR : PIXMAN_FILTER_NEAREST;
+
+	if (src != NULL) {
+		pixman_image_set_filter(ctx.src, filter, NULL, 0);
+		pixman_image_set_repeat(ctx.src, args.vertices != NULL ? PIXMAN_REPEAT_PAD : PIXMAN_REPEAT_NONE);
+	}
+
+	if (ctx.alpha_mask != NULL) {
+		pixman_image_set_filter(ctx.alpha_mask, filter, NULL, 0);
+		pixman_image_set_repeat(ctx.alpha_mask, args.vertices != NULL ? PIXMAN_REPEAT_PAD : PIXMAN_REPEAT_NONE);
+	}
+
+	if (ctx.x1 >= ctx.x2 || ctx.y1 >= ctx.y2)
+		error = COMPERR_Success;
+	else if (args.vertices != NULL)
+		error = _composite_vertices(&ctx, &args);
+	else
+		error = _composite_rectangle(&ctx, &args);
+
+	_hostemu_count_composite(ctx.triangles, ctx.pixels);
+
+	/* The bitmap images are shared with the pixel array functions */
+	if (src != NULL) {
+		pixman_image_set_transform(ctx.src, NULL);
+		pixman_image_set_filter(ctx.src, PIXMAN_FILTER_NEAREST, NULL, 0);
+		pixman_image_set_repeat(ctx.src, PIXMAN_REPEAT_NONE);
+	}
+
+	if (ctx.alpha_mask != NULL) {
+		pixman_image_set_transform(ctx.alpha_mask, NULL);
+		pixman_image_set_filter(ctx.alpha_mask, PIXMAN_FILTER_NEAREST, NULL, 0);
+		pixman_image_set_repeat(ctx.alpha_mask, PIXMAN_REPEAT_NONE);
+		pixman_image_unref(ctx.alpha_mask);
+	}
+
+	if (ctx.scratch != NULL)
+		pixman_image_unref(ctx.scratch);
+
+	if (ctx.solid != NULL)
+		pixman_image_unref(ctx.solid);
+
+	pixman_image_unref(ctx.src);
+
+	return error;
+}
+
+static uint32
+CompositeTags (uint32 op, struct BitMap *src, struct BitMap *dst, ...)
+{
+	struct TagItem tags[HOSTEMU_MAX_TAGS];
+	va_list        ap;
+
+	va_start(ap, dst);
+	_hostemu_collect_tags(&ap, tags, HOSTEMU_MAX_TAGS);
+	va_end(ap);
+
+	return CompositeTagList(op, src, dst, tags);
+}
+
+static struct GraphicsIFace graphics_iface = {
+	.AllocBitMapTags    = AllocBitMapTags,
+	.AllocBitMapTagList = AllocBitMapTagList,
+	.FreeBitMap         = FreeBitMap,
+	.GetBitMapAttr      = GetBitMapAttr,
+	.LockBitMapTags     = LockBitMapTags,
+	.LockBitMapTagList  = LockBitMapTagList,
+	.UnlockBitMap       = UnlockBitMap,
+	.InitRastPort       = InitRastPort,
+	.ReadPixelArray     = ReadPixelArray,
+	.WritePixelArray    = WritePixelArray,
+	.WritePixelColor    = WritePixelColor,
+	.ReadPixelColor     = ReadPixelColor,
+	.CompositeTags      = CompositeTags,
+	.CompositeTagList   = CompositeTagList
+};
+
+struct GraphicsIFace *IGraphics = &graphics_iface;
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HOSTEMU_PRIVATE_H
+#define HOSTEMU_PRIVATE_H
+
+#include <hostemu.h>
+#include <graphics/gfx.h>
+#include <utility/tagitem.h>
+#include <pixman.h>
+
+#define HOSTEMU_MAX_TAGS 64
+
+/* Every BitMap handed out by AllocBitMapTags() is one of these */
+struct HostBitMap {
+	struct BitMap   bm;
+	pixman_image_t *image;
+	uint32          pixfmt;
+	uint32          width;
+	uint32          height;
+	uint32          bpp;
+	BOOL            onboard;
+	int32           locks;
+};
+
+static inline struct HostBitMap *
+HOSTBM (struct BitMap *bm)
+{
+	return (struct HostBitMap *)bm;
+}
+
+/* hostemu.c */
+extern struct HostEmuConfig _hostemu_config;
+
+void
+_hostemu_count (enum HostEmuCall call);
+
+void
+_hostemu_count_read (uint64 bytes);
+
+void
+_hostemu_count_written (uint64 bytes);
+
+void
+_hostemu_count_composite (uint64 triangles, uint64 pixels);
+
+void
+_hostemu_count_glyph (void);
+
+void
+_hostemu_collect_tags (va_list *ap, struct TagItem *tags, int max_tags);
+
+/* graphics.c */
+pixman_format_code_t
+_hostemu_pixfmt_to_pixman (uint32 pixfmt, uint32 *bpp);
+
+/* utility.c */
+struct TagItem *
+_hostemu_next_tag_item (struct TagItem **tagp);
+
+#endif /* HOSTEMU_PRIVATE_H */
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hostemu-private.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct HostEmuConfig _hostemu_config = {
+	.onboard  = TRUE,
+	.stall    = FALSE,
+	.call_ns  = 1000,
+	.read_ns  = 50.0,
+	.write_ns = 5.0
+};
+
+static struct HostEmuStats stats;
+
+static const char * const call_names[HOSTEMU_NumCalls] = {
+	[HOSTEMU_AllocBitMap]      = "AllocBitMap",
+	[HOSTEMU_FreeBitMap]       = "FreeBitMap",
+	[HOSTEMU_GetBitMapAttr]    = "GetBitMapAttr",
+	[HOSTEMU_LockBitMap]       = "LockBitMap",
+	[HOSTEMU_UnlockBitMap]     = "UnlockBitMap",
+	[HOSTEMU_InitRastPort]     = "InitRastPort",
+	[HOSTEMU_ReadPixelArray]   = "ReadPixelArray",
+	[HOSTEMU_WritePixelArray]  = "WritePixelArray",
+	[HOSTEMU_ReadPixelColor]   = "ReadPixelColor",
+	[HOSTEMU_WritePixelColor]  = "WritePixelColor",
+	[HOSTEMU_Composite]        = "CompositeTags",
+	[HOSTEMU_DoHookClipRects]  = "DoHookClipRects",
+	[HOSTEMU_OpenOutlineFont]  = "OpenOutlineFont",
+	[HOSTEMU_CloseOutlineFont] = "CloseOutlineFont",
+	[HOSTEMU_ESetInfo]         = "ESetInfo",
+	[HOSTEMU_EObtainInfo]      = "EObtainInfo",
+	[HOSTEMU_EReleaseInfo]     = "EReleaseInfo"
+};
+
+#define STAT_ADD(field, n) __atomic_fetch_add(&(field), (n), __ATOMIC_RELAXED)
+
+static uint64
+_now_ns (void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+_charge (uint64 ns)
+{
+	uint64 end;
+
+	if (ns == 0)
+		return;
+
+	STAT_ADD(stats.simulated_ns, ns);
+
+	if (! _hostemu_config.stall)
+		return;
+
+	/* Sleeping is far too coarse for sub-microsecond costs */
+	end = _now_ns() + ns;
+	while (_now_ns() < end)
+		;
+}
+
+void
+_hostemu_count (enum HostEmuCall call)
+{
+	STAT_ADD(stats.calls[call], 1);
+
+	/* Only graphics.library and layers.library talk to the hardware */
+	if (call <= HOSTEMU_DoHookClipRects)
+		_charge(_hostemu_config.call_ns);
+}
+
+void
+_hostemu_count_read (uint64 bytes)
+{
+	STAT_ADD(stats.bytes_read, bytes);
+	_charge(bytes * _hostemu_config.read_ns);
+}
+
+void
+_hostemu_count_written (uint64 bytes)
+{
+	STAT_ADD(stats.bytes_written, bytes);
+	_charge(bytes * _hostemu_config.write_ns);
+}
+
+void
+_hostemu_count_composite (uint64 triangles, uint64 pixels)
+{
+	STAT_ADD(stats.triangles, triangles);
+	STAT_ADD(stats.pixels, pixels);
+}
+
+void
+_hostemu_count_glyph (void)
+{
+	STAT_ADD(stats.glyphs, 1);
+}
+
+/* Copies variadic tag/data pairs into an array, following TAG_MORE so the
+ * caller only ever sees one terminated list.
+ */
+void
+_hostemu_collect_tags (va_list *ap, struct TagItem *tags, int max_tags)
+{
+	int i;
+
+	for (i = 0; i < max_tags - 1; i++) {
+		tags[i].ti_Tag = va_arg(*ap, Tag);
+
+		if (tags[i].ti_Tag == TAG_END)
+			return;
+
+		if (tags[i].ti_Tag & TAG_PTR)
+			tags[i].ti_Data = (uintptr_t)va_arg(*ap, void *);
+		else
+			tags[i].ti_Data = va_arg(*ap, uint32);
+
+		if (tags[i].ti_Tag == TAG_MORE)
+			return;
+	}
+
+	fprintf(stderr, "hostemu: more than %d tags passed to a varargs call\n", max_tags - 1);
+	abort();
+}
+
+#define LINEAR_TAG_BUFFERS 8
+
+const struct TagItem *
+hostemu_linear_tags (va_list *ap)
+{
+	static __thread struct TagItem buffers[LINEAR_TAG_BUFFERS][HOSTEMU_MAX_TAGS];
+	static __thread int            next;
+	struct TagItem                *tags;
+
+	tags = buffers[next];
+	next = (next + 1) % LINEAR_TAG_BUFFERS;
+
+	_hostemu_collect_tags(ap, tags, HOSTEMU_MAX_TAGS);
+
+	return tags;
+}
+
+void
+hostemu_get_config (struct HostEmuConfig *config)
+{
+	*config = _hostemu_config;
+}
+
+void
+hostemu_set_config (const struct HostEmuConfig *config)
+{
+	_hostemu_config = *config;
+}
+
+void
+hostemu_get_stats (struct HostEmuStats *out)
+{
+	int i;
+
+	for (i = 0; i < HOSTEMU_NumCalls; i++)
+		out->calls[i] = __atomic_load_n(&stats.calls[i], __ATOMIC_RELAXED);
+
+	out->bytes_read    = __atomic_load_n(&stats.bytes_read, __ATOMIC_RELAXED);
+	out->bytes_written = __atomic_load_n(&stats.bytes_written, __ATOMIC_RELAXED);
+	out->triangles     = __atomic_load_n(&stats.triangles, __ATOMIC_RELAXED);
+	out->pixels        = __atomic_load_n(&stats.pixels, __ATOMIC_RELAXED);
+	out->glyphs        = __atomic_load_n(&stats.glyphs, __ATOMIC_RELAXED);
+	out->simulated_ns  = __atomic_load_n(&stats.simulated_ns, __ATOMIC_RELAXED);
+}
+
+void
+hostemu_reset_stats (void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+const char *
+hostemu_call_name (enum HostEmuCall call)
+{
+	if ((unsigned)call >= HOSTEMU_NumCalls)
+		return NULL;
+
+	return call_names[call];
+}
+
+void
+hostemu_print_stats (FILE *file)
+{
+	struct HostEmuStats s;
+	int                 i;
+
+	hostemu_get_stats(&s);
+
+	fprintf(file, "hostemu statistics:\n");
+
+	for (i = 0; i < HOSTEMU_NumCalls; i++) {
+		if (s.calls[i] != 0)
+			fprintf(file, "  %-18s %12llu\n", call_names[i], (unsigned long long)s.calls[i]);
+	}
+
+	fprintf(file, "  %-18s %12llu\n", "bytes read", (unsigned long long)s.bytes_read);
+	fprintf(file, "  %-18s %12llu\n", "bytes written", (unsigned long long)s.bytes_written);
+	fprintf(file, "  %-18s %12llu\n", "triangles", (unsigned long long)s.triangles);
+	fprintf(file, "  %-18s %12llu\n", "pixels", (unsigned long long)s.pixels);
+	fprintf(file, "  %-18s %12llu\n", "glyphs", (unsigned long long)s.glyphs);
+	fprintf(file, "  %-18s %12.3f ms\n", "simulated time", s.simulated_ns / 1e6);
+}
+
+static void
+_print_stats_at_exit (void)
+{
+	hostemu_print_stats(stderr);
+}
+
+static long
+_getenv_long (const char *name, long def)
+{
+	const char *value = getenv(name);
+
+	return (value != NULL && *value != '\0') ? strtol(value, NULL, 0) : def;
+}
+
+static double
+_getenv_double (const char *name, double def)
+{
+	const char *value = getenv(name);
+
+	return (value != NULL && *value != '\0') ? strtod(value, NULL) : def;
+}
+
+static void __attribute__((constructor))
+_hostemu_init (void)
+{
+	_hostemu_config.onboard  = _getenv_long("HOSTEMU_ONBOARD", _hostemu_config.onboard) != 0;
+	_hostemu_config.stall    = _getenv_long("HOSTEMU_STALL", _hostemu_config.stall) != 0;
+	_hostemu_config.call_ns  = _getenv_long("HOSTEMU_CALL_NS", _hostemu_config.call_ns);
+	_hostemu_config.read_ns  = _getenv_double("HOSTEMU_READ_NS", _hostemu_config.read_ns);
+	_hostemu_config.write_ns = _getenv_double("HOSTEMU_WRITE_NS", _hostemu_config.write_ns);
+
+	if (_getenv_long("HOSTEMU_STATS", 0) != 0)
+		atexit(_print_stats_at_exit);
+}
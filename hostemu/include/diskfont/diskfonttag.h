@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DISKFONT_DISKFONTTAG_H
+#define DISKFONT_DISKFONTTAG_H
+
+#include <utility/tagitem.h>
+
+#define OT_Level0        (TAG_USER)
+#define OT_Level1        (TAG_USER | 0x1000)
+#define OT_Level2        (TAG_USER | 0x2000)
+#define OT_Level3        (TAG_USER | 0x3000)
+#define OT_Indirect      (0x8000 | TAG_PTR)
+
+/* Engine control tags */
+#define OT_DeviceDPI     (OT_Level0 | 0x01)
+#define OT_DotSize       (OT_Level0 | 0x02)
+#define OT_PointHeight   (OT_Level0 | 0x08)
+#define OT_SetFactor     (OT_Level0 | 0x09)
+#define OT_ShearSin      (OT_Level0 | 0x0a)
+#define OT_ShearCos      (OT_Level0 | 0x0b)
+#define OT_RotateSin     (OT_Level0 | 0x0c)
+#define OT_RotateCos     (OT_Level0 | 0x0d)
+#define OT_EmboldenX     (OT_Level0 | 0x0e)
+#define OT_EmboldenY     (OT_Level0 | 0x0f)
+#define OT_PointSize     (OT_Level0 | 0x10)
+#define OT_GlyphCode     (OT_Level0 | 0x11)
+#define OT_GlyphCode2    (OT_Level0 | 0x12)
+#define OT_GlyphWidth    (OT_Level0 | 0x13)
+#define OT_OTagPath      (OT_Level0 | OT_Indirect | 0x14)
+#define OT_OTagList      (OT_Level0 | OT_Indirect | 0x15)
+#define OT_GlyphMap      (OT_Level0 | OT_Indirect | 0x20)
+#define OT_WidthList     (OT_Level0 | OT_Indirect | 0x21)
+#define OT_TextKernPair  (OT_Level0 | OT_Indirect | 0x22)
+#define OT_DesignKernPair (OT_Level0 | OT_Indirect | 0x23)
+#define OT_GlyphMap8Bit  (OT_Level0 | OT_Indirect | 0x24)
+#define OT_GlyphCode_32  (OT_Level0 | 0x30)
+#define OT_GlyphCode2_32 (OT_Level0 | 0x31)
+#define OT_WidthList32   (OT_Level0 | OT_Indirect | 0x32)
+
+/* OTAG file tags */
+#define OT_FileIdent     (OT_Level1 | 0x01)
+#define OT_Engine        (OT_Level1 | OT_Indirect | 0x02)
+#define OT_Family        (OT_Level1 | OT_Indirect | 0x03)
+#define OT_BName         (OT_Level2 | OT_Indirect | 0x05)
+#define OT_YSizeFactor   (OT_Level1 | 0x0101)
+#define OT_SpaceWidth    (OT_Level1 | 0x0102)
+#define OT_IsFixed       (OT_Level1 | 0x0103)
+#define OT_SerifFlag     (OT_Level1 | 0x0104)
+#define OT_StemWeight    (OT_Level1 | 0x0105)
+#define OT_SlantStyle    (OT_Level1 | 0x0106)
+#define OT_HorizStyle    (OT_Level1 | 0x0107)
+#define OT_SpaceFactor   (OT_Level1 | 0x0108)
+#define OT_InhibitAlgoStyle (OT_Level1 | 0x0109)
+#define OT_AvailSizes    (OT_Level1 | OT_Indirect | 0x010a)
+
+#endif /* DISKFONT_DISKFONTTAG_H */
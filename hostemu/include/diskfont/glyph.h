@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DISKFONT_GLYPH_H
+#define DISKFONT_GLYPH_H
+
+#include <exec/types.h>
+
+struct GlyphEngine {
+	APTR   gle_Library;
+	STRPTR gle_Name;
+};
+
+struct EGlyphEngine {
+	APTR                ege_BulletBase;
+	APTR                ege_IBullet;
+	struct GlyphEngine *ege_GlyphEngine;
+};
+
+struct GlyphMap {
+	uint16  glm_BMModulo;
+	uint16  glm_BMRows;
+	uint16  glm_BlackLeft;
+	uint16  glm_BlackTop;
+	uint16  glm_BlackWidth;
+	uint16  glm_BlackHeight;
+	FIXED   glm_XOrigin;
+	FIXED   glm_YOrigin;
+	int16   glm_X0;
+	int16   glm_Y0;
+	int16   glm_X1;
+	int16   glm_Y1;
+	FIXED   glm_Width;
+	uint8  *glm_BitMap;
+};
+
+struct MinNode {
+	struct MinNode *mln_Succ;
+	struct MinNode *mln_Pred;
+};
+
+struct MinList {
+	struct MinNode *mlh_Head;
+	struct MinNode *mlh_Tail;
+	struct MinNode *mlh_TailPred;
+};
+
+struct GlyphWidthEntry {
+	struct MinNode gwe_Node;
+	uint16         gwe_reserved;
+	uint16         gwe_Code;
+	FIXED          gwe_Width;
+};
+
+struct GlyphWidthEntry32 {
+	struct MinNode gwe32_Node;
+	uint32         gwe32_reserved;
+	uint32         gwe32_Code;
+	FIXED          gwe32_Width;
+};
+
+#endif /* DISKFONT_GLYPH_H */
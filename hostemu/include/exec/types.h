@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EXEC_TYPES_H
+#define EXEC_TYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+typedef uint64_t       uint64;
+typedef int64_t        int64;
+typedef uint32_t       uint32;
+typedef int32_t        int32;
+typedef uint16_t       uint16;
+typedef int16_t        int16;
+typedef uint8_t        uint8;
+typedef int8_t         int8;
+
+typedef void          *APTR;
+typedef const void    *CONST_APTR;
+typedef char          *STRPTR;
+typedef const char    *CONST_STRPTR;
+typedef uint32         ULONG;
+typedef int32          LONG;
+typedef uint16         UWORD;
+typedef int16          WORD;
+typedef uint8          UBYTE;
+typedef int8           BYTE;
+typedef int16          BOOL;
+typedef int32          FIXED;
+typedef uint8         *PLANEPTR;
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* The host ABI passes variadic arguments in registers, so "linear" varargs
+ * are copied into a tag array instead. The array stays valid until a few
+ * more linear varargs calls have been made by the same thread.
+ */
+#define VARARGS68K
+#define va_startlinear(ap, last)  va_start(ap, last)
+#define va_getlinearva(ap, type)  ((type)hostemu_linear_tags(&(ap)))
+
+struct TagItem;
+const struct TagItem *hostemu_linear_tags (va_list *ap);
+
+#endif /* EXEC_TYPES_H */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GRAPHICS_COMPOSITE_H
+#define GRAPHICS_COMPOSITE_H
+
+#include <graphics/gfx.h>
+
+enum enPDOperator {
+	COMPOSITE_Clear = 0,
+	COMPOSITE_Src,
+	COMPOSITE_Dest,
+	COMPOSITE_Src_Over_Dest,
+	COMPOSITE_Dest_Over_Src,
+	COMPOSITE_Src_In_Dest,
+	COMPOSITE_Dest_In_Src,
+	COMPOSITE_Src_Out_Dest,
+	COMPOSITE_Dest_Out_Src,
+	COMPOSITE_Src_Atop_Dest,
+	COMPOSITE_Dest_Atop_Src,
+	COMPOSITE_Src_Xor_Dest,
+	COMPOSITE_Plus,
+	COMPOSITE_NumOperators
+};
+
+#define COMPTAG_Base          (TAG_USER)
+#define COMPTAG_SrcX          (COMPTAG_Base + 0)
+#define COMPTAG_SrcY          (COMPTAG_Base + 1)
+#define COMPTAG_SrcWidth      (COMPTAG_Base + 2)
+#define COMPTAG_SrcHeight     (COMPTAG_Base + 3)
+#define COMPTAG_OffsetX       (COMPTAG_Base + 4)
+#define COMPTAG_OffsetY       (COMPTAG_Base + 5)
+#define COMPTAG_ScaleX        (COMPTAG_Base + 6)
+#define COMPTAG_ScaleY        (COMPTAG_Base + 7)
+#define COMPTAG_SrcAlpha      (COMPTAG_Base + 8)
+#define COMPTAG_DestAlpha     (COMPTAG_Base + 9)
+#define COMPTAG_SrcAlphaMask  (COMPTAG_Base + 10 + TAG_PTR)
+#define COMPTAG_DestAlphaMask (COMPTAG_Base + 11 + TAG_PTR)
+#define COMPTAG_Flags         (COMPTAG_Base + 18)
+#define COMPTAG_DestX         (COMPTAG_Base + 19)
+#define COMPTAG_DestY         (COMPTAG_Base + 20)
+#define COMPTAG_DestWidth     (COMPTAG_Base + 21)
+#define COMPTAG_DestHeight    (COMPTAG_Base + 22)
+#define COMPTAG_SrcAlphaX     (COMPTAG_Base + 23)
+#define COMPTAG_SrcAlphaY     (COMPTAG_Base + 24)
+#define COMPTAG_DestAlphaX    (COMPTAG_Base + 25)
+#define COMPTAG_DestAlphaY    (COMPTAG_Base + 26)
+#define COMPTAG_VertexArray   (COMPTAG_Base + 27 + TAG_PTR)
+#define COMPTAG_VertexFormat  (COMPTAG_Base + 28)
+#define COMPTAG_NumTriangles  (COMPTAG_Base + 29)
+#define COMPTAG_IndexArray    (COMPTAG_Base + 30 + TAG_PTR)
+
+#define COMPFLAG_SrcAlphaOverride  (1UL << 0)
+#define COMPFLAG_DestAlphaOverride (1UL << 1)
+#define COMPFLAG_SrcFilter         (1UL << 2)
+#define COMPFLAG_HardwareOnly      (1UL << 3)
+#define COMPFLAG_IgnoreDestAlpha   (1UL << 4)
+#define COMPFLAG_ForceSoftware     (1UL << 7)
+
+#define COMPVF_STW0_Present        0x02
+#define COMPVF_STW1_Present        0x04
+
+enum enCompositeError {
+	COMPERR_Success = 0,
+	COMPERR_Incompatible,
+	COMPERR_Value,
+	COMPERR_SoftwareFallback,
+	COMPERR_OutOfMemory,
+	COMPERR_Generic,
+	COMPERR_UnknownOperator,
+	COMPERR_MissingInput
+};
+
+#define COMP_FIX_ONE          0x00010000
+#define COMP_FLOAT_TO_FIX(f)  ((int32)((f) * (float)COMP_FIX_ONE))
+
+#endif /* GRAPHICS_COMPOSITE_H */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GRAPHICS_GFX_H
+#define GRAPHICS_GFX_H
+
+#include <exec/types.h>
+#include <utility/tagitem.h>
+
+struct Rectangle {
+	int16 MinX, MinY;
+	int16 MaxX, MaxY;
+};
+
+struct BitMap {
+	uint16   BytesPerRow;
+	uint16   Rows;
+	uint8    Flags;
+	uint8    Depth;
+	uint16   pad;
+	PLANEPTR Planes[8];
+};
+
+enum enPixelFormat {
+	PIXF_NONE = 0,
+	PIXF_CLUT,
+	PIXF_R8G8B8,
+	PIXF_B8G8R8,
+	PIXF_R5G6B5PC,
+	PIXF_R5G5B5PC,
+	PIXF_A8R8G8B8,
+	PIXF_A8B8G8R8,
+	PIXF_R8G8B8A8,
+	PIXF_B8G8R8A8,
+	PIXF_R5G6B5,
+	PIXF_R5G5B5,
+	PIXF_B5G6R5PC,
+	PIXF_B5G5R5PC,
+	PIXF_YUV422CGX,
+	PIXF_YUV411,
+	PIXF_YUV422PA,
+	PIXF_YUV422,
+	PIXF_YUV422PC,
+	PIXF_YUV420P,
+	PIXF_YUV410P,
+	PIXF_ALPHA8
+};
+
+/* GetBitMapAttr() attributes */
+#define BMA_HEIGHT        0
+#define BMA_DEPTH         4
+#define BMA_WIDTH         8
+#define BMA_FLAGS         12
+#define BMA_ISRTG         16
+#define BMA_BYTESPERPIXEL 17
+#define BMA_BITSPERPIXEL  18
+#define BMA_PIXELFORMAT   19
+#define BMA_ACTUALWIDTH   20
+#define BMA_BYTESPERROW   21
+
+/* AllocBitMapTagList() tags */
+#define BMATags_Friend       (TAG_USER + 0x00 + TAG_PTR)
+#define BMATags_Depth        (TAG_USER + 0x01)
+#define BMATags_PixelFormat  (TAG_USER + 0x02)
+#define BMATags_Clear        (TAG_USER + 0x03)
+#define BMATags_Displayable  (TAG_USER + 0x04)
+#define BMATags_UserPrivate  (TAG_USER + 0x05)
+
+/* LockBitMapTagList() tags */
+#define LBM_BaseAddress      (TAG_USER + 0x1001 + TAG_PTR)
+#define LBM_BytesPerRow      (TAG_USER + 0x1002 + TAG_PTR)
+#define LBM_PixelFormat      (TAG_USER + 0x1003 + TAG_PTR)
+#define LBM_IsOnBoard        (TAG_USER + 0x1004 + TAG_PTR)
+
+#endif /* GRAPHICS_GFX_H */
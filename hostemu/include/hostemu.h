@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HOSTEMU_H
+#define HOSTEMU_H
+
+#include <exec/types.h>
+#include <stdio.h>
+
+/* Library calls that are counted by the host emulation */
+enum HostEmuCall {
+	HOSTEMU_AllocBitMap = 0,
+	HOSTEMU_FreeBitMap,
+	HOSTEMU_GetBitMapAttr,
+	HOSTEMU_LockBitMap,
+	HOSTEMU_UnlockBitMap,
+	HOSTEMU_InitRastPort,
+	HOSTEMU_ReadPixelArray,
+	HOSTEMU_WritePixelArray,
+	HOSTEMU_ReadPixelColor,
+	HOSTEMU_WritePixelColor,
+	HOSTEMU_Composite,
+	HOSTEMU_DoHookClipRects,
+	HOSTEMU_OpenOutlineFont,
+	HOSTEMU_CloseOutlineFont,
+	HOSTEMU_ESetInfo,
+	HOSTEMU_EObtainInfo,
+	HOSTEMU_EReleaseInfo,
+	HOSTEMU_NumCalls
+};
+
+struct HostEmuStats {
+	uint64 calls[HOSTEMU_NumCalls];
+	uint64 bytes_read;     /* pixel data read back from onboard bitmaps */
+	uint64 bytes_written;  /* pixel data written to onboard bitmaps */
+	uint64 triangles;      /* triangles submitted to CompositeTags() */
+	uint64 pixels;         /* destination pixels touched by CompositeTags() */
+	uint64 glyphs;         /* glyph maps rendered */
+	uint64 simulated_ns;   /* call overhead and bus transfer time */
+};
+
+/* The cost model charges call_ns for every graphics.library call and
+ * read_ns/write_ns per byte moved between the CPU and an onboard bitmap.
+ * The cost is only accounted for unless stall is set, in which case the
+ * calling thread also busy-waits for it so that benchmarks see it.
+ *
+ * The defaults are taken from the environment when the library is loaded:
+ *
+ *   HOSTEMU_ONBOARD   bitmaps are allocated in video memory (default 1)
+ *   HOSTEMU_CALL_NS   overhead per call in ns (default 1000)
+ *   HOSTEMU_READ_NS   ns per byte read from video memory (default 50)
+ *   HOSTEMU_WRITE_NS  ns per byte written to video memory (default 5)
+ *   HOSTEMU_STALL     busy-wait for the simulated cost (default 0)
+ *   HOSTEMU_STATS     print the statistics to stderr at exit (default 0)
+ *   HOSTEMU_FONTPATH  colon separated list of font directories
+ */
+struct HostEmuConfig {
+	BOOL   onboard;
+	BOOL   stall;
+	uint32 call_ns;
+	double read_ns;
+	double write_ns;
+};
+
+void
+hostemu_get_config (struct HostEmuConfig *config);
+
+void
+hostemu_set_config (const struct HostEmuConfig *config);
+
+void
+hostemu_get_stats (struct HostEmuStats *stats);
+
+void
+hostemu_reset_stats (void);
+
+const char *
+hostemu_call_name (enum HostEmuCall call);
+
+void
+hostemu_print_stats (FILE *file);
+
+#endif /* HOSTEMU_H */
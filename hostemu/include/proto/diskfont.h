@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROTO_DISKFONT_H
+#define PROTO_DISKFONT_H
+
+#include <diskfont/diskfont.h>
+#include <diskfont/glyph.h>
+
+struct List;
+
+struct DiskfontIFace {
+	struct OutlineFont * (*OpenOutlineFont) (CONST_STRPTR name, struct List *list, uint32 flags);
+	void                 (*CloseOutlineFont) (struct OutlineFont *olf, struct List *list);
+	uint32               (*ESetInfo) (struct EGlyphEngine *engine, ...);
+	uint32               (*ESetInfoA) (struct EGlyphEngine *engine, const struct TagItem *tags);
+	uint32               (*EObtainInfo) (struct EGlyphEngine *engine, ...);
+	uint32               (*EObtainInfoA) (struct EGlyphEngine *engine, const struct TagItem *tags);
+	uint32               (*EReleaseInfo) (struct EGlyphEngine *engine, ...);
+	uint32               (*EReleaseInfoA) (struct EGlyphEngine *engine, const struct TagItem *tags);
+};
+
+extern struct DiskfontIFace *IDiskfont;
+
+#endif /* PROTO_DISKFONT_H */
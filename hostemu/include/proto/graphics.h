@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROTO_GRAPHICS_H
+#define PROTO_GRAPHICS_H
+
+#include <graphics/gfx.h>
+#include <graphics/rastport.h>
+
+struct GraphicsIFace {
+	struct BitMap * (*AllocBitMapTags) (uint32 width, uint32 height, uint32 depth, ...);
+	struct BitMap * (*AllocBitMapTagList) (uint32 width, uint32 height, uint32 depth,
+	                                        const struct TagItem *tags);
+	void            (*FreeBitMap) (struct BitMap *bm);
+	uint32          (*GetBitMapAttr) (struct BitMap *bm, uint32 attr);
+	APTR            (*LockBitMapTags) (struct BitMap *bm, ...);
+	APTR            (*LockBitMapTagList) (struct BitMap *bm, const struct TagItem *tags);
+	void            (*UnlockBitMap) (APTR lock);
+	void            (*InitRastPort) (struct RastPort *rp);
+	uint32          (*ReadPixelArray) (struct RastPort *src_rp, uint32 src_x, uint32 src_y,
+	                                   uint8 *dst, uint32 dst_x, uint32 dst_y, uint32 dst_mod,
+	                                   uint32 dst_pixfmt, uint32 width, uint32 height);
+	uint32          (*WritePixelArray) (uint8 *src, uint32 src_x, uint32 src_y, uint32 src_mod,
+	                                    uint32 src_pixfmt, struct RastPort *dst_rp,
+	                                    uint32 dst_x, uint32 dst_y, uint32 width, uint32 height);
+	int32           (*WritePixelColor) (struct RastPort *rp, uint32 x, uint32 y, uint32 color);
+	uint32          (*ReadPixelColor) (struct RastPort *rp, uint32 x, uint32 y);
+	uint32          (*CompositeTags) (uint32 op, struct BitMap *src, struct BitMap *dst, ...);
+	uint32          (*CompositeTagList) (uint32 op, struct BitMap *src, struct BitMap *dst,
+	                                     const struct TagItem *tags);
+};
+
+extern struct GraphicsIFace *IGraphics;
+
+#endif /* PROTO_GRAPHICS_H */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hostemu-private.h"
+
+#include <proto/layers.h>
+
+typedef void (*CLIPRECTFUNC) (struct Hook *hook, struct RastPort *rp, struct BackFillMessage *bfm);
+
+static BOOL
+_intersect (struct Rectangle *r, const struct Rectangle *clip)
+{
+	if (r->MinX < clip->MinX)
+		r->MinX = clip->MinX;
+	if (r->MinY < clip->MinY)
+		r->MinY = clip->MinY;
+	if (r->MaxX > clip->MaxX)
+		r->MaxX = clip->MaxX;
+	if (r->MaxY > clip->MaxY)
+		r->MaxY = clip->MaxY;
+
+	return r->MinX <= r->MaxX && r->MinY <= r->MaxY;
+}
+
+/* There are no windows on the host so a layer is only ever one the caller
+ * set up itself. Bounds are relative to the layer and the hook is called
+ * with absolute bitmap coordinates, as on AmigaOS.
+ */
+static void
+DoHookClipRects (struct Hook            *hook,
+                 struct RastPort        *rp,
+                 const struct Rectangle *bounds)
+{
+	CLIPRECTFUNC           func = (CLIPRECTFUNC)hook->h_Entry;
+	struct Layer          *layer = rp->Layer;
+	struct HostBitMap     *bitmap = HOSTBM(rp->BitMap);
+	struct BackFillMessage bfm;
+	struct Rectangle       rect, bm_rect;
+	struct ClipRect       *cr;
+
+	_hostemu_count(HOSTEMU_DoHookClipRects);
+
+	bm_rect.MinX = 0;
+	bm_rect.MinY = 0;
+	bm_rect.MaxX = bitmap->width - 1;
+	bm_rect.MaxY = bitmap->height - 1;
+
+	if (layer == NULL) {
+		rect = bounds != NULL ? *bounds : bm_rect;
+
+		if (! _intersect(&rect, &bm_rect))
+			return;
+
+		bfm.Layer   = NULL;
+		bfm.Bounds  = rect;
+		bfm.OffsetX = rect.MinX;
+		bfm.OffsetY = rect.MinY;
+
+		func(hook, rp, &bfm);
+		return;
+	}
+
+	for (cr = layer->ClipRect; cr != NULL; cr = cr->Next) {
+		if (bounds != NULL) {
+			rect.MinX = layer->bounds.MinX + bounds->MinX;
+			rect.MinY = layer->bounds.MinY + bounds->MinY;
+			rect.MaxX = layer->bounds.MinX + bounds->MaxX;
+			rect.MaxY = layer->bounds.MinY + bounds->MaxY;
+		} else {
+			rect = layer->bounds;
+		}
+
+		if (! _intersect(&rect, &cr->bounds) || ! _intersect(&rect, &bm_rect))
+			continue;
+
+		bfm.Layer   = layer;
+		bfm.Bounds  = rect;
+		bfm.OffsetX = rect.MinX - layer->bounds.MinX;
+		bfm.OffsetY = rect.MinY - layer->bounds.MinY;
+
+		func(hook, rp, &bfm);
+	}
+}
+
+static struct LayersIFace layers_iface = {
+	.DoHookClipRects = DoHookClipRects
+};
+
+struct LayersIFace *ILayers = &layers_iface;
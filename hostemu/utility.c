@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The cairo AmigaOS port contributors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hostemu-private.h"
+
+#include <proto/utility.h>
+
+struct TagItem *
+_hostemu_next_tag_item (struct TagItem **tagp)
+{
+	struct TagItem *tag;
+
+	while ((tag = *tagp) != NULL) {
+		switch (tag->ti_Tag) {
+			case TAG_END:
+				*tagp = NULL;
+				return NULL;
+
+			case TAG_MORE:
+				*tagp = (struct TagItem *)tag->ti_Data;
+				break;
+
+			case TAG_IGNORE:
+				*tagp = tag + 1;
+				break;
+
+			case TAG_SKIP:
+				*tagp = tag + 1 + tag->ti_Data;
+				break;
+
+			default:
+				*tagp = tag + 1;
+				return tag;
+		}
+	}
+
+	return NULL;
+}
+
+static struct TagItem *
+FindTagItem (Tag tag, const struct TagItem *tags)
+{
+	struct TagItem *state = (struct TagItem *)tags;
+	struct TagItem *ti;
+
+	while ((ti = _hostemu_next_tag_item(&state)) != NULL) {
+		if (ti->ti_Tag == tag)
+			return ti;
+	}
+
+	return NULL;
+}
+
+static uintptr_t
+GetTagData (Tag tag, uintptr_t def, const struct TagItem *tags)
+{
+	struct TagItem *ti = FindTagItem(tag, tags);
+
+	return ti != NULL ? ti->ti_Data : def;
+}
+
+static struct UtilityIFace utility_iface = {
+	.GetTagData  = GetTagData,
+	.FindTagItem = FindTagItem,
+	.NextTagItem = _hostemu_next_tag_item
+};
+
+struct UtilityIFace *IUtility = &utility_iface;